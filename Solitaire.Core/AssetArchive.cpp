@@ -0,0 +1,182 @@
+#include "AssetArchive.h"
+#include <cstring>
+#include "CardGeometry.h"
+
+namespace
+{
+    const char Magic[4] = { 'S', 'C', 'A', 'A' };
+    const size_t ContentAlignment = 16;
+
+    static_assert(sizeof(AssetArchive::Header) == 48, "Header layout is part of the archive format");
+    static_assert(sizeof(AssetArchive::Entry) == 24, "Entry layout is part of the archive format");
+
+    // Indexed by the face minus one and by the suit
+    char const* const CardAssetNames[] =
+    {
+        "ace_of_diamonds", "ace_of_spades", "ace_of_hearts", "ace_of_clubs",
+        "2_of_diamonds", "2_of_spades", "2_of_hearts", "2_of_clubs",
+        "3_of_diamonds", "3_of_spades", "3_of_hearts", "3_of_clubs",
+        "4_of_diamonds", "4_of_spades", "4_of_hearts", "4_of_clubs",
+        "5_of_diamonds", "5_of_spades", "5_of_hearts", "5_of_clubs",
+        "6_of_diamonds", "6_of_spades", "6_of_hearts", "6_of_clubs",
+        "7_of_diamonds", "7_of_spades", "7_of_hearts", "7_of_clubs",
+        "8_of_diamonds", "8_of_spades", "8_of_hearts", "8_of_clubs",
+        "9_of_diamonds", "9_of_spades", "9_of_hearts", "9_of_clubs",
+        "10_of_diamonds", "10_of_spades", "10_of_hearts", "10_of_clubs",
+        "jack_of_diamonds", "jack_of_spades", "jack_of_hearts", "jack_of_clubs",
+        "queen_of_diamonds", "queen_of_spades", "queen_of_hearts", "queen_of_clubs",
+        "king_of_diamonds", "king_of_spades", "king_of_hearts", "king_of_clubs",
+    };
+    static_assert(sizeof(CardAssetNames) / sizeof(CardAssetNames[0]) == AssetArchive::CardCount, "Every card needs a name");
+
+    size_t Align(size_t value)
+    {
+        return (value + ContentAlignment - 1) & ~(ContentAlignment - 1);
+    }
+}
+
+namespace AssetArchive
+{
+    char const* CardAssetName(uint32_t cardId)
+    {
+        return cardId < CardCount ? CardAssetNames[cardId] : nullptr;
+    }
+
+    void Writer::Add(uint32_t cardId, std::string contents)
+    {
+        m_files.at(cardId) = std::move(contents);
+    }
+
+    std::vector<uint8_t> Writer::Serialize() const
+    {
+        std::vector<uint8_t> output(sizeof(Header) + CardCount * sizeof(Entry), 0);
+        std::vector<Entry> entries(CardCount);
+        for (auto i = 0u; i < CardCount; i++)
+        {
+            auto& file = m_files[i];
+            if (file.empty())
+            {
+                continue;
+            }
+            output.resize(Align(output.size()), 0);
+            entries[i].Offset = output.size();
+            entries[i].Length = file.size();
+            entries[i].Hash = CardGeometry::HashBytes(file.data(), file.size());
+            output.insert(output.end(), file.begin(), file.end());
+        }
+        memcpy(output.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+
+        Header header = {};
+        memcpy(header.Magic, Magic, sizeof(Magic));
+        header.Version = FormatVersion;
+        header.HeaderSize = sizeof(Header);
+        header.EntryCount = CardCount;
+        header.EntryTableOffset = sizeof(Header);
+        header.FileSize = output.size();
+        header.ContentHash = CardGeometry::HashBytes(output.data() + sizeof(Header), output.size() - sizeof(Header));
+        memcpy(output.data(), &header, sizeof(header));
+        return output;
+    }
+
+    bool Reader::Open(uint8_t const* data, size_t size, std::string& error)
+    {
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_entries = nullptr;
+
+        if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0)
+        {
+            error = "Too small to be an archive";
+            return false;
+        }
+        auto header = reinterpret_cast<Header const*>(data);
+        if (memcmp(header->Magic, Magic, sizeof(Magic)) != 0)
+        {
+            error = "Not an asset archive";
+            return false;
+        }
+        if (header->Version != FormatVersion || header->HeaderSize != sizeof(Header))
+        {
+            error = "Unsupported archive version " + std::to_string(header->Version) +
+                " (expected " + std::to_string(FormatVersion) + ")";
+            return false;
+        }
+        if (header->FileSize != size)
+        {
+            error = "Archive is truncated";
+            return false;
+        }
+        // Card ids index the table directly, so it has to have all of them
+        if (header->EntryCount != CardCount ||
+            header->EntryTableOffset % alignof(Entry) != 0 ||
+            header->EntryTableOffset > size ||
+            header->EntryCount > (size - header->EntryTableOffset) / sizeof(Entry))
+        {
+            error = "Entry table is out of bounds";
+            return false;
+        }
+
+        auto entries = reinterpret_cast<Entry const*>(data + header->EntryTableOffset);
+        for (auto i = 0u; i < header->EntryCount; i++)
+        {
+            auto& entry = entries[i];
+            if (entry.Offset > size || entry.Length > size - entry.Offset)
+            {
+                error = "Entry " + std::to_string(i) + " is out of bounds";
+                return false;
+            }
+        }
+
+        m_data = data;
+        m_size = size;
+        m_header = header;
+        m_entries = entries;
+        return true;
+    }
+
+    bool Reader::Verify(std::string& error) const
+    {
+        if (m_header == nullptr)
+        {
+            error = "Archive isn't open";
+            return false;
+        }
+        for (auto i = 0u; i < m_header->EntryCount; i++)
+        {
+            auto& entry = m_entries[i];
+            if (entry.Length != 0 && CardGeometry::HashBytes(m_data + entry.Offset, entry.Length) != entry.Hash)
+            {
+                error = std::string("Contents of ") + CardAssetName(i) + " don't match their hash";
+                return false;
+            }
+        }
+        if (CardGeometry::HashBytes(m_data + m_header->HeaderSize, m_size - m_header->HeaderSize) != m_header->ContentHash)
+        {
+            error = "Content hash doesn't match";
+            return false;
+        }
+        return true;
+    }
+
+    bool Reader::VerifyEntry(uint32_t cardId) const
+    {
+        if (cardId >= CardCount)
+        {
+            return false;
+        }
+        auto& entry = m_entries[cardId];
+        return CardGeometry::HashBytes(m_data + entry.Offset, entry.Length) == entry.Hash;
+    }
+
+    bool Reader::TryGet(uint32_t cardId, std::string_view& contents) const
+    {
+        if (cardId >= CardCount || m_entries[cardId].Length == 0)
+        {
+            return false;
+        }
+        auto& entry = m_entries[cardId];
+        contents = { reinterpret_cast<char const*>(m_data + entry.Offset), static_cast<size_t>(entry.Length) };
+        return true;
+    }
+}
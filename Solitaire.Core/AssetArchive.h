@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// An archive holds the source file of every card face in one file. The
+// index has a slot for every card id, so finding a card's file is an
+// array lookup and the whole thing can be read with a single open and a
+// mapping (or one positioned read per card). Everything is little-endian.
+//
+//     Header
+//     Entry[EntryCount]        (at EntryTableOffset, indexed by card id)
+//     file contents, 16 byte aligned
+//
+// ContentHash covers everything after the header and each entry has the
+// hash of its own contents, so a bad archive can point at the bad file.
+namespace AssetArchive
+{
+    const uint32_t FormatVersion = 1;
+    const uint32_t CardCount = 52;
+
+    // Faces go from 1 (ace) to 13 (king) and suits from 0 to 3, matching
+    // the Face and Suit enums
+    constexpr uint32_t CardId(uint32_t face, uint32_t suit) { return (face - 1) * 4 + suit; }
+    // The card face's file name without the extension, "ace_of_diamonds"
+    char const* CardAssetName(uint32_t cardId);
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t HeaderSize;
+        uint32_t EntryCount;
+        uint64_t EntryTableOffset;
+        uint64_t FileSize;
+        uint64_t ContentHash;
+        uint64_t Reserved;
+    };
+
+    // A Length of 0 means the archive doesn't have the card
+    struct Entry
+    {
+        uint64_t Offset;
+        uint64_t Length;
+        uint64_t Hash;
+    };
+
+    class Writer
+    {
+    public:
+        void Add(uint32_t cardId, std::string contents);
+        std::vector<uint8_t> Serialize() const;
+
+    private:
+        std::vector<std::string> m_files = std::vector<std::string>(CardCount);
+    };
+
+    // Reads an archive in place. The memory has to outlive the reader and
+    // anything it hands out.
+    class Reader
+    {
+    public:
+        // Checks the header and that every entry is in bounds. The hashes
+        // are only checked by Verify and VerifyEntry.
+        bool Open(uint8_t const* data, size_t size, std::string& error);
+        bool Verify(std::string& error) const;
+        // Just the one card's hash, for checking files as they're read
+        bool VerifyEntry(uint32_t cardId) const;
+
+        Header const& GetHeader() const { return *m_header; }
+        Entry const& GetEntry(uint32_t cardId) const { return m_entries[cardId]; }
+        // Returns false if the archive doesn't have the card
+        bool TryGet(uint32_t cardId, std::string_view& contents) const;
+
+    private:
+        uint8_t const* m_data = nullptr;
+        size_t m_size = 0;
+        Header const* m_header = nullptr;
+        Entry const* m_entries = nullptr;
+    };
+}
@@ -0,0 +1,128 @@
+#include "BoardLayout.h"
+#include <algorithm>
+#include <cassert>
+
+void BoardLayout::Clear()
+{
+    m_pileCount = 0;
+    m_cardCount = 0;
+    m_slotsDirty = true;
+}
+
+int BoardLayout::AddPile(PileKind kind, float originX, float originY)
+{
+    assert(m_pileCount < MaxPiles);
+    auto pile = m_pileCount++;
+    m_pileKinds[pile] = kind;
+    m_pileOriginX[pile] = originX;
+    m_pileOriginY[pile] = originY;
+    m_pileCardCounts[pile] = 0;
+    m_slotsDirty = true;
+    return pile;
+}
+
+void BoardLayout::SetPileOrigin(int pile, float originX, float originY)
+{
+    if (m_pileOriginX[pile] != originX || m_pileOriginY[pile] != originY)
+    {
+        m_pileOriginX[pile] = originX;
+        m_pileOriginY[pile] = originY;
+        m_slotsDirty = true;
+    }
+}
+
+void BoardLayout::SetCardCount(int pile, int count)
+{
+    if (m_pileCardCounts[pile] != count)
+    {
+        m_pileCardCounts[pile] = count;
+        m_slotsDirty = true;
+    }
+}
+
+int BoardLayout::PileStart(int pile)
+{
+    if (m_slotsDirty)
+    {
+        RebuildSlots();
+    }
+    return m_pileStarts[pile];
+}
+
+void BoardLayout::RebuildSlots()
+{
+    auto slot = 0;
+    for (auto pile = 0; pile < m_pileCount; pile++)
+    {
+        m_pileStarts[pile] = slot;
+        auto count = m_pileCardCounts[pile];
+        assert(slot + count <= MaxCards);
+        // Only the last three cards of the waste are fanned out
+        auto numCardsToFan = std::min(count, 3);
+        for (auto index = 0; index < count; index++, slot++)
+        {
+            m_baseX[slot] = m_pileOriginX[pile];
+            m_baseY[slot] = m_pileOriginY[pile];
+            m_fanX[slot] = 0.0f;
+            m_fanY[slot] = 0.0f;
+            switch (m_pileKinds[pile])
+            {
+            case PileKind::Stack:
+                m_fanY[slot] = static_cast<float>(index);
+                break;
+            case PileKind::Waste:
+                m_fanX[slot] = static_cast<float>(std::max(index - (count - numCardsToFan), 0));
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    m_cardCount = slot;
+    m_slotsDirty = false;
+}
+
+void BoardLayout::Compute(BoardLayoutParameters const& parameters)
+{
+    m_parameters = parameters;
+    if (m_slotsDirty)
+    {
+        RebuildSlots();
+    }
+
+    auto const horizontalOffset = parameters.WasteHorizontalOffset;
+    auto const verticalOffset = parameters.CardStackVerticalOffset;
+    float const* __restrict baseX = m_baseX.data();
+    float const* __restrict baseY = m_baseY.data();
+    float const* __restrict fanX = m_fanX.data();
+    float const* __restrict fanY = m_fanY.data();
+    float* __restrict x = m_x.data();
+    float* __restrict y = m_y.data();
+    // Always run over every slot, the unused ones are cheaper to compute
+    // than to branch around.
+    for (auto i = 0; i < MaxCards; i++)
+    {
+        x[i] = baseX[i] + fanX[i] * horizontalOffset;
+        y[i] = baseY[i] + fanY[i] * verticalOffset;
+    }
+}
+
+int BoardLayout::HitTest(int pile, float x, float y)
+{
+    auto start = PileStart(pile);
+    auto const width = m_parameters.CardWidth;
+    auto const height = m_parameters.CardHeight;
+    for (auto index = m_pileCardCounts[pile] - 1; index >= 0; index--)
+    {
+        auto cardX = m_x[start + index];
+        auto cardY = m_y[start + index];
+        if (x >= cardX &&
+            x < cardX + width &&
+            y >= cardY &&
+            y < cardY + height)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+enum class PileKind : uint8_t
+{
+    Deck,
+    Waste,
+    Foundation,
+    Stack
+};
+
+struct BoardLayoutParameters
+{
+    float CardWidth = 0.0f;
+    float CardHeight = 0.0f;
+    float CardStackVerticalOffset = 0.0f;
+    float WasteHorizontalOffset = 0.0f;
+};
+
+// Computes the absolute position of every card on the board. Pile
+// membership only changes when cards move, so that's folded into a
+// per-card description up front. Compute() is then a single branch-free
+// pass over contiguous arrays that the compiler can vectorize.
+class BoardLayout
+{
+public:
+    static constexpr int MaxCards = 52;
+    static constexpr int MaxPiles = 13;
+
+    void Clear();
+    int AddPile(PileKind kind, float originX, float originY);
+    void SetPileOrigin(int pile, float originX, float originY);
+    void SetCardCount(int pile, int count);
+    void Compute(BoardLayoutParameters const& parameters);
+
+    int PileCount() const { return m_pileCount; }
+    int CardCount() const { return m_cardCount; }
+    PileKind Kind(int pile) const { return m_pileKinds[pile]; }
+    float OriginX(int pile) const { return m_pileOriginX[pile]; }
+    float OriginY(int pile) const { return m_pileOriginY[pile]; }
+    int CardCount(int pile) const { return m_pileCardCounts[pile]; }
+
+    // Positions are indexed by slot. The cards of a pile occupy the
+    // contiguous range [PileStart(pile), PileStart(pile) + CardCount(pile)).
+    int PileStart(int pile);
+    float const* X() const { return m_x.data(); }
+    float const* Y() const { return m_y.data(); }
+
+    // Returns the index of the top-most card in the pile that contains
+    // the point, or -1 if there isn't one.
+    int HitTest(int pile, float x, float y);
+
+private:
+    void RebuildSlots();
+
+private:
+    BoardLayoutParameters m_parameters;
+    int m_pileCount = 0;
+    int m_cardCount = 0;
+    bool m_slotsDirty = true;
+
+    // Per pile
+    std::array<PileKind, MaxPiles> m_pileKinds = {};
+    std::array<float, MaxPiles> m_pileOriginX = {};
+    std::array<float, MaxPiles> m_pileOriginY = {};
+    std::array<int, MaxPiles> m_pileCardCounts = {};
+    std::array<int, MaxPiles> m_pileStarts = {};
+
+    // Per card slot (inputs)
+    alignas(32) std::array<float, MaxCards> m_baseX = {};
+    alignas(32) std::array<float, MaxCards> m_baseY = {};
+    alignas(32) std::array<float, MaxCards> m_fanX = {};
+    alignas(32) std::array<float, MaxCards> m_fanY = {};
+
+    // Per card slot (outputs)
+    alignas(32) std::array<float, MaxCards> m_x = {};
+    alignas(32) std::array<float, MaxCards> m_y = {};
+};
@@ -0,0 +1,74 @@
+#include "CardAtlas.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace CardGeometry;
+
+namespace CardAtlas
+{
+    float ScaleBucket(float scale)
+    {
+        auto bucket = std::ceil(scale / ScaleStep) * ScaleStep;
+        return std::clamp(bucket, MinimumScale, MaximumScale);
+    }
+
+    Layout ComputeLayout(size_t cellCount, float cardWidth, float cardHeight, float scale)
+    {
+        Layout layout;
+        layout.Scale = scale;
+        if (cellCount == 0)
+        {
+            return layout;
+        }
+
+        auto cellWidth = GeometryRasterizer::ScaledSize(cardWidth, scale);
+        auto cellHeight = GeometryRasterizer::ScaledSize(cardHeight, scale);
+        auto pitchX = cellWidth + 2 * CellPadding;
+        auto pitchY = cellHeight + 2 * CellPadding;
+
+        // Pick the column count that gives the squarest texture
+        auto bestColumns = static_cast<uint32_t>(cellCount);
+        auto bestSide = UINT32_MAX;
+        for (auto columns = 1u; columns <= cellCount; columns++)
+        {
+            auto rows = static_cast<uint32_t>((cellCount + columns - 1) / columns);
+            auto side = std::max(columns * pitchX, rows * pitchY);
+            if (side < bestSide)
+            {
+                bestSide = side;
+                bestColumns = columns;
+            }
+        }
+        auto rows = static_cast<uint32_t>((cellCount + bestColumns - 1) / bestColumns);
+        layout.Width = bestColumns * pitchX;
+        layout.Height = rows * pitchY;
+
+        for (auto i = 0u; i < cellCount; i++)
+        {
+            Region region = {};
+            region.X = (i % bestColumns) * pitchX + CellPadding;
+            region.Y = (i / bestColumns) * pitchY + CellPadding;
+            region.Width = cellWidth;
+            region.Height = cellHeight;
+            region.U0 = static_cast<float>(region.X) / layout.Width;
+            region.V0 = static_cast<float>(region.Y) / layout.Height;
+            region.U1 = static_cast<float>(region.X + region.Width) / layout.Width;
+            region.V1 = static_cast<float>(region.Y + region.Height) / layout.Height;
+            layout.Cells.push_back(region);
+        }
+        return layout;
+    }
+
+    Atlas Build(std::vector<DocumentView> const& documents, float cardWidth, float cardHeight, float scale)
+    {
+        Atlas atlas;
+        atlas.Layout = ComputeLayout(documents.size(), cardWidth, cardHeight, scale);
+        atlas.Image.Resize(atlas.Layout.Width, atlas.Layout.Height);
+        for (auto i = 0u; i < documents.size(); i++)
+        {
+            auto& cell = atlas.Layout.Cells[i];
+            GeometryRasterizer::Render(documents[i], cardWidth, cardHeight, scale, { &atlas.Image, cell.X, cell.Y });
+        }
+        return atlas;
+    }
+}
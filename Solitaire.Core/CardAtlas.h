@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CardGeometry.h"
+#include "GeometryRasterizer.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Card faces drawn by GeometryRasterizer and packed into one bitmap, so
+// that every card can be drawn as a sprite from the same texture. Every
+// cell is the same size (one card at the atlas's scale) and they're laid
+// out in a grid that's as close to square as it gets.
+//
+// Atlases are built for a scale bucket rather than the exact scale, so
+// resizing the window only redraws them when the bucket changes.
+namespace CardAtlas
+{
+    // Buckets are this far apart
+    const float ScaleStep = 0.25f;
+    const float MinimumScale = 0.25f;
+    const float MaximumScale = 4.0f;
+    // Empty pixels around each cell, so that filtering never picks up a
+    // neighbour
+    const uint32_t CellPadding = 1;
+
+    // Rounds up, drawing a little larger than needed looks better than
+    // scaling up
+    float ScaleBucket(float scale);
+
+    struct Region
+    {
+        // In pixels
+        uint32_t X;
+        uint32_t Y;
+        uint32_t Width;
+        uint32_t Height;
+        // The same, normalized to the atlas's size
+        float U0;
+        float V0;
+        float U1;
+        float V1;
+    };
+
+    struct Layout
+    {
+        float Scale = 0;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        // Indexed the same as the documents
+        std::vector<Region> Cells;
+    };
+
+    Layout ComputeLayout(size_t cellCount, float cardWidth, float cardHeight, float scale);
+
+    struct Atlas
+    {
+        CardAtlas::Layout Layout;
+        GeometryRasterizer::Bitmap Image;
+    };
+
+    // Draws each document into its own cell
+    Atlas Build(std::vector<CardGeometry::DocumentView> const& documents, float cardWidth, float cardHeight, float scale);
+}
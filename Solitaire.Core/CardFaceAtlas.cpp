@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "CardFaceAtlas.h"
+#include "StartupTrace.h"
+#include <windows.ui.composition.interop.h>
+
+namespace winrt
+{
+    using namespace Windows::Foundation;
+    using namespace Windows::Foundation::Numerics;
+    using namespace Windows::Graphics;
+    using namespace Windows::Graphics::DirectX;
+    using namespace Windows::UI::Composition;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point const& start);
+
+uint32_t GetAtlasCardId(Card const& card)
+{
+    return AssetArchive::CardId(static_cast<uint32_t>(card.Face()), static_cast<uint32_t>(card.Suit()));
+}
+
+CardGeometry::Document CopyDocument(CardGeometry::DocumentView const& view)
+{
+    CardGeometry::Document document;
+    document.Flags = view.Flags;
+    document.ViewBox = view.ViewBox;
+    document.Nodes.assign(view.Nodes.begin(), view.Nodes.end());
+    document.Segments.assign(view.Segments.begin(), view.Segments.end());
+    document.Points.assign(view.Points.begin(), view.Points.end());
+    document.Brushes.assign(view.Brushes.begin(), view.Brushes.end());
+    document.Stops.assign(view.Stops.begin(), view.Stops.end());
+    return document;
+}
+
+winrt::com_ptr<ID3D11Device> CreateAtlasD3DDevice()
+{
+    winrt::com_ptr<ID3D11Device> device;
+    auto hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+        nullptr, 0, D3D11_SDK_VERSION, device.put(), nullptr, nullptr);
+    if (hr == DXGI_ERROR_UNSUPPORTED)
+    {
+        // The atlas is only uploaded, so WARP is fine
+        hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+            nullptr, 0, D3D11_SDK_VERSION, device.put(), nullptr, nullptr);
+    }
+    winrt::check_hresult(hr);
+    return device;
+}
+
+CardFaceAtlas::CardFaceAtlas(
+    winrt::Compositor const& compositor,
+    winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+    CardGeometry::CardShapeMetrics const& metrics)
+{
+    m_cardWidth = metrics.Width;
+    m_cardHeight = metrics.Height;
+    m_placeholder = CardGeometry::BuildCardPlaceholder(metrics);
+    m_faces.resize(AssetArchive::CardCount);
+
+    // The factory is multithreaded, so the device can be drawn to from
+    // the load workers
+    SpanRecorder::Scope devicesSpan(StartupTrace(), "CreateD3DDevice");
+    auto d3dDevice = CreateAtlasD3DDevice();
+    winrt::com_ptr<ID2D1Device> d2dDevice;
+    winrt::check_hresult(d2dFactory->CreateDevice(d3dDevice.as<IDXGIDevice>().get(), d2dDevice.put()));
+    auto compositorInterop = compositor.as<ABI::Windows::UI::Composition::ICompositorInterop>();
+    winrt::com_ptr<ABI::Windows::UI::Composition::ICompositionGraphicsDevice> graphicsDevice;
+    winrt::check_hresult(compositorInterop->CreateGraphicsDevice(d2dDevice.get(), graphicsDevice.put()));
+    m_graphicsDevice = graphicsDevice.as<winrt::CompositionGraphicsDevice>();
+    devicesSpan.End();
+
+    m_surface = m_graphicsDevice.CreateDrawingSurface({ 0, 0 }, winrt::DirectXPixelFormat::B8G8R8A8UIntNormalized, winrt::DirectXAlphaMode::Premultiplied);
+    for (auto i = 0u; i < AssetArchive::CardCount; i++)
+    {
+        // Cells are placed by the transform rather than by stretching
+        auto brush = compositor.CreateSurfaceBrush(m_surface);
+        brush.Stretch(winrt::CompositionStretch::None);
+        brush.HorizontalAlignmentRatio(0);
+        brush.VerticalAlignmentRatio(0);
+        m_brushes.push_back(brush);
+    }
+}
+
+winrt::CompositionBrush CardFaceAtlas::GetBrush(Card const& card)
+{
+    return m_brushes[GetAtlasCardId(card)];
+}
+
+void CardFaceAtlas::SetFace(Card const& card, CardGeometry::DocumentView const& document)
+{
+    std::lock_guard lock(m_lock);
+    auto cardId = GetAtlasCardId(card);
+    m_faces[cardId] = CopyDocument(document);
+    if (m_layout.Scale > 0)
+    {
+        DrawCell(cardId, m_faces[cardId].View());
+        UpdateBrush(cardId);
+    }
+}
+
+void CardFaceAtlas::UpdateScale(float scale)
+{
+    std::lock_guard lock(m_lock);
+    auto bucket = CardAtlas::ScaleBucket(scale);
+    if (bucket == m_layout.Scale)
+    {
+        return;
+    }
+
+    SpanRecorder::Scope span(StartupTrace(), "DrawAtlas");
+    auto start = std::chrono::steady_clock::now();
+    m_layout = CardAtlas::ComputeLayout(PlaceholderCell + 1, m_cardWidth, m_cardHeight, bucket);
+    m_surface.Resize({ static_cast<int32_t>(m_layout.Width), static_cast<int32_t>(m_layout.Height) });
+    DrawCell(PlaceholderCell, m_placeholder.View());
+    auto drawn = 0;
+    for (auto i = 0u; i < AssetArchive::CardCount; i++)
+    {
+        if (!m_faces[i].Nodes.empty())
+        {
+            DrawCell(i, m_faces[i].View());
+            drawn++;
+        }
+        UpdateBrush(i);
+    }
+
+    std::wstringstream stringStream;
+    stringStream << L"Card face atlas drawn for scale " << scale << L" (bucket " << bucket << L"), "
+        << m_layout.Width << L"x" << m_layout.Height << L" pixels, " << drawn << L" faces in "
+        << MillisecondsSince(start) << L" ms" << std::endl;
+    Debug::OutputDebugStringStream(stringStream);
+}
+
+void CardFaceAtlas::DrawCell(uint32_t cell, CardGeometry::DocumentView const& document)
+{
+    auto& region = m_layout.Cells[cell];
+    m_cellPixels.Resize(region.Width, region.Height);
+    GeometryRasterizer::Render(document, m_cardWidth, m_cardHeight, m_layout.Scale, { &m_cellPixels, 0, 0 });
+    // The rasterizer writes RGBA, the surface is BGRA
+    for (auto i = 0u; i < m_cellPixels.Pixels.size(); i += 4)
+    {
+        std::swap(m_cellPixels.Pixels[i], m_cellPixels.Pixels[i + 2]);
+    }
+
+    // The padding around the cell is part of the update, so that it
+    // gets cleared too
+    auto padding = static_cast<LONG>(CardAtlas::CellPadding);
+    RECT updateRect =
+    {
+        static_cast<LONG>(region.X) - padding,
+        static_cast<LONG>(region.Y) - padding,
+        static_cast<LONG>(region.X + region.Width) + padding,
+        static_cast<LONG>(region.Y + region.Height) + padding,
+    };
+    auto surfaceInterop = m_surface.as<ABI::Windows::UI::Composition::ICompositionDrawingSurfaceInterop>();
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    POINT offset = {};
+    winrt::check_hresult(surfaceInterop->BeginDraw(&updateRect, __uuidof(ID2D1DeviceContext), context.put_void(), &offset));
+    context->SetDpi(96.0f, 96.0f);
+    winrt::com_ptr<ID2D1Bitmap1> bitmap;
+    auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE, D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+    auto hr = context->CreateBitmap(D2D1::SizeU(region.Width, region.Height), m_cellPixels.Pixels.data(), region.Width * 4, properties, bitmap.put());
+    if (SUCCEEDED(hr))
+    {
+        context->Clear(D2D1::ColorF(0, 0, 0, 0));
+        context->DrawImage(bitmap.get(), D2D1::Point2F(static_cast<float>(offset.x + padding), static_cast<float>(offset.y + padding)),
+            D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR, D2D1_COMPOSITE_MODE_SOURCE_COPY);
+    }
+    winrt::check_hresult(surfaceInterop->EndDraw());
+    winrt::check_hresult(hr);
+}
+
+void CardFaceAtlas::UpdateBrush(uint32_t cardId)
+{
+    auto cell = m_faces[cardId].Nodes.empty() ? PlaceholderCell : cardId;
+    auto& region = m_layout.Cells[cell];
+    // Moves the cell to the brush's origin and brings it back down to
+    // the card's size
+    m_brushes[cardId].TransformMatrix(
+        winrt::make_float3x2_translation(-static_cast<float>(region.X), -static_cast<float>(region.Y)) *
+        winrt::make_float3x2_scale(1.0f / m_layout.Scale));
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Card.h"
+#include "AssetArchive.h"
+#include "CardAtlas.h"
+#include "CardGeometry.h"
+#include "GeometryRasterizer.h"
+
+// Card faces drawn on the CPU (see GeometryRasterizer) into one drawing
+// surface, for CardFaceRendering::Raster. Every card gets a surface brush
+// that shows its cell of the atlas at the card's size, so a face is a
+// plain SpriteVisual instead of a tree of shapes.
+//
+// The atlas is drawn for a scale bucket (see CardAtlas::ScaleBucket) and
+// only redrawn when the bucket changes. Faces that haven't loaded yet
+// show the placeholder cell.
+class CardFaceAtlas
+{
+public:
+    CardFaceAtlas(
+        winrt::Windows::UI::Composition::Compositor const& compositor,
+        winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+        CardGeometry::CardShapeMetrics const& metrics);
+    ~CardFaceAtlas() {}
+
+    // Sized to fill a CompositionCard
+    winrt::Windows::UI::Composition::CompositionBrush GetBrush(Card const& card);
+
+    // Keeps a copy of the document, it's needed again whenever the
+    // atlas is redrawn. Safe to call from any thread.
+    void SetFace(Card const& card, CardGeometry::DocumentView const& document);
+
+    // The scale the board is shown at, the atlas is only redrawn when it
+    // falls in a different bucket
+    void UpdateScale(float scale);
+
+private:
+    void DrawCell(uint32_t cell, CardGeometry::DocumentView const& document);
+    void UpdateBrush(uint32_t cardId);
+
+private:
+    // The cell after the last card
+    static const uint32_t PlaceholderCell = AssetArchive::CardCount;
+
+    winrt::Windows::UI::Composition::CompositionGraphicsDevice m_graphicsDevice{ nullptr };
+    winrt::Windows::UI::Composition::CompositionDrawingSurface m_surface{ nullptr };
+    float m_cardWidth = 0;
+    float m_cardHeight = 0;
+    CardGeometry::Document m_placeholder;
+
+    // Guards everything below, faces arrive from the load workers
+    std::mutex m_lock;
+    // Indexed by AssetArchive::CardId, a face that hasn't loaded has no
+    // nodes
+    std::vector<CardGeometry::Document> m_faces;
+    std::vector<winrt::Windows::UI::Composition::CompositionSurfaceBrush> m_brushes;
+    // Nothing has been drawn until the first UpdateScale
+    CardAtlas::Layout m_layout;
+    GeometryRasterizer::Bitmap m_cellPixels;
+};
@@ -0,0 +1,347 @@
+#include "CardGeometry.h"
+#include <cstring>
+
+namespace CardGeometry
+{
+    template <typename T>
+    Span<T> MakeSpan(std::vector<T> const& values)
+    {
+        return { values.data(), values.size() };
+    }
+
+    Matrix Multiply(Matrix const& first, Matrix const& second)
+    {
+        return
+        {
+            first.M11 * second.M11 + first.M12 * second.M21,
+            first.M11 * second.M12 + first.M12 * second.M22,
+            first.M21 * second.M11 + first.M22 * second.M21,
+            first.M21 * second.M12 + first.M22 * second.M22,
+            first.M31 * second.M11 + first.M32 * second.M21 + second.M31,
+            first.M31 * second.M12 + first.M32 * second.M22 + second.M32,
+        };
+    }
+
+    DocumentView Document::View() const
+    {
+        DocumentView view;
+        view.Flags = Flags;
+        view.ViewBox = ViewBox;
+        view.Nodes = MakeSpan(Nodes);
+        view.Segments = MakeSpan(Segments);
+        view.Points = MakeSpan(Points);
+        view.Brushes = MakeSpan(Brushes);
+        view.Stops = MakeSpan(Stops);
+        return view;
+    }
+
+    int32_t Document::AddContainer(int32_t parent)
+    {
+        Node node = {};
+        node.Type = NodeType::Container;
+        node.Parent = parent;
+        node.Transform = Matrix::Identity();
+        node.FillBrush = NoBrush;
+        node.StrokeBrush = NoBrush;
+        Nodes.push_back(node);
+        return static_cast<int32_t>(Nodes.size() - 1);
+    }
+
+    int32_t Document::AddSprite(int32_t parent, NodeType type, int32_t fillBrush, int32_t strokeBrush, float strokeWidth)
+    {
+        Node node = {};
+        node.Type = type;
+        node.Parent = parent;
+        node.Transform = Matrix::Identity();
+        node.FillBrush = fillBrush;
+        node.StrokeBrush = strokeBrush;
+        node.StrokeWidth = strokeWidth;
+        Nodes.push_back(node);
+        return static_cast<int32_t>(Nodes.size() - 1);
+    }
+
+    int32_t Document::AddColorBrush(Color color)
+    {
+        for (auto i = 0u; i < Brushes.size(); i++)
+        {
+            auto& brush = Brushes[i];
+            if (brush.Type == BrushType::Color && memcmp(&brush.Color, &color, sizeof(color)) == 0)
+            {
+                return static_cast<int32_t>(i);
+            }
+        }
+
+        Brush brush = {};
+        brush.Type = BrushType::Color;
+        brush.Color = color;
+        Brushes.push_back(brush);
+        return static_cast<int32_t>(Brushes.size() - 1);
+    }
+
+    int32_t Document::AddLinearGradientBrush(Span<GradientStop> stops)
+    {
+        for (auto i = 0u; i < Brushes.size(); i++)
+        {
+            auto& brush = Brushes[i];
+            if (brush.Type == BrushType::LinearGradient &&
+                brush.StopCount == stops.Size &&
+                (stops.empty() || memcmp(&Stops[brush.FirstStop], stops.Data, stops.Size * sizeof(GradientStop)) == 0))
+            {
+                return static_cast<int32_t>(i);
+            }
+        }
+
+        Brush brush = {};
+        brush.Type = BrushType::LinearGradient;
+        brush.FirstStop = static_cast<uint32_t>(Stops.size());
+        brush.StopCount = static_cast<uint32_t>(stops.Size);
+        Stops.insert(Stops.end(), stops.begin(), stops.end());
+        Brushes.push_back(brush);
+        return static_cast<int32_t>(Brushes.size() - 1);
+    }
+
+    bool ValidateBrushIndex(DocumentView const& document, int32_t brush)
+    {
+        return brush == NoBrush || (brush >= 0 && static_cast<size_t>(brush) < document.Brushes.Size);
+    }
+
+    bool Validate(DocumentView const& document)
+    {
+        // The first node is the root
+        if (document.Nodes.empty() ||
+            document.Nodes[0].Type != NodeType::Container ||
+            document.Nodes[0].Parent != NoParent)
+        {
+            return false;
+        }
+
+        for (auto& brush : document.Brushes)
+        {
+            if (brush.Type == BrushType::LinearGradient &&
+                static_cast<uint64_t>(brush.FirstStop) + brush.StopCount > document.Stops.Size)
+            {
+                return false;
+            }
+        }
+
+        for (auto i = 1u; i < document.Nodes.Size; i++)
+        {
+            auto& node = document.Nodes[i];
+            if (node.Parent < 0 ||
+                static_cast<size_t>(node.Parent) >= i ||
+                document.Nodes[node.Parent].Type != NodeType::Container ||
+                !ValidateBrushIndex(document, node.FillBrush) ||
+                !ValidateBrushIndex(document, node.StrokeBrush))
+            {
+                return false;
+            }
+
+            switch (node.Type)
+            {
+            case NodeType::Container:
+            case NodeType::Rectangle:
+            case NodeType::RoundedRectangle:
+            case NodeType::Ellipse:
+                break;
+            case NodeType::Path:
+            {
+                if (static_cast<uint64_t>(node.FirstSegment) + node.SegmentCount > document.Segments.Size ||
+                    static_cast<uint64_t>(node.FirstPoint) + node.PointCount > document.Points.Size)
+                {
+                    return false;
+                }
+                // The segments need to account for exactly the points we have
+                uint64_t points = 0;
+                for (auto segment = 0u; segment < node.SegmentCount; segment++)
+                {
+                    switch (document.Segments[node.FirstSegment + segment])
+                    {
+                    case SegmentType::MoveTo:
+                    case SegmentType::LineTo:
+                        points += 1;
+                        break;
+                    case SegmentType::CubicTo:
+                        points += 3;
+                        break;
+                    case SegmentType::Close:
+                        break;
+                    default:
+                        return false;
+                    }
+                }
+                if (points != node.PointCount)
+                {
+                    return false;
+                }
+            }
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t HashBytes(void const* data, size_t size, uint64_t hash)
+    {
+        auto bytes = static_cast<uint8_t const*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t HashValue(T const& value, uint64_t hash)
+    {
+        return HashBytes(&value, sizeof(value), hash);
+    }
+
+    uint64_t HashGeometry(DocumentView const& document, Node const& node)
+    {
+        auto hash = HashValue(node.Type, HashSeed);
+        if (node.Type != NodeType::Path)
+        {
+            return HashValue(node.Params, hash);
+        }
+        hash = HashBytes(document.Segments.Data + node.FirstSegment, node.SegmentCount * sizeof(SegmentType), hash);
+        return HashBytes(document.Points.Data + node.FirstPoint, node.PointCount * sizeof(Point), hash);
+    }
+
+    bool SameGeometry(DocumentView const& left, Node const& leftNode, DocumentView const& right, Node const& rightNode)
+    {
+        if (leftNode.Type != rightNode.Type)
+        {
+            return false;
+        }
+        if (leftNode.Type != NodeType::Path)
+        {
+            return memcmp(leftNode.Params, rightNode.Params, sizeof(leftNode.Params)) == 0;
+        }
+        return leftNode.SegmentCount == rightNode.SegmentCount &&
+            leftNode.PointCount == rightNode.PointCount &&
+            memcmp(left.Segments.Data + leftNode.FirstSegment, right.Segments.Data + rightNode.FirstSegment, leftNode.SegmentCount * sizeof(SegmentType)) == 0 &&
+            memcmp(left.Points.Data + leftNode.FirstPoint, right.Points.Data + rightNode.FirstPoint, leftNode.PointCount * sizeof(Point)) == 0;
+    }
+
+    uint64_t HashBrush(DocumentView const& document, int32_t index, uint64_t hash)
+    {
+        if (index == NoBrush)
+        {
+            return HashValue(index, hash);
+        }
+        auto& brush = document.Brushes[index];
+        hash = HashValue(brush.Type, hash);
+        if (brush.Type == BrushType::Color)
+        {
+            return HashValue(brush.Color, hash);
+        }
+        return HashBytes(document.Stops.Data + brush.FirstStop, brush.StopCount * sizeof(GradientStop), hash);
+    }
+
+    std::vector<uint64_t> HashSubtrees(DocumentView const& document)
+    {
+        // Children always come after their parents, so walking backwards
+        // finishes every subtree before its parent needs it. The children
+        // are folded in back to front, which is just as order dependent.
+        std::vector<uint64_t> children(document.Nodes.Size, HashSeed);
+        std::vector<uint64_t> hashes(document.Nodes.Size);
+        for (auto i = document.Nodes.Size; i-- > 0;)
+        {
+            auto& node = document.Nodes[i];
+            auto hash = HashValue(node.Type, HashSeed);
+            auto transform = (node.Flags & NodeHasTransform) ? node.Transform : Matrix::Identity();
+            hash = HashValue(transform, hash);
+            if (node.Type != NodeType::Container)
+            {
+                hash = HashValue(HashGeometry(document, node), hash);
+                hash = HashBrush(document, node.FillBrush, hash);
+                hash = HashBrush(document, node.StrokeBrush, hash);
+                hash = HashValue(node.StrokeWidth, hash);
+            }
+            hash = HashValue(children[i], hash);
+            hashes[i] = hash;
+            if (node.Parent != NoParent)
+            {
+                children[node.Parent] = HashValue(hash, children[node.Parent]);
+            }
+        }
+        return hashes;
+    }
+
+    // Same as BuildRoundedRectShape used to do, the stroke is kept inside
+    // of the given size.
+    void AddRoundedRect(
+        Document& document,
+        float x,
+        float y,
+        float width,
+        float height,
+        float cornerRadius,
+        float strokeThickness,
+        int32_t strokeBrush,
+        int32_t fillBrush)
+    {
+        auto node = document.AddSprite(0, NodeType::RoundedRectangle, fillBrush, strokeBrush, strokeThickness);
+        auto& params = document.Nodes[node].Params;
+        params[0] = x + (strokeThickness / 2.0f);
+        params[1] = y + (strokeThickness / 2.0f);
+        params[2] = width - strokeThickness;
+        params[3] = height - strokeThickness;
+        params[4] = cornerRadius;
+        params[5] = cornerRadius;
+    }
+
+    Document BuildCardBack(CardShapeMetrics const& metrics)
+    {
+        Document document;
+        document.AddContainer(NoParent);
+        auto black = document.AddColorBrush({ 255, 0, 0, 0 });
+        auto white = document.AddColorBrush({ 255, 255, 255, 255 });
+        auto backgroundBaseColor = document.AddColorBrush({ 255, 0, 0, 255 });
+
+        AddRoundedRect(document, 0, 0, metrics.Width, metrics.Height, metrics.CornerRadius, 0.5f, black, backgroundBaseColor);
+
+        auto innerOffset = 12.0f;
+        auto innerWidth = metrics.Width - innerOffset;
+        auto innerHeight = metrics.Height - innerOffset;
+        AddRoundedRect(document, innerOffset / 2.0f, innerOffset / 2.0f, innerWidth, innerHeight, metrics.CornerRadius, 5, white, backgroundBaseColor);
+        return document;
+    }
+
+    Document BuildEmptyPile(CardShapeMetrics const& metrics)
+    {
+        Document document;
+        document.AddContainer(NoParent);
+        auto gray = document.AddColorBrush({ 255, 128, 128, 128 });
+
+        AddRoundedRect(document, 0, 0, metrics.Width, metrics.Height, metrics.CornerRadius, 5, gray, NoBrush);
+
+        // The inner rect is filled and has no stroke
+        auto innerWidth = metrics.Width / 2.0f;
+        auto innerHeight = metrics.Height / 2.0f;
+        auto node = document.AddSprite(0, NodeType::RoundedRectangle, gray, NoBrush, 5);
+        auto& params = document.Nodes[node].Params;
+        params[0] = (metrics.Width - innerWidth) / 2.0f;
+        params[1] = (metrics.Height - innerHeight) / 2.0f;
+        params[2] = innerWidth;
+        params[3] = innerHeight;
+        params[4] = metrics.CornerRadius;
+        params[5] = metrics.CornerRadius;
+        return document;
+    }
+
+    Document BuildCardPlaceholder(CardShapeMetrics const& metrics)
+    {
+        Document document;
+        document.AddContainer(NoParent);
+        auto black = document.AddColorBrush({ 255, 0, 0, 0 });
+        auto white = document.AddColorBrush({ 255, 255, 255, 255 });
+
+        // Same outline as the faces, so only the pips pop in
+        AddRoundedRect(document, 0, 0, metrics.Width, metrics.Height, metrics.CornerRadius, 0.5f, black, white);
+        return document;
+    }
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// A neutral description of the shapes that make up a card. It mirrors the
+// tree of composition shapes that SvgShapesBuilder produces, but is made of
+// flat arrays of plain structs so that it can be written to disk as-is and
+// read back without any fixups.
+namespace CardGeometry
+{
+    enum class NodeType : uint32_t
+    {
+        // Everything except containers becomes a sprite shape
+        Container,
+        Path,
+        Rectangle,
+        RoundedRectangle,
+        Ellipse,
+    };
+
+    enum class SegmentType : uint8_t
+    {
+        // Consumes 1 point
+        MoveTo,
+        // Consumes 1 point
+        LineTo,
+        // Consumes 3 points (control 1, control 2, end)
+        CubicTo,
+        // Consumes no points
+        Close,
+    };
+
+    enum class BrushType : uint32_t
+    {
+        Color,
+        LinearGradient,
+    };
+
+    const uint32_t NodeHasTransform = 0x1;
+    const uint32_t DocumentHasViewBox = 0x1;
+    const int32_t NoBrush = -1;
+    const int32_t NoParent = -1;
+
+    struct Point
+    {
+        float X;
+        float Y;
+    };
+
+    struct Color
+    {
+        uint8_t A;
+        uint8_t R;
+        uint8_t G;
+        uint8_t B;
+    };
+
+    // Same layout as D2D1_MATRIX_3X2_F and float3x2
+    struct Matrix
+    {
+        float M11;
+        float M12;
+        float M21;
+        float M22;
+        float M31;
+        float M32;
+
+        static Matrix Identity() { return { 1, 0, 0, 1, 0, 0 }; }
+        static Matrix Translation(float x, float y) { return { 1, 0, 0, 1, x, y }; }
+        bool IsIdentity() const { return M11 == 1 && M12 == 0 && M21 == 0 && M22 == 1 && M31 == 0 && M32 == 0; }
+        Point TransformPoint(Point point) const { return { point.X * M11 + point.Y * M21 + M31, point.X * M12 + point.Y * M22 + M32 }; }
+    };
+
+    // Applies first, then second
+    Matrix Multiply(Matrix const& first, Matrix const& second);
+
+    struct GradientStop
+    {
+        float Offset;
+        CardGeometry::Color Color;
+    };
+
+    struct Brush
+    {
+        BrushType Type;
+        // Only used by color brushes
+        CardGeometry::Color Color;
+        // Only used by gradient brushes, indexes into the stop array
+        uint32_t FirstStop;
+        uint32_t StopCount;
+    };
+
+    struct ViewBox
+    {
+        float X;
+        float Y;
+        float Width;
+        float Height;
+    };
+
+    struct Node
+    {
+        NodeType Type;
+        // Parents always come before their children, and children are
+        // stored in drawing order.
+        int32_t Parent;
+        uint32_t Flags;
+        Matrix Transform;
+        int32_t FillBrush;
+        int32_t StrokeBrush;
+        float StrokeWidth;
+        // Rectangle:        x, y, width, height
+        // RoundedRectangle: x, y, width, height, corner radius x, corner radius y
+        // Ellipse:          center x, center y, radius x, radius y
+        float Params[6];
+        // Only used by paths, indexes into the segment and point arrays
+        uint32_t FirstSegment;
+        uint32_t SegmentCount;
+        uint32_t FirstPoint;
+        uint32_t PointCount;
+    };
+
+    template <typename T>
+    struct Span
+    {
+        T const* Data = nullptr;
+        size_t Size = 0;
+
+        T const* begin() const { return Data; }
+        T const* end() const { return Data + Size; }
+        T const& operator[](size_t index) const { return Data[index]; }
+        bool empty() const { return Size == 0; }
+    };
+
+    // A read-only view over a document, either one in memory or one that
+    // lives in a mapped bundle.
+    struct DocumentView
+    {
+        uint32_t Flags = 0;
+        CardGeometry::ViewBox ViewBox = {};
+        Span<Node> Nodes;
+        Span<SegmentType> Segments;
+        Span<Point> Points;
+        Span<Brush> Brushes;
+        Span<GradientStop> Stops;
+
+        bool HasViewBox() const { return (Flags & DocumentHasViewBox) != 0; }
+    };
+
+    struct Document
+    {
+        uint32_t Flags = 0;
+        CardGeometry::ViewBox ViewBox = {};
+        std::vector<Node> Nodes;
+        std::vector<SegmentType> Segments;
+        std::vector<Point> Points;
+        std::vector<Brush> Brushes;
+        std::vector<GradientStop> Stops;
+
+        DocumentView View() const;
+
+        int32_t AddContainer(int32_t parent);
+        int32_t AddSprite(int32_t parent, NodeType type, int32_t fillBrush, int32_t strokeBrush, float strokeWidth);
+        // Identical brushes share an entry
+        int32_t AddColorBrush(Color color);
+        int32_t AddLinearGradientBrush(Span<GradientStop> stops);
+    };
+
+    // Checks that every index in the document is in range, so that
+    // consumers can walk it without any further checks.
+    bool Validate(DocumentView const& document);
+
+    // FNV-1a
+    const uint64_t HashSeed = 0xcbf29ce484222325ull;
+    uint64_t HashBytes(void const* data, size_t size, uint64_t hash = HashSeed);
+
+    // Hashes what a sprite's geometry looks like (its type and parameters,
+    // or its path data) without regard to where in which document it
+    // lives, so that identical shapes can be found across cards.
+    uint64_t HashGeometry(DocumentView const& document, Node const& node);
+    bool SameGeometry(DocumentView const& left, Node const& leftNode, DocumentView const& right, Node const& rightNode);
+    // Hashes a brush by value (its color or its stops), NoBrush included
+    uint64_t HashBrush(DocumentView const& document, int32_t brush, uint64_t hash = HashSeed);
+
+    // Hashes the subtree under every node: geometry, transform, stroke
+    // width, brushes by value (indices differ between documents) and the
+    // children in drawing order. Equal hashes draw the same thing.
+    std::vector<uint64_t> HashSubtrees(DocumentView const& document);
+
+    // The card back, the empty pile marker and the blank face shown until
+    // a card's face has loaded. These match the size and corner radius of
+    // CompositionCard.
+    struct CardShapeMetrics
+    {
+        float Width = 167.0f;
+        float Height = 243.0f;
+        float CornerRadius = 9.5f;
+    };
+
+    Document BuildCardBack(CardShapeMetrics const& metrics);
+    Document BuildEmptyPile(CardShapeMetrics const& metrics);
+    Document BuildCardPlaceholder(CardShapeMetrics const& metrics);
+}
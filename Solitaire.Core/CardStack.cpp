@@ -13,7 +13,12 @@ namespace winrt
 
 void CardStack::SetLayoutOptions(float verticalOffset)
 {
-    m_verticalOffset = verticalOffset;
+    if (m_verticalOffset != verticalOffset)
+    {
+        m_verticalOffset = verticalOffset;
+        // The first card always sits on the base, so only the ones after it move
+        InvalidateLayout(1);
+    }
 }
 
 bool CardStack::CanSplit(int index)
@@ -76,11 +81,6 @@ winrt::float3 CardStack::ComputeOffset(int index, int totalCards)
     return { 0, index == 0 ? 0 : m_verticalOffset, 0 };
 }
 
-winrt::float3 CardStack::ComputeBaseSpaceOffset(int index, int totalCards)
-{
-    return { 0, index * m_verticalOffset, 0 };
-}
-
 void CardStack::OnRemovalCompleted(Pile::RemovalOperation operation)
 {
     if (!m_cards.empty())
@@ -17,7 +17,6 @@ public:
 
 protected:
     virtual winrt::Windows::Foundation::Numerics::float3 ComputeOffset(int index, int totalCards) override;
-    virtual winrt::Windows::Foundation::Numerics::float3 ComputeBaseSpaceOffset(int index, int totalCards) override;
     virtual void OnRemovalCompleted(Pile::RemovalOperation operation) override;
 
 private:
@@ -17,12 +17,22 @@ namespace winrt
 const winrt::float2 CompositionCard::CardSize = { 167, 243 };
 const winrt::float2 CompositionCard::CornerRadius = { 9.5f, 9.5f };
 
-winrt::ShapeVisual BuildCardFront(
+winrt::Visual BuildCardFront(
     std::shared_ptr<ShapeCache> const& shapeCache,
     Card const& card,
     winrt::Color const& color)
 {
     auto compositor = shapeCache->Compositor();
+    if (auto atlas = shapeCache->Atlas())
+    {
+        auto spriteVisual = compositor.CreateSpriteVisual();
+        spriteVisual.Size(CompositionCard::CardSize);
+        spriteVisual.BackfaceVisibility(winrt::CompositionBackfaceVisibility::Hidden);
+        spriteVisual.Brush(atlas->GetBrush(card));
+        spriteVisual.Comment(card.ToString());
+        return spriteVisual;
+    }
+
     auto shapeVisual = compositor.CreateShapeVisual();
     auto shapeContainer = compositor.CreateContainerShape();
     shapeVisual.Shapes().Append(shapeContainer);
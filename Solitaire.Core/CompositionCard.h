@@ -26,7 +26,7 @@ public:
 private:
     winrt::Windows::UI::Composition::ContainerVisual m_root{ nullptr };
     winrt::Windows::UI::Composition::ContainerVisual m_sidesRoot{ nullptr };
-    winrt::Windows::UI::Composition::ShapeVisual m_front{ nullptr };
+    winrt::Windows::UI::Composition::Visual m_front{ nullptr };
     winrt::Windows::UI::Composition::ShapeVisual m_back{ nullptr };
     Card m_card;
     bool m_isFaceUp = true;
@@ -0,0 +1,56 @@
+#include "DetailLevels.h"
+
+namespace DetailLevels
+{
+    GeometrySimplifier::Options LevelOptions(GeometrySimplifier::Options const& options, uint32_t level)
+    {
+        // A zero tolerance stays off at every level
+        auto result = options;
+        result.Tolerance = options.Tolerance * ToleranceScales[level];
+        return result;
+    }
+
+    std::string EntryName(std::string const& name, uint32_t level)
+    {
+        if (level == 0)
+        {
+            return name;
+        }
+        return name + "@" + std::to_string(level);
+    }
+
+    uint32_t LevelOf(std::string const& entryName)
+    {
+        auto separator = entryName.rfind('@');
+        if (separator == std::string::npos || separator + 1 == entryName.size())
+        {
+            return 0;
+        }
+        uint32_t level = 0;
+        for (auto i = separator + 1; i < entryName.size(); i++)
+        {
+            if (entryName[i] < '0' || entryName[i] > '9')
+            {
+                return 0;
+            }
+            level = level * 10 + (entryName[i] - '0');
+        }
+        return level;
+    }
+
+    uint32_t Select(float scale, uint32_t currentLevel)
+    {
+        auto level = currentLevel < Count ? currentLevel : 0;
+        // Growing only gets more detail once it's clearly needed...
+        while (level > 0 && scale > Scales[level] * (1.0f + Hysteresis))
+        {
+            level--;
+        }
+        // ...while shrinking drops detail as soon as it can't be seen
+        while (level + 1 < Count && scale <= Scales[level + 1])
+        {
+            level++;
+        }
+        return level;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "GeometrySimplifier.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Every card face comes in a few levels of detail. Level 0 is simplified
+// for the card's full size, each level after it for a card drawn at a
+// smaller scale, which comes down to a larger tolerance. GameApp shrinks
+// the board to fit small windows, and there the lower levels draw the
+// same picture with a fraction of the shapes.
+//
+// In a bundle, level 0 is stored under the face's name and the others
+// under "<name>@<level>".
+namespace DetailLevels
+{
+    const uint32_t Count = 3;
+    // The scale each level is used down to
+    const float Scales[Count] = { 1.0f, 0.5f, 0.25f };
+    // Each level's tolerance as a multiple of level 0's. Halving the
+    // scale alone would only double it, but at half size the detail that
+    // survives is mostly noise, so each level also doubles the error it
+    // allows in pixels.
+    const float ToleranceScales[Count] = { 1.0f, 4.0f, 16.0f };
+    // How far past a level's scale the board has to grow before we go
+    // back to the more detailed level, so that a resize hovering around
+    // the boundary doesn't keep swapping the shapes
+    const float Hysteresis = 0.15f;
+
+    // The options for level 0 adjusted for the given level
+    GeometrySimplifier::Options LevelOptions(GeometrySimplifier::Options const& options, uint32_t level);
+
+    std::string EntryName(std::string const& name, uint32_t level);
+    // Zero for names without a level
+    uint32_t LevelOf(std::string const& entryName);
+
+    // The least detailed level that still looks right at the given scale,
+    // starting from the level currently shown
+    uint32_t Select(float scale, uint32_t currentLevel);
+}
@@ -55,11 +55,6 @@ winrt::float3 Foundation::ComputeOffset(int index, int totalCards)
     return { 0, 0, 0 };
 }
 
-winrt::float3 Foundation::ComputeBaseSpaceOffset(int index, int totalCards)
-{
-    return { 0, 0, 0 };
-}
-
 void Foundation::OnRemovalCompleted(Pile::RemovalOperation operation)
 {
 }
@@ -15,6 +15,5 @@ public:
 
 protected:
     virtual winrt::Windows::Foundation::Numerics::float3 ComputeOffset(int index, int totalCards) override;
-    virtual winrt::Windows::Foundation::Numerics::float3 ComputeBaseSpaceOffset(int index, int totalCards) override;
     virtual void OnRemovalCompleted(Pile::RemovalOperation operation) override;
 };
\ No newline at end of file
@@ -18,40 +18,6 @@ namespace winrt
     using namespace Windows::UI::Popups;
 }
 
-template <typename PileType>
-std::pair<Pile::HitTestResult, std::shared_ptr<PileType>> HitTestPiles(
-    winrt::float2 const point,
-    std::map<HitTestZone, winrt::Rect>& zoneRects,
-    std::vector<std::shared_ptr<PileType>> const& piles,
-    HitTestZone zoneType,
-    std::initializer_list<Pile::HitTestTarget> const& desiredTargets)
-{
-    // The point is in window space
-    // Convert from window space to container space (Play Area, Foundation, etc)
-    auto containerPoint = point;
-    auto containerHitTestRect = zoneRects[zoneType];
-    containerPoint.x -= containerHitTestRect.X;
-    containerPoint.y -= containerHitTestRect.Y;
-    for (auto& pile : piles)
-    {
-        // The point is in container space
-        // Convert from container space to local space for the pile
-        auto localPoint = containerPoint;
-        localPoint.x -= pile->Base().Offset().x;
-        localPoint.y -= pile->Base().Offset().y;
-        auto result = pile->HitTest(localPoint);
-        for (auto& target : desiredTargets)
-        {
-            if (result.Target == target)
-            {
-                return { result, pile };
-            }
-        }
-    }
-
-    return { Pile::HitTestResult(), nullptr };
-}
-
 Game::Game(
     winrt::Compositor const& compositor, 
     winrt::float2 const hostSize,
@@ -77,49 +43,55 @@ Game::Game(
     m_visuals = m_boardLayer.Children();
 
     // Get layout info
-    auto textHeight = m_shapeCache->TextHeight();
-    m_layoutInfo.CardStackVerticalOffset = textHeight;
     const auto cardSize = CompositionCard::CardSize;
-
-    // Play Area
-    auto playAreaOffsetY = cardSize.y + 25.0f;
+    LayoutSolverParameters solverParameters;
+    solverParameters.CardWidth = cardSize.x;
+    solverParameters.CardHeight = cardSize.y;
+    solverParameters.PreferredVerticalOffset = m_shapeCache->TextHeight();
+    solverParameters.PreferredWasteOffset = m_layoutInfo.WasteHorizontalOffset;
+    m_layoutSolver = LayoutSolver(solverParameters);
+    m_hostSize = hostSize;
+    m_boardMetrics = m_layoutSolver.Solve(m_hostSize.x, m_hostSize.y, LayoutSolver::NumberOfColumns);
+    m_layoutInfo.CardStackVerticalOffset = m_boardMetrics.CardStackVerticalOffset;
+    m_layoutInfo.WasteHorizontalOffset = m_boardMetrics.WasteHorizontalOffset;
+
+    // Zones, these get positioned by PositionZones
     m_playAreaVisual = m_compositor.CreateContainerVisual();
-    m_playAreaVisual.Offset({ 0, playAreaOffsetY, 0 });
-    m_playAreaVisual.Size({ 0, -playAreaOffsetY });
     m_playAreaVisual.RelativeSizeAdjustment({ 1, 1 });
     m_playAreaVisual.Comment(L"Play Area Root");
     m_visuals.InsertAtTop(m_playAreaVisual);
-    m_zoneRects.insert({ HitTestZone::PlayArea, { 0, playAreaOffsetY, hostSize.x, hostSize.y - playAreaOffsetY } });
 
-    // Deck
     m_deckVisual = m_compositor.CreateContainerVisual();
     m_deckVisual.Size(CompositionCard::CardSize);
     m_deckVisual.Comment(L"Deck Area Root");
     m_visuals.InsertAtTop(m_deckVisual);
-    m_zoneRects.insert({ HitTestZone::Deck, { 0, 0, cardSize.x, cardSize.y } });
 
-    // Waste
     m_wasteVisual = m_compositor.CreateContainerVisual();
-    m_wasteVisual.Size({ (2.0f * m_layoutInfo.WasteHorizontalOffset) + cardSize.x, cardSize.y });
-    m_wasteVisual.Offset({ cardSize.x + 25.0f, 0, 0 });
     m_wasteVisual.Comment(L"Waste Area Root");
     m_visuals.InsertAtTop(m_wasteVisual);
-    m_zoneRects.insert({ HitTestZone::Waste, { cardSize.x + 25.0f, 0, (2.0f * m_layoutInfo.WasteHorizontalOffset) + cardSize.x, cardSize.y } });
 
-    // Foundation
     m_foundationVisual = m_compositor.CreateContainerVisual();
-    m_foundationVisual.Size({ 4.0f * cardSize.x + 3.0f * 15.0f, cardSize.y });
-    m_foundationVisual.AnchorPoint({ 1, 0 });
-    m_foundationVisual.RelativeOffsetAdjustment({ 1, 0, 0 });
     m_foundationVisual.Comment(L"Foundations Root");
     m_visuals.InsertAtTop(m_foundationVisual);
-    m_zoneRects.insert({ HitTestZone::Foundations, { hostSize.x - m_foundationVisual.Size().x, 0, m_foundationVisual.Size().x, m_foundationVisual.Size().y } });
+
+    // Board layout, the origins are filled in by RefreshBoardLayout
+    m_boardLayout.AddPile(PileKind::Deck, 0, 0);
+    m_boardLayout.AddPile(PileKind::Waste, 0, 0);
+    for (auto i = 0; i < 4; i++)
+    {
+        m_boardLayout.AddPile(PileKind::Foundation, 0, 0);
+    }
+    for (auto i = 0; i < 7; i++)
+    {
+        m_boardLayout.AddPile(PileKind::Stack, 0, 0);
+    }
 
     NewGame();
 }
 
 void Game::NewGame()
 {
+    StartupSpan span("NewGame");
     m_pack = std::make_unique<Pack>(m_shapeCache);
 #ifdef _DEBUG
     //m_pack->Shuffle({ 1318857190, 1541316502, 3202618166, 965450609 });
@@ -134,6 +106,7 @@ void Game::NewGame()
     m_deck = ConstructDeck(cards, numCardsUsed);
     m_waste = ConstructWaste();
     m_foundations = ConstructFoundations();
+    PrioritizeCardFaces();
 
     m_selectedLayer.Children().RemoveAll();
     m_selectedVisual = nullptr;
@@ -142,6 +115,8 @@ void Game::NewGame()
     m_lastOperation = Pile::RemovalOperation();
     m_lastPile = nullptr;
     m_lastHitTest = Pile::HitTestResult();
+
+    Relayout();
 }
 
 void Game::OnPointerPressed(winrt::float2 const point)
@@ -165,17 +140,22 @@ void Game::OnPointerPressed(winrt::float2 const point)
             {
             case HitTestZone::Deck:
             {
-                if (m_deck->HitTest(point))
+                // The deck expects the point in the local space of its zone
+                if (m_deck->HitTest({ point.x - rect.X, point.y - rect.Y }))
                 {
                     auto cards = m_deck->Draw();
 
                     if (!cards.empty())
                     {
-                        // Compute difference between the two zones
-                        auto deckZoneRect = m_zoneRects[HitTestZone::Deck];
-                        auto wasteZoneRect = m_zoneRects[HitTestZone::Waste];
-                        auto dX = wasteZoneRect.X - deckZoneRect.X;
-                        auto dy = wasteZoneRect.Y - deckZoneRect.Y;
+                        // Lay the board out as it will be once the cards have
+                        // landed to find out where they need to go.
+                        RefreshBoardLayout();
+                        auto wasteCount = static_cast<int>(m_waste->Cards().size());
+                        m_boardLayout.SetCardCount(WasteLayoutPile, wasteCount + static_cast<int>(cards.size()));
+                        m_boardLayout.Compute({ CompositionCard::CardSize.x, CompositionCard::CardSize.y, m_layoutInfo.CardStackVerticalOffset, m_layoutInfo.WasteHorizontalOffset });
+                        auto wasteStart = m_boardLayout.PileStart(WasteLayoutPile);
+                        auto deckX = m_boardLayout.OriginX(DeckLayoutPile);
+                        auto deckY = m_boardLayout.OriginY(DeckLayoutPile);
 
                         auto batch = m_compositor.CreateScopedBatch(winrt::CompositionBatchTypes::Animation);
 
@@ -183,15 +163,16 @@ void Game::OnPointerPressed(winrt::float2 const point)
                         for (auto& card : cards)
                         {
                             auto visual = card->Root();
+                            visual.Offset({ deckX, deckY, 0 });
                             m_visuals.InsertAtTop(visual);
 
                             auto duration = std::chrono::milliseconds(250);
                             auto delayTime = std::chrono::milliseconds(50 * count);
 
-                            // TODO: Sync this up with the deck visual's actual position (transform parent?)
+                            auto targetX = m_boardLayout.X()[wasteStart + wasteCount + count];
                             auto xAnimation = m_compositor.CreateScalarKeyFrameAnimation();
-                            xAnimation.InsertKeyFrame(0, 0);
-                            xAnimation.InsertKeyFrame(1, CompositionCard::CardSize.x + 25.0f + count * m_layoutInfo.WasteHorizontalOffset);
+                            xAnimation.InsertKeyFrame(0, deckX);
+                            xAnimation.InsertKeyFrame(1, targetX);
                             xAnimation.IterationBehavior(winrt::AnimationIterationBehavior::Count);
                             xAnimation.IterationCount(1);
                             xAnimation.Duration(duration);
@@ -325,6 +306,9 @@ void Game::OnPointerReleased(winrt::float2 const point)
                 m_lastPile->CompleteRemoval(m_lastOperation);
             }
 
+            // The tallest column might have changed
+            Relayout();
+
             // If we just added something to a foundation, let's check to see
             // if the player has won.
             if (hitTestZone == HitTestZone::Foundations)
@@ -365,15 +349,72 @@ void Game::OnPointerReleased(winrt::float2 const point)
 
 void Game::OnSizeChanged(winrt::float2 const size)
 {
-    auto playAreaOffsetY = m_playAreaVisual.Offset().y;
-    m_zoneRects.insert({ HitTestZone::PlayArea, { 0, playAreaOffsetY, size.x, size.y - playAreaOffsetY } });
-    m_zoneRects[HitTestZone::Foundations] = { size.x - m_foundationVisual.Size().x, 0, m_foundationVisual.Size().x, m_foundationVisual.Size().y };
+    m_hostSize = size;
+    Relayout();
 }
 
-std::pair<std::vector<std::shared_ptr<CardStack>>, int> Game::ConstructStacks(Pile::CardList const& cards)
+void Game::Relayout()
 {
-    const auto cardSize = CompositionCard::CardSize;
+    auto tallestColumn = 0;
+    for (auto& stack : m_stacks)
+    {
+        tallestColumn = std::max(tallestColumn, static_cast<int>(stack->Cards().size()));
+    }
 
+    m_boardMetrics = m_layoutSolver.Solve(m_hostSize.x, m_hostSize.y, tallestColumn);
+    PositionZones();
+
+    auto layoutInfo = m_layoutInfo;
+    layoutInfo.CardStackVerticalOffset = m_boardMetrics.CardStackVerticalOffset;
+    layoutInfo.WasteHorizontalOffset = m_boardMetrics.WasteHorizontalOffset;
+    SetNewLayout(layoutInfo);
+
+    // Bring the hit testing positions up to date in the same pass
+    RefreshBoardLayout();
+}
+
+void Game::PositionZones()
+{
+    auto const cardSize = CompositionCard::CardSize;
+    auto const& metrics = m_boardMetrics;
+
+    m_playAreaVisual.Offset({ 0, metrics.PlayAreaTop, 0 });
+    m_playAreaVisual.Size({ 0, -metrics.PlayAreaTop });
+    m_deckVisual.Offset({ metrics.ColumnX(0), metrics.BoardTop, 0 });
+    m_wasteVisual.Offset({ metrics.ColumnX(1), metrics.BoardTop, 0 });
+    m_foundationVisual.Offset({ metrics.ColumnX(3), metrics.BoardTop, 0 });
+    m_foundationVisual.Size({ 4.0f * cardSize.x + 3.0f * metrics.ColumnSpacing, cardSize.y });
+
+    for (auto i = 0; i < m_foundations.size(); i++)
+    {
+        m_foundations[i]->Base().Offset({ i * (cardSize.x + metrics.ColumnSpacing), 0, 0 });
+    }
+    for (auto i = 0; i < m_stacks.size(); i++)
+    {
+        m_stacks[i]->Base().Offset({ metrics.ColumnX(i), 0, 0 });
+    }
+
+    UpdateZoneRects();
+}
+
+void Game::UpdateZoneRects()
+{
+    auto const cardSize = CompositionCard::CardSize;
+    winrt::float3 const deckOffset = m_deckVisual.Offset();
+    winrt::float3 const wasteOffset = m_wasteVisual.Offset();
+    winrt::float3 const foundationOffset = m_foundationVisual.Offset();
+    winrt::float2 const foundationSize = m_foundationVisual.Size();
+    auto playAreaOffsetY = m_boardMetrics.PlayAreaTop;
+
+    m_wasteVisual.Size({ (2.0f * m_layoutInfo.WasteHorizontalOffset) + cardSize.x, cardSize.y });
+    m_zoneRects[HitTestZone::PlayArea] = { 0, playAreaOffsetY, m_hostSize.x, m_hostSize.y - playAreaOffsetY };
+    m_zoneRects[HitTestZone::Deck] = { deckOffset.x, deckOffset.y, cardSize.x, cardSize.y };
+    m_zoneRects[HitTestZone::Waste] = { wasteOffset.x, wasteOffset.y, (2.0f * m_layoutInfo.WasteHorizontalOffset) + cardSize.x, cardSize.y };
+    m_zoneRects[HitTestZone::Foundations] = { foundationOffset.x, foundationOffset.y, foundationSize.x, foundationSize.y };
+}
+
+std::pair<std::vector<std::shared_ptr<CardStack>>, int> Game::ConstructStacks(Pile::CardList const& cards)
+{
     std::vector<std::shared_ptr<CardStack>> stacks;
     auto playAreaVisuals = m_playAreaVisual.Children();
     playAreaVisuals.RemoveAll();
@@ -392,8 +433,7 @@ std::pair<std::vector<std::shared_ptr<CardStack>>, int> Game::ConstructStacks(Pi
         stack->ForceLayout();
         auto baseVisual = stack->Base();
 
-        // TODO: Compute based on content width and card width
-        baseVisual.Offset({ (float)i * (cardSize.x + 26.33f), 0, 0 });
+        baseVisual.Offset({ m_boardMetrics.ColumnX(i), 0, 0 });
         playAreaVisuals.InsertAtTop(baseVisual);
 
         stacks.push_back(stack);
@@ -410,6 +450,32 @@ std::pair<std::vector<std::shared_ptr<CardStack>>, int> Game::ConstructStacks(Pi
     return { stacks, cardsSoFar };
 }
 
+void Game::PrioritizeCardFaces()
+{
+    // Faces load in the background, starting with the ones on the board
+    // and then the ones a single move could turn over: the card under
+    // each stack's top and the next draw from the deck.
+    std::vector<Card> visible;
+    std::vector<Card> nextReveal;
+    for (auto& stack : m_stacks)
+    {
+        auto& cards = stack->Cards();
+        visible.push_back(cards.back()->Value());
+        if (cards.size() > 1)
+        {
+            nextReveal.push_back(cards[cards.size() - 2]->Value());
+        }
+    }
+    auto& deckCards = m_deck->Cards();
+    for (auto i = 0u; i < std::min<size_t>(deckCards.size(), 3); i++)
+    {
+        nextReveal.push_back(deckCards[deckCards.size() - 1 - i]->Value());
+    }
+
+    m_shapeCache->PrioritizeCardFaces(visible, CardFacePriority::Visible);
+    m_shapeCache->PrioritizeCardFaces(nextReveal, CardFacePriority::NextReveal);
+}
+
 std::unique_ptr<Deck> Game::ConstructDeck(Pile::CardList const& cards, int startAt)
 {
     std::vector<std::shared_ptr<CompositionCard>> deck(cards.begin() + startAt, cards.end());
@@ -440,7 +506,7 @@ std::vector<std::shared_ptr<::Foundation>> Game::ConstructFoundations()
     {
         auto foundation = std::make_shared<::Foundation>(m_shapeCache);
         auto visual = foundation->Base();
-        visual.Offset({ i * (cardSize.x + 15.0f), 0, 0 });
+        visual.Offset({ i * (cardSize.x + m_boardMetrics.ColumnSpacing), 0, 0 });
         m_foundationVisual.Children().InsertAtTop(visual);
         foundations.push_back(foundation);
     }
@@ -456,43 +522,152 @@ winrt::fire_and_forget Game::DisplayWinMessage()
 
 void Game::SetNewLayout(LayoutInformation layoutInfo)
 {
+    auto wasteChanged = layoutInfo.WasteHorizontalOffset != m_layoutInfo.WasteHorizontalOffset;
     m_layoutInfo = layoutInfo;
+
+    // The piles only invalidate the cards affected by the values that
+    // actually changed. Everything is then written out in one pass.
     m_waste->SetLayoutOptions(m_layoutInfo.WasteHorizontalOffset);
-    m_waste->ForceLayout();
     for (auto& stack : m_stacks)
     {
         stack->SetLayoutOptions(m_layoutInfo.CardStackVerticalOffset);
-        stack->ForceLayout();
     }
+    UpdateLayout();
+
+    if (wasteChanged)
+    {
+        UpdateZoneRects();
+    }
+}
+
+void Game::UpdateLayout()
+{
+    std::vector<std::pair<std::shared_ptr<Pile>, int>> dirtyPiles;
+    if (m_waste->IsLayoutDirty())
+    {
+        dirtyPiles.push_back({ m_waste, WasteLayoutPile });
+    }
+    for (auto i = 0; i < m_stacks.size(); i++)
+    {
+        if (m_stacks[i]->IsLayoutDirty())
+        {
+            dirtyPiles.push_back({ m_stacks[i], FirstStackLayoutPile + i });
+        }
+    }
+    for (auto i = 0; i < m_foundations.size(); i++)
+    {
+        if (m_foundations[i]->IsLayoutDirty())
+        {
+            dirtyPiles.push_back({ m_foundations[i], FirstFoundationLayoutPile + i });
+        }
+    }
+
+    if (!dirtyPiles.empty())
+    {
+        RefreshBoardLayout();
+        for (auto& [pile, layoutPile] : dirtyPiles)
+        {
+            pile->UpdateLayout(m_boardLayout, layoutPile);
+        }
+    }
+}
+
+void Game::RefreshBoardLayout()
+{
+    auto updatePile = [&](int layoutPile, HitTestZone zone, winrt::Visual const& base, size_t cardCount)
+    {
+        // Piles are positioned relative to their zone
+        auto zoneRect = m_zoneRects[zone];
+        winrt::float3 const offset = base.Offset();
+        m_boardLayout.SetPileOrigin(layoutPile, zoneRect.X + offset.x, zoneRect.Y + offset.y);
+        m_boardLayout.SetCardCount(layoutPile, static_cast<int>(cardCount));
+    };
+
+    updatePile(DeckLayoutPile, HitTestZone::Deck, m_deck->Base(), m_deck->Cards().size());
+    updatePile(WasteLayoutPile, HitTestZone::Waste, m_waste->Base(), m_waste->Cards().size());
+    for (auto i = 0; i < m_foundations.size(); i++)
+    {
+        auto& foundation = m_foundations[i];
+        updatePile(FirstFoundationLayoutPile + i, HitTestZone::Foundations, foundation->Base(), foundation->Cards().size());
+    }
+    for (auto i = 0; i < m_stacks.size(); i++)
+    {
+        auto& stack = m_stacks[i];
+        updatePile(FirstStackLayoutPile + i, HitTestZone::PlayArea, stack->Base(), stack->Cards().size());
+    }
+
     auto cardSize = CompositionCard::CardSize;
-    m_zoneRects[HitTestZone::Waste] = { cardSize.x + 25.0f, 0, (2.0f * m_layoutInfo.WasteHorizontalOffset) + cardSize.x, cardSize.y };
+    m_boardLayout.Compute({ cardSize.x, cardSize.y, m_layoutInfo.CardStackVerticalOffset, m_layoutInfo.WasteHorizontalOffset });
+}
+
+// The point is in window space
+Pile::HitTestResult Game::HitTestPile(int layoutPile, winrt::float2 const point)
+{
+    Pile::HitTestResult result;
+
+    auto cardIndex = m_boardLayout.HitTest(layoutPile, point.x, point.y);
+    if (cardIndex >= 0)
+    {
+        result.Target = Pile::HitTestTarget::Card;
+        result.CardIndex = cardIndex;
+        return result;
+    }
+
+    auto originX = m_boardLayout.OriginX(layoutPile);
+    auto originY = m_boardLayout.OriginY(layoutPile);
+    auto size = CompositionCard::CardSize;
+    if (point.x >= originX &&
+        point.x < originX + size.x &&
+        point.y >= originY &&
+        point.y < originY + size.y)
+    {
+        result.Target = Pile::HitTestTarget::Base;
+    }
+
+    return result;
 }
 
 std::tuple<std::shared_ptr<Pile>, Pile::HitTestResult, HitTestZone> Game::HitTestPiles(
     winrt::float2 const point,
     std::initializer_list<Pile::HitTestTarget> const& desiredTargets)
 {
+    RefreshBoardLayout();
+
+    auto isDesired = [&](Pile::HitTestResult const& result)
+    {
+        for (auto& target : desiredTargets)
+        {
+            if (result.Target == target)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (auto i = 0; i < m_stacks.size(); i++)
     {
-        auto [result, stack] = ::HitTestPiles(point, m_zoneRects, m_stacks, HitTestZone::PlayArea, desiredTargets);
-        if (result.Target != Pile::HitTestTarget::None)
+        auto result = HitTestPile(FirstStackLayoutPile + i, point);
+        if (isDesired(result))
         {
-            return { stack, result, HitTestZone::PlayArea };
+            return { m_stacks[i], result, HitTestZone::PlayArea };
         }
     }
 
+    for (auto i = 0; i < m_foundations.size(); i++)
     {
-        auto [result, foundation] = ::HitTestPiles(point, m_zoneRects, m_foundations, HitTestZone::Foundations, desiredTargets);
-        if (result.Target != Pile::HitTestTarget::None)
+        auto result = HitTestPile(FirstFoundationLayoutPile + i, point);
+        if (isDesired(result))
         {
-            return { foundation, result, HitTestZone::Foundations };
+            return { m_foundations[i], result, HitTestZone::Foundations };
         }
     }
 
     {
-        auto [result, waste] = ::HitTestPiles<Waste>(point, m_zoneRects, { m_waste }, HitTestZone::Waste, desiredTargets);
-        if (result.Target != Pile::HitTestTarget::None)
+        auto result = HitTestPile(WasteLayoutPile, point);
+        if (isDesired(result))
         {
-            return { waste, result, HitTestZone::Waste };
+            return { m_waste, result, HitTestZone::Waste };
         }
     }
 
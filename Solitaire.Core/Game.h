@@ -1,5 +1,7 @@
 #pragma once
 #include "Pile.h"
+#include "BoardLayout.h"
+#include "LayoutSolver.h"
 
 struct LayoutInformation
 {
@@ -44,14 +46,28 @@ public:
 private:
     std::pair<std::vector<std::shared_ptr<CardStack>>, int> ConstructStacks(Pile::CardList const& cards);
     std::unique_ptr<Deck> ConstructDeck(Pile::CardList const& cards, int startAt);
+    void PrioritizeCardFaces();
     std::shared_ptr<Waste> ConstructWaste();
     std::vector<std::shared_ptr<::Foundation>> ConstructFoundations();
     winrt::fire_and_forget DisplayWinMessage();
     void SetNewLayout(LayoutInformation layoutInfo);
+    void Relayout();
+    void PositionZones();
+    void UpdateZoneRects();
+    void UpdateLayout();
+    void RefreshBoardLayout();
+    Pile::HitTestResult HitTestPile(int layoutPile, winrt::Windows::Foundation::Numerics::float2 const point);
     std::tuple<std::shared_ptr<Pile>, Pile::HitTestResult, HitTestZone> HitTestPiles(
         winrt::Windows::Foundation::Numerics::float2 const point,
         std::initializer_list<Pile::HitTestTarget> const& desiredTargets);
 
+private:
+    // Pile indices in m_boardLayout
+    static constexpr int DeckLayoutPile = 0;
+    static constexpr int WasteLayoutPile = 1;
+    static constexpr int FirstFoundationLayoutPile = 2;
+    static constexpr int FirstStackLayoutPile = 6;
+
 private:
     winrt::Windows::UI::Composition::Compositor m_compositor{ nullptr };
     winrt::Windows::UI::Composition::ContainerVisual m_root{ nullptr };
@@ -73,6 +89,9 @@ private:
 
     bool m_isDeckAnimationRunning = false;
     LayoutInformation m_layoutInfo{};
+    winrt::Windows::Foundation::Numerics::float2 m_hostSize{};
+    LayoutSolver m_layoutSolver;
+    BoardMetrics m_boardMetrics;
 
     std::shared_ptr<ShapeCache> m_shapeCache;
     std::unique_ptr<Pack> m_pack;
@@ -81,4 +100,5 @@ private:
     std::unique_ptr<Deck> m_deck;
     std::shared_ptr<Waste> m_waste;
     std::vector<std::shared_ptr<::Foundation>> m_foundations;
+    BoardLayout m_boardLayout;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "Deck.h"
 #include "Foundation.h"
 #include "GameApp.h"
+#include "StartupTrace.h"
 
 namespace winrt
 {
@@ -18,6 +19,11 @@ namespace winrt
     using namespace Windows::System;
 }
 
+// The smallest area the board is laid out for. Rather than letterboxing,
+// the content grows in whichever direction the window has room to spare
+// and the layout solver spreads the board out to fill it.
+const winrt::float2 MinimumContentSize = { 1327, 1111 };
+
 float ComputeScaleFactor(winrt::float2 const windowSize, winrt::float2 const contentSize)
 {
     auto windowRatio = windowSize.x / windowSize.y;
@@ -46,6 +52,12 @@ winrt::float4x4 ComputeContentTransform(winrt::float2 const windowSize, winrt::f
     return result;
 }
 
+winrt::float2 ComputeContentSize(winrt::float2 const windowSize, float scale)
+{
+    auto contentSize = windowSize / scale;
+    return { std::max(contentSize.x, MinimumContentSize.x), std::max(contentSize.y, MinimumContentSize.y) };
+}
+
 float ComputeRadius(winrt::float2 const windowSize)
 {
     return std::sqrt((windowSize.x * windowSize.x) + (windowSize.y * windowSize.y)) / 2.0f;
@@ -54,10 +66,12 @@ float ComputeRadius(winrt::float2 const windowSize)
 std::future<std::shared_ptr<ISolitaire>> CreateSolitaireAsync(
     winrt::ContainerVisual parentVisual, 
     winrt::float2 parentSize,
-    winrt::StorageFolder assetsFolder)
+    winrt::StorageFolder assetsFolder,
+    CardFaceRendering rendering,
+    StartupMode startupMode)
 {
     auto compositor = parentVisual.Compositor();
-    auto shapeCache = co_await ShapeCache::CreateAsync(compositor, assetsFolder);
+    auto shapeCache = co_await ShapeCache::CreateAsync(compositor, assetsFolder, rendering, startupMode);
     auto app = std::make_shared<GameApp>(shapeCache, parentVisual, parentSize);
     co_return app;
 }
@@ -67,6 +81,7 @@ GameApp::GameApp(
     winrt::ContainerVisual const& parentVisual, 
     winrt::float2 parentSize)
 {
+    StartupSpan span("GameApp");
     m_lastParentSize = parentSize;
 
     auto compositor = parentVisual.Compositor();
@@ -88,16 +103,37 @@ GameApp::GameApp(
     m_root.Children().InsertAtBottom(m_background);
 
     m_content = compositor.CreateContainerVisual();
-    m_content.Size({ 1327, 1111 });
     m_content.AnchorPoint({ 0.5f, 0.5f });
     m_content.RelativeOffsetAdjustment({ 0.5f, 0.5f, 0.0f });
-    auto scale = ComputeScaleFactor(parentSize, m_content.Size());
+    auto scale = ComputeScaleFactor(parentSize, MinimumContentSize);
+    m_content.Size(ComputeContentSize(parentSize, scale));
     m_content.Scale({ scale, scale, 1.0f });
     m_root.Children().InsertAtTop(m_content);
 
+    // Before the game starts loading faces, so they're shown at the
+    // right level of detail (or drawn at the right size) the first time
+    m_shapeCache = shapeCache;
+    m_shapeCache->SetDisplayScale(scale);
+
     auto size = m_content.Size();
     m_game = std::make_unique<Game>(compositor, size, shapeCache);
     m_content.Children().InsertAtTop(m_game->Root());
+
+    // The board goes out with the next commit, the batch for it completes
+    // once the compositor has it
+    auto commitBatch = compositor.GetCommitBatch(winrt::CompositionBatchTypes::Animation);
+    commitBatch.Completed([](auto&&, auto&&)
+        {
+            MarkFirstFrame();
+        });
+}
+
+GameApp::~GameApp()
+{
+    if (m_resizeBatch)
+    {
+        m_resizeBatch.Completed(m_resizeBatchCompleted);
+    }
 }
 
 void GameApp::OnPointerMoved(winrt::float2 point)
@@ -106,11 +142,46 @@ void GameApp::OnPointerMoved(winrt::float2 point)
     m_game->OnPointerMoved(relativePoint);
 }
 
+// Dragging the edge of the window produces a flood of size changes, far
+// more than we can show. Hold on to the latest one and apply it once the
+// compositor has taken the current frame, so there's one relayout a
+// frame for as long as the drag goes on.
 void GameApp::OnParentSizeChanged(winrt::float2 newSize)
 {
+    m_resizeEventsReceived++;
+    m_pendingParentSize = newSize;
+    if (m_resizeBatch)
+    {
+        // This frame's relayout is already on its way
+        return;
+    }
+
+    // The batch for this commit completes when the frame has gone out,
+    // which is also the soonest a new layout could be shown
+    m_resizeBatch = m_root.Compositor().GetCommitBatch(winrt::CompositionBatchTypes::Animation);
+    m_resizeBatchCompleted = m_resizeBatch.Completed([this](auto&&, auto&&)
+        {
+            m_resizeBatch = nullptr;
+            ApplyPendingResize();
+        });
+}
+
+void GameApp::ApplyPendingResize()
+{
+    auto newSize = m_pendingParentSize;
+    if (newSize == m_lastParentSize)
+    {
+        return;
+    }
+    m_relayoutsPerformed++;
+
+    // Everything that depends on the window size is updated together so
+    // that pointer input never sees a half updated board.
     m_lastParentSize = newSize;
-    auto scale = ComputeScaleFactor(newSize, m_content.Size());
+    auto scale = ComputeScaleFactor(newSize, MinimumContentSize);
+    m_content.Size(ComputeContentSize(newSize, scale));
     m_content.Scale({ scale, scale, 1.0f });
+    m_shapeCache->SetDisplayScale(scale);
     m_game->OnSizeChanged(m_content.Size());
     // Update the background
     auto diameter = ComputeRadius(newSize) * 2.0f;
@@ -183,7 +254,9 @@ void GameApp::PrintTree(winrt::float2 windowSize)
 {
     std::wstringstream stringStream;
     stringStream << L"Window Size: " << windowSize.x << L", " << windowSize.y << std::endl;
+    stringStream << L"Resize Events: " << m_resizeEventsReceived << L", Relayouts: " << m_relayoutsPerformed << std::endl;
     Debug::PrintTree(m_root, stringStream, 0);
+    m_shapeCache->PrintAccounting(stringStream);
     Debug::OutputDebugStringStream(stringStream);
 }
 
@@ -9,7 +9,7 @@ public:
         std::shared_ptr<ShapeCache> shapeCache,
         winrt::Windows::UI::Composition::ContainerVisual const& parentVisual,
         winrt::Windows::Foundation::Numerics::float2 parentSize);
-    ~GameApp() {}
+    ~GameApp();
 
     void OnPointerMoved(winrt::Windows::Foundation::Numerics::float2 point) override;
     void OnParentSizeChanged(winrt::Windows::Foundation::Numerics::float2 newSize) override;
@@ -25,7 +25,11 @@ public:
         winrt::Windows::System::VirtualKey key,
         bool isControlDown) override;
 
+    uint64_t ResizeEventsReceived() const { return m_resizeEventsReceived; }
+    uint64_t RelayoutsPerformed() const { return m_relayoutsPerformed; }
+
 private:
+    void ApplyPendingResize();
     void PrintTree(winrt::Windows::Foundation::Numerics::float2 windowSize);
     winrt::Windows::Foundation::Numerics::float2 GetPointRelativeToContent(
         winrt::Windows::Foundation::Numerics::float2 const windowSize,
@@ -35,7 +39,16 @@ private:
 private:
     winrt::Windows::Foundation::Numerics::float2 m_lastParentSize;
     std::unique_ptr<Game> m_game;
+    std::shared_ptr<ShapeCache> m_shapeCache;
     winrt::Windows::UI::Composition::ContainerVisual m_root{ nullptr };
     winrt::Windows::UI::Composition::SpriteVisual m_background{ nullptr };
     winrt::Windows::UI::Composition::ContainerVisual m_content{ nullptr };
+
+    // Resizing, the batch is set while a relayout is waiting for the
+    // current frame to go out
+    winrt::Windows::UI::Composition::CompositionCommitBatch m_resizeBatch{ nullptr };
+    winrt::event_token m_resizeBatchCompleted{};
+    winrt::Windows::Foundation::Numerics::float2 m_pendingParentSize{};
+    uint64_t m_resizeEventsReceived = 0;
+    uint64_t m_relayoutsPerformed = 0;
 };
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "GeometryBundle.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace CardGeometry;
+
+namespace
+{
+    const char Magic[4] = { 'S', 'C', 'G', 'B' };
+    const size_t ArrayAlignment = 16;
+
+    // The arrays are copied to and from disk byte for byte
+    static_assert(std::is_trivially_copyable_v<Node> && sizeof(Node) == 88, "Node layout is part of the bundle format");
+    static_assert(std::is_trivially_copyable_v<Brush> && sizeof(Brush) == 16, "Brush layout is part of the bundle format");
+    static_assert(sizeof(GradientStop) == 8 && sizeof(Point) == 8 && sizeof(SegmentType) == 1, "Array layouts are part of the bundle format");
+    static_assert(sizeof(GeometryBundle::Header) == 48, "Header layout is part of the bundle format");
+    static_assert(sizeof(GeometryBundle::Entry) == 152, "Entry layout is part of the bundle format");
+
+    size_t Align(size_t value)
+    {
+        return (value + ArrayAlignment - 1) & ~(ArrayAlignment - 1);
+    }
+
+    template <typename T>
+    GeometryBundle::ArrayRef AppendArray(std::vector<uint8_t>& output, std::vector<T> const& values)
+    {
+        output.resize(Align(output.size()), 0);
+        GeometryBundle::ArrayRef result = { output.size(), values.size() };
+        if (!values.empty())
+        {
+            auto bytes = reinterpret_cast<uint8_t const*>(values.data());
+            output.insert(output.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+        return result;
+    }
+
+    // Collects the path geometry of every document, storing each unique
+    // path once.
+    class GeometryPool
+    {
+    public:
+        std::vector<SegmentType> Segments;
+        std::vector<Point> Points;
+        size_t PathCount = 0;
+        size_t UniquePathCount = 0;
+
+        // Returns a copy of the nodes that refers to the pool instead
+        std::vector<Node> Add(Document const& document)
+        {
+            auto view = document.View();
+            auto nodes = document.Nodes;
+            for (auto& node : nodes)
+            {
+                if (node.Type != NodeType::Path)
+                {
+                    continue;
+                }
+                PathCount++;
+                auto& candidates = m_paths[HashGeometry(view, node)];
+                auto found = false;
+                for (auto& candidate : candidates)
+                {
+                    if (SameGeometry(view, node, View(), candidate))
+                    {
+                        node.FirstSegment = candidate.FirstSegment;
+                        node.FirstPoint = candidate.FirstPoint;
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found)
+                {
+                    auto pooled = node;
+                    pooled.FirstSegment = static_cast<uint32_t>(Segments.size());
+                    pooled.FirstPoint = static_cast<uint32_t>(Points.size());
+                    Segments.insert(Segments.end(), view.Segments.Data + node.FirstSegment, view.Segments.Data + node.FirstSegment + node.SegmentCount);
+                    Points.insert(Points.end(), view.Points.Data + node.FirstPoint, view.Points.Data + node.FirstPoint + node.PointCount);
+                    candidates.push_back(pooled);
+                    node.FirstSegment = pooled.FirstSegment;
+                    node.FirstPoint = pooled.FirstPoint;
+                    UniquePathCount++;
+                }
+            }
+            return nodes;
+        }
+
+    private:
+        DocumentView View() const
+        {
+            DocumentView view;
+            view.Segments = { Segments.data(), Segments.size() };
+            view.Points = { Points.data(), Points.size() };
+            return view;
+        }
+
+    private:
+        std::unordered_map<uint64_t, std::vector<Node>> m_paths;
+    };
+
+    template <typename T>
+    bool CheckArray(GeometryBundle::ArrayRef const& array, size_t size)
+    {
+        return array.Offset % alignof(T) == 0 &&
+            array.Offset <= size &&
+            array.Count <= (size - array.Offset) / sizeof(T);
+    }
+
+    template <typename T>
+    Span<T> GetArray(uint8_t const* data, GeometryBundle::ArrayRef const& array)
+    {
+        return { reinterpret_cast<T const*>(data + array.Offset), static_cast<size_t>(array.Count) };
+    }
+}
+
+namespace GeometryBundle
+{
+    void Writer::Add(std::string const& name, Document const& document)
+    {
+        m_documents.emplace_back(name, document);
+    }
+
+    std::vector<uint8_t> Writer::Serialize(uint64_t sourceHash)
+    {
+        // Sorted so that the same inputs always produce the same bytes
+        std::vector<std::pair<std::string, Document> const*> documents;
+        for (auto& document : m_documents)
+        {
+            documents.push_back(&document);
+        }
+        std::sort(documents.begin(), documents.end(), [](auto left, auto right)
+            {
+                return left->first < right->first;
+            });
+
+        GeometryPool pool;
+        std::vector<std::vector<Node>> nodes;
+        for (auto document : documents)
+        {
+            nodes.push_back(pool.Add(document->second));
+        }
+        m_pathCount = pool.PathCount;
+        m_uniquePathCount = pool.UniquePathCount;
+
+        std::vector<uint8_t> output(sizeof(Header) + documents.size() * sizeof(Entry), 0);
+        auto segments = AppendArray(output, pool.Segments);
+        auto points = AppendArray(output, pool.Points);
+        std::vector<Entry> entries;
+        for (auto i = 0u; i < documents.size(); i++)
+        {
+            auto& [name, geometry] = *documents[i];
+            Entry entry = {};
+            memcpy(entry.Name, name.c_str(), std::min(name.size(), MaxNameLength));
+            entry.Flags = geometry.Flags;
+            entry.ViewBox = geometry.ViewBox;
+            entry.Nodes = AppendArray(output, nodes[i]);
+            entry.Segments = segments;
+            entry.Points = points;
+            entry.Brushes = AppendArray(output, geometry.Brushes);
+            entry.Stops = AppendArray(output, geometry.Stops);
+            entries.push_back(entry);
+        }
+        if (!entries.empty())
+        {
+            memcpy(output.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+        }
+
+        Header header = {};
+        memcpy(header.Magic, Magic, sizeof(Magic));
+        header.Version = FormatVersion;
+        header.HeaderSize = sizeof(Header);
+        header.EntryCount = static_cast<uint32_t>(entries.size());
+        header.EntryTableOffset = sizeof(Header);
+        header.FileSize = output.size();
+        header.SourceHash = sourceHash;
+        header.ContentHash = HashBytes(output.data() + sizeof(Header), output.size() - sizeof(Header));
+        memcpy(output.data(), &header, sizeof(header));
+        return output;
+    }
+
+    bool Reader::Open(uint8_t const* data, size_t size, std::string& error)
+    {
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_entries = nullptr;
+
+        if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0)
+        {
+            error = "Too small to be a bundle";
+            return false;
+        }
+        auto header = reinterpret_cast<Header const*>(data);
+        if (memcmp(header->Magic, Magic, sizeof(Magic)) != 0)
+        {
+            error = "Not a geometry bundle";
+            return false;
+        }
+        if (header->Version != FormatVersion || header->HeaderSize != sizeof(Header))
+        {
+            error = "Unsupported bundle version " + std::to_string(header->Version) +
+                " (expected " + std::to_string(FormatVersion) + ")";
+            return false;
+        }
+        if (header->FileSize != size)
+        {
+            error = "Bundle is truncated";
+            return false;
+        }
+        if (header->EntryTableOffset % alignof(Entry) != 0 ||
+            header->EntryTableOffset > size ||
+            header->EntryCount > (size - header->EntryTableOffset) / sizeof(Entry))
+        {
+            error = "Entry table is out of bounds";
+            return false;
+        }
+
+        m_data = data;
+        m_size = size;
+        m_header = header;
+        m_entries = reinterpret_cast<Entry const*>(data + header->EntryTableOffset);
+        for (auto i = 0u; i < header->EntryCount; i++)
+        {
+            auto& entry = m_entries[i];
+            auto valid = memchr(entry.Name, 0, sizeof(entry.Name)) != nullptr &&
+                CheckArray<Node>(entry.Nodes, size) &&
+                CheckArray<SegmentType>(entry.Segments, size) &&
+                CheckArray<Point>(entry.Points, size) &&
+                CheckArray<Brush>(entry.Brushes, size) &&
+                CheckArray<GradientStop>(entry.Stops, size) &&
+                Validate(GetDocument(i));
+            if (!valid)
+            {
+                error = "Entry " + std::to_string(i) + " is invalid";
+                m_header = nullptr;
+                m_entries = nullptr;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Reader::VerifyContentHash() const
+    {
+        return m_header != nullptr &&
+            HashBytes(m_data + m_header->HeaderSize, m_size - m_header->HeaderSize) == m_header->ContentHash;
+    }
+
+    DocumentView Reader::GetDocument(uint32_t index) const
+    {
+        auto& entry = m_entries[index];
+        DocumentView document;
+        document.Flags = entry.Flags;
+        document.ViewBox = entry.ViewBox;
+        document.Nodes = GetArray<Node>(m_data, entry.Nodes);
+        document.Segments = GetArray<SegmentType>(m_data, entry.Segments);
+        document.Points = GetArray<Point>(m_data, entry.Points);
+        document.Brushes = GetArray<Brush>(m_data, entry.Brushes);
+        document.Stops = GetArray<GradientStop>(m_data, entry.Stops);
+        return document;
+    }
+
+    bool Reader::TryFind(char const* name, DocumentView& document) const
+    {
+        for (auto i = 0u; i < EntryCount(); i++)
+        {
+            if (strcmp(m_entries[i].Name, name) == 0)
+            {
+                document = GetDocument(i);
+                return true;
+            }
+        }
+        return false;
+    }
+}
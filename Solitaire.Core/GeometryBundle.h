@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// A bundle holds precompiled CardGeometry documents keyed by name (the
+// card face file name without the extension, "back" and "empty"). The
+// arrays of each document are stored exactly as they are in memory, so a
+// mapped bundle can be used in place. Everything is little-endian.
+//
+//     Header
+//     Entry[EntryCount]        (at EntryTableOffset)
+//     arrays, 16 byte aligned  (referenced by the entries)
+//
+// Path geometry repeats a lot between cards (every pip of a suit is the
+// same path), so all of the entries share one segment array and one point
+// array, and each unique path is only stored once. Everything else is per
+// entry.
+//
+// ContentHash covers everything after the header. SourceHash is whatever
+// the compiler was given to identify its inputs, the tool uses a hash of
+// the SVG files so that it can tell when a bundle is stale.
+namespace GeometryBundle
+{
+    const uint32_t FormatVersion = 2;
+    const size_t MaxNameLength = 47;
+    char const* const CardBackName = "back";
+    char const* const EmptyPileName = "empty";
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t HeaderSize;
+        uint32_t EntryCount;
+        uint64_t EntryTableOffset;
+        uint64_t FileSize;
+        uint64_t SourceHash;
+        uint64_t ContentHash;
+    };
+
+    struct ArrayRef
+    {
+        uint64_t Offset;
+        uint64_t Count;
+    };
+
+    struct Entry
+    {
+        char Name[MaxNameLength + 1];
+        uint32_t Flags;
+        CardGeometry::ViewBox ViewBox;
+        uint32_t Reserved;
+        ArrayRef Nodes;
+        ArrayRef Segments;
+        ArrayRef Points;
+        ArrayRef Brushes;
+        ArrayRef Stops;
+    };
+
+    class Writer
+    {
+    public:
+        void Add(std::string const& name, CardGeometry::Document const& document);
+        std::vector<uint8_t> Serialize(uint64_t sourceHash);
+
+        // Paths written by the last call to Serialize, and how many of
+        // them were stored
+        size_t PathCount() const { return m_pathCount; }
+        size_t UniquePathCount() const { return m_uniquePathCount; }
+
+    private:
+        std::vector<std::pair<std::string, CardGeometry::Document>> m_documents;
+        size_t m_pathCount = 0;
+        size_t m_uniquePathCount = 0;
+    };
+
+    // Reads a bundle in place. The memory has to outlive the reader and
+    // any views it hands out.
+    class Reader
+    {
+    public:
+        // Checks the header and that every document is in bounds and
+        // valid. The content hash is only checked by VerifyContentHash.
+        bool Open(uint8_t const* data, size_t size, std::string& error);
+        bool VerifyContentHash() const;
+
+        Header const& GetHeader() const { return *m_header; }
+        uint32_t EntryCount() const { return m_header->EntryCount; }
+        Entry const& GetEntry(uint32_t index) const { return m_entries[index]; }
+        CardGeometry::DocumentView GetDocument(uint32_t index) const;
+        // Returns false if there isn't a document with that name
+        bool TryFind(char const* name, CardGeometry::DocumentView& document) const;
+
+    private:
+        uint8_t const* m_data = nullptr;
+        size_t m_size = 0;
+        Header const* m_header = nullptr;
+        Entry const* m_entries = nullptr;
+    };
+}
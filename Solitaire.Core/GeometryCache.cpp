@@ -0,0 +1,69 @@
+#include "GeometryCache.h"
+#include <cstdio>
+#include "GeometryBundle.h"
+
+using namespace CardGeometry;
+
+namespace
+{
+    char const* const EntryName = "face";
+}
+
+namespace GeometryCache
+{
+    uint64_t EntryKey(void const* svg, size_t size, GeometrySimplifier::Options const& options)
+    {
+        // The bundle format version is in there too, an entry that the
+        // reader would reject is as good as missing
+        uint32_t const versions[] = { ConverterVersion, GeometryBundle::FormatVersion };
+        float const settings[] = { options.TargetWidth, options.TargetHeight, options.Tolerance };
+        auto hash = HashBytes(versions, sizeof(versions));
+        hash = HashBytes(settings, sizeof(settings), hash);
+        return HashBytes(svg, size, hash);
+    }
+
+    std::string EntryFileName(uint64_t key)
+    {
+        char name[32] = {};
+        snprintf(name, sizeof(name), "%016llx.geom", static_cast<unsigned long long>(key));
+        return name;
+    }
+
+    std::vector<uint8_t> SerializeEntry(uint64_t key, Document const& document)
+    {
+        GeometryBundle::Writer writer;
+        writer.Add(EntryName, document);
+        return writer.Serialize(key);
+    }
+
+    bool TryReadEntry(
+        uint8_t const* data,
+        size_t size,
+        uint64_t key,
+        DocumentView& document,
+        std::string& error)
+    {
+        GeometryBundle::Reader reader;
+        if (!reader.Open(data, size, error))
+        {
+            return false;
+        }
+        // Same check ShapeCache makes on the bundle
+        if (!reader.VerifyContentHash())
+        {
+            error = "Content hash mismatch";
+            return false;
+        }
+        if (reader.GetHeader().SourceHash != key)
+        {
+            error = "Entry is for a different key";
+            return false;
+        }
+        if (!reader.TryFind(EntryName, document))
+        {
+            error = "Entry has no document";
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CardGeometry.h"
+#include "GeometrySimplifier.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Converted card faces cached on disk, one file per face. Entries are
+// named after a key that covers everything that goes into the result:
+// the bytes of the SVG, ConverterVersion and the simplifier options. A
+// changed input gets a different file instead of a stale one.
+//
+// Each entry is a GeometryBundle holding a single document, with the key
+// as its source hash, so reading one validates it the same way.
+namespace GeometryCache
+{
+    // Bump whenever the converter, the simplifier or the flattener change
+    // what they produce for the same input
+    const uint32_t ConverterVersion = 1;
+
+    uint64_t EntryKey(void const* svg, size_t size, GeometrySimplifier::Options const& options);
+    // The key in hex plus an extension
+    std::string EntryFileName(uint64_t key);
+
+    std::vector<uint8_t> SerializeEntry(uint64_t key, CardGeometry::Document const& document);
+    // The view points into data. Fails if the entry is corrupt, from a
+    // different bundle format or for a different key.
+    bool TryReadEntry(
+        uint8_t const* data,
+        size_t size,
+        uint64_t key,
+        CardGeometry::DocumentView& document,
+        std::string& error);
+}
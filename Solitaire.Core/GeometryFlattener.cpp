@@ -0,0 +1,110 @@
+#include "GeometryFlattener.h"
+#include <algorithm>
+#include <vector>
+
+using namespace CardGeometry;
+
+namespace
+{
+    Matrix TransformOf(Node const& node)
+    {
+        return (node.Flags & NodeHasTransform) != 0 ? node.Transform : Matrix::Identity();
+    }
+}
+
+namespace GeometryFlattener
+{
+    size_t Depth(DocumentView const& document)
+    {
+        size_t result = 0;
+        std::vector<size_t> depths(document.Nodes.Size, 0);
+        for (auto i = 1u; i < document.Nodes.Size; i++)
+        {
+            depths[i] = depths[document.Nodes[i].Parent] + 1;
+            result = std::max(result, depths[i]);
+        }
+        return result;
+    }
+
+    Document Flatten(DocumentView const& document, Stats& stats)
+    {
+        stats = {};
+        stats.NodesBefore = document.Nodes.Size;
+        stats.DepthBefore = Depth(document);
+
+        Document result;
+        result.Flags = document.Flags;
+        result.ViewBox = document.ViewBox;
+        result.Segments.assign(document.Segments.begin(), document.Segments.end());
+        result.Points.assign(document.Points.begin(), document.Points.end());
+        result.Brushes.assign(document.Brushes.begin(), document.Brushes.end());
+        result.Stops.assign(document.Stops.begin(), document.Stops.end());
+        if (document.Nodes.empty())
+        {
+            return result;
+        }
+
+        // Walking backwards finishes every subtree before its parent, so
+        // this counts the children that draw anything.
+        std::vector<bool> drawn(document.Nodes.Size, false);
+        std::vector<uint32_t> drawnChildren(document.Nodes.Size, 0);
+        for (auto i = document.Nodes.Size; i-- > 1;)
+        {
+            auto& node = document.Nodes[i];
+            drawn[i] = drawn[i] || node.Type != NodeType::Container;
+            if (drawn[i])
+            {
+                drawn[node.Parent] = true;
+                drawnChildren[node.Parent]++;
+            }
+        }
+
+        // What a removed container leaves for its children to apply
+        // after their own transform, and who they end up attached to.
+        // Hoisting a single child means its own children (if it gets
+        // removed too) inherit the combined transform.
+        std::vector<Matrix> inherited(document.Nodes.Size, Matrix::Identity());
+        std::vector<int32_t> newIndices(document.Nodes.Size, NoParent);
+        result.Nodes.push_back(document.Nodes[0]);
+        newIndices[0] = 0;
+        for (auto i = 1u; i < document.Nodes.Size; i++)
+        {
+            if (!drawn[i])
+            {
+                if (document.Nodes[i].Type == NodeType::Container)
+                {
+                    stats.ContainersRemoved++;
+                }
+                continue;
+            }
+
+            // A removed parent's index is where it would have attached
+            auto node = document.Nodes[i];
+            auto transform = Multiply(TransformOf(node), inherited[node.Parent]);
+            auto attachTo = newIndices[node.Parent];
+
+            if (node.Type == NodeType::Container &&
+                (transform.IsIdentity() || drawnChildren[i] == 1))
+            {
+                if (!transform.IsIdentity())
+                {
+                    stats.TransformsFolded++;
+                }
+                inherited[i] = transform;
+                newIndices[i] = attachTo;
+                stats.ContainersRemoved++;
+                continue;
+            }
+
+            node.Parent = attachTo;
+            node.Transform = transform;
+            node.Flags = transform.IsIdentity() ? (node.Flags & ~NodeHasTransform) : (node.Flags | NodeHasTransform);
+            newIndices[i] = static_cast<int32_t>(result.Nodes.size());
+            result.Nodes.push_back(node);
+        }
+
+        stats.NodesAfter = result.Nodes.size();
+        stats.DepthAfter = Depth(result.View());
+        return result;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Every SVG element becomes a container, so converted documents are full
+// of groups that don't do anything. This removes the containers the
+// compositor doesn't need without changing what gets drawn:
+//
+//   - Containers without a transform hand their children to their parent.
+//   - Containers with a single child (after the above) fold their
+//     transform into that child, so chains of transforms become one.
+//   - Containers that don't end up holding any sprites are dropped.
+//
+// Presentation is already baked into the sprites, so transforms are the
+// only thing containers carry. The root is always kept and the drawing
+// order doesn't change.
+namespace GeometryFlattener
+{
+    struct Stats
+    {
+        size_t NodesBefore = 0;
+        size_t NodesAfter = 0;
+        // The root is at depth 0
+        size_t DepthBefore = 0;
+        size_t DepthAfter = 0;
+        size_t ContainersRemoved = 0;
+        size_t TransformsFolded = 0;
+    };
+
+    size_t Depth(CardGeometry::DocumentView const& document);
+    CardGeometry::Document Flatten(CardGeometry::DocumentView const& document, Stats& stats);
+}
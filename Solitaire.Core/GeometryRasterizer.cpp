@@ -0,0 +1,721 @@
+#include "GeometryRasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace CardGeometry;
+
+namespace
+{
+    // Sub-scanlines per row of pixels
+    const int VerticalSamples = 4;
+    // How far a flattened curve may be from the real one, in pixels
+    const float FlattenTolerance = 0.25f;
+    // Control point distance for a quarter of a unit circle
+    const float Kappa = 0.5522847f;
+    // Stroke joins smaller than this many degrees aren't worth a polygon
+    const float MinimumJoinAngle = 10.0f;
+
+    enum class FillRule
+    {
+        EvenOdd,
+        NonZero,
+    };
+
+    struct Contour
+    {
+        std::vector<Point> Points;
+        bool Closed = false;
+    };
+
+    struct Bounds
+    {
+        float Left = INFINITY;
+        float Top = INFINITY;
+        float Right = -INFINITY;
+        float Bottom = -INFINITY;
+
+        void Add(Point point)
+        {
+            Left = std::min(Left, point.X);
+            Top = std::min(Top, point.Y);
+            Right = std::max(Right, point.X);
+            Bottom = std::max(Bottom, point.Y);
+        }
+    };
+
+    struct PixelRect
+    {
+        int Left;
+        int Top;
+        int Right;
+        int Bottom;
+    };
+
+    Matrix TransformOf(Node const& node)
+    {
+        return (node.Flags & NodeHasTransform) != 0 ? node.Transform : Matrix::Identity();
+    }
+
+    // How much the transform scales lengths, on average
+    float ScaleOf(Matrix const& transform)
+    {
+        return std::sqrt(std::abs(transform.M11 * transform.M22 - transform.M12 * transform.M21));
+    }
+
+    // Flattens a node's geometry. Points are kept in the node's own space
+    // (gradients need the bounds there) and transformed afterwards.
+    class OutlineBuilder
+    {
+    public:
+        OutlineBuilder(float tolerance) : m_tolerance(tolerance) {}
+
+        void MoveTo(Point point)
+        {
+            Finish(false);
+            m_current.Points.push_back(point);
+        }
+
+        void LineTo(Point point)
+        {
+            if (m_current.Points.empty())
+            {
+                m_current.Points.push_back(m_last);
+            }
+            m_current.Points.push_back(point);
+        }
+
+        void CubicTo(Point control1, Point control2, Point end)
+        {
+            if (m_current.Points.empty())
+            {
+                m_current.Points.push_back(m_last);
+            }
+            auto start = m_current.Points.back();
+
+            // The second differences bound how far the chords stray
+            auto dx = std::max(std::abs(start.X - 2 * control1.X + control2.X), std::abs(control1.X - 2 * control2.X + end.X));
+            auto dy = std::max(std::abs(start.Y - 2 * control1.Y + control2.Y), std::abs(control1.Y - 2 * control2.Y + end.Y));
+            auto distance = std::sqrt(dx * dx + dy * dy);
+            auto steps = static_cast<int>(std::ceil(std::sqrt(0.75f * distance / m_tolerance)));
+            steps = std::clamp(steps, 1, 256);
+            for (auto i = 1; i <= steps; i++)
+            {
+                auto t = static_cast<float>(i) / steps;
+                auto u = 1.0f - t;
+                auto a = u * u * u;
+                auto b = 3 * u * u * t;
+                auto c = 3 * u * t * t;
+                auto d = t * t * t;
+                m_current.Points.push_back(
+                    {
+                        a * start.X + b * control1.X + c * control2.X + d * end.X,
+                        a * start.Y + b * control1.Y + c * control2.Y + d * end.Y,
+                    });
+            }
+        }
+
+        void Close()
+        {
+            Finish(true);
+        }
+
+        std::vector<Contour> Build()
+        {
+            Finish(false);
+            return std::move(m_contours);
+        }
+
+    private:
+        void Finish(bool closed)
+        {
+            if (!m_current.Points.empty())
+            {
+                m_last = m_current.Points.front();
+                m_current.Closed = closed;
+                m_contours.push_back(std::move(m_current));
+                m_current = {};
+            }
+        }
+
+    private:
+        float m_tolerance;
+        Contour m_current;
+        // Where a segment without a move starts, after a close that's
+        // the start of the figure that was closed
+        Point m_last = { 0, 0 };
+        std::vector<Contour> m_contours;
+    };
+
+    std::vector<Contour> BuildOutline(DocumentView const& document, Node const& node, float tolerance)
+    {
+        OutlineBuilder outline(tolerance);
+        auto& params = node.Params;
+        switch (node.Type)
+        {
+        case NodeType::Path:
+        {
+            auto point = document.Points.Data + node.FirstPoint;
+            for (auto i = 0u; i < node.SegmentCount; i++)
+            {
+                switch (document.Segments[node.FirstSegment + i])
+                {
+                case SegmentType::MoveTo:
+                    outline.MoveTo(point[0]);
+                    point += 1;
+                    break;
+                case SegmentType::LineTo:
+                    outline.LineTo(point[0]);
+                    point += 1;
+                    break;
+                case SegmentType::CubicTo:
+                    outline.CubicTo(point[0], point[1], point[2]);
+                    point += 3;
+                    break;
+                case SegmentType::Close:
+                    outline.Close();
+                    break;
+                }
+            }
+            break;
+        }
+        case NodeType::Rectangle:
+        case NodeType::RoundedRectangle:
+        {
+            auto x = params[0];
+            auto y = params[1];
+            auto width = params[2];
+            auto height = params[3];
+            auto rx = node.Type == NodeType::RoundedRectangle ? std::min(params[4], width / 2.0f) : 0.0f;
+            auto ry = node.Type == NodeType::RoundedRectangle ? std::min(params[5], height / 2.0f) : 0.0f;
+            if (rx <= 0 || ry <= 0)
+            {
+                outline.MoveTo({ x, y });
+                outline.LineTo({ x + width, y });
+                outline.LineTo({ x + width, y + height });
+                outline.LineTo({ x, y + height });
+                outline.Close();
+                break;
+            }
+            auto kx = rx * Kappa;
+            auto ky = ry * Kappa;
+            auto right = x + width;
+            auto bottom = y + height;
+            outline.MoveTo({ x + rx, y });
+            outline.LineTo({ right - rx, y });
+            outline.CubicTo({ right - rx + kx, y }, { right, y + ry - ky }, { right, y + ry });
+            outline.LineTo({ right, bottom - ry });
+            outline.CubicTo({ right, bottom - ry + ky }, { right - rx + kx, bottom }, { right - rx, bottom });
+            outline.LineTo({ x + rx, bottom });
+            outline.CubicTo({ x + rx - kx, bottom }, { x, bottom - ry + ky }, { x, bottom - ry });
+            outline.LineTo({ x, y + ry });
+            outline.CubicTo({ x, y + ry - ky }, { x + rx - kx, y }, { x + rx, y });
+            outline.Close();
+            break;
+        }
+        case NodeType::Ellipse:
+        {
+            auto cx = params[0];
+            auto cy = params[1];
+            auto rx = params[2];
+            auto ry = params[3];
+            auto kx = rx * Kappa;
+            auto ky = ry * Kappa;
+            outline.MoveTo({ cx + rx, cy });
+            outline.CubicTo({ cx + rx, cy + ky }, { cx + kx, cy + ry }, { cx, cy + ry });
+            outline.CubicTo({ cx - kx, cy + ry }, { cx - rx, cy + ky }, { cx - rx, cy });
+            outline.CubicTo({ cx - rx, cy - ky }, { cx - kx, cy - ry }, { cx, cy - ry });
+            outline.CubicTo({ cx + kx, cy - ry }, { cx + rx, cy - ky }, { cx + rx, cy });
+            outline.Close();
+            break;
+        }
+        case NodeType::Container:
+            break;
+        }
+        return outline.Build();
+    }
+
+    struct Edge
+    {
+        float X0;
+        float Y0;
+        float X1;
+        float Y1;
+        int Direction;
+    };
+
+    // How much of each pixel in a rect the polygons cover, from 0 to 1
+    class CoverageMask
+    {
+    public:
+        PixelRect Rect = {};
+        std::vector<float> Coverage;
+
+        void Clear()
+        {
+            m_edges.clear();
+            m_bounds = {};
+        }
+
+        // Implicitly closed
+        void AddPolygon(Point const* points, size_t count)
+        {
+            for (auto i = 0u; i < count; i++)
+            {
+                auto& a = points[i];
+                auto& b = points[(i + 1) % count];
+                m_bounds.Add(a);
+                if (a.Y == b.Y)
+                {
+                    continue;
+                }
+                if (a.Y < b.Y)
+                {
+                    m_edges.push_back({ a.X, a.Y, b.X, b.Y, 1 });
+                }
+                else
+                {
+                    m_edges.push_back({ b.X, b.Y, a.X, a.Y, -1 });
+                }
+            }
+        }
+
+        // Fills in the coverage of everything added since the last Clear
+        bool Rasterize(FillRule rule, PixelRect const& clip)
+        {
+            if (m_edges.empty())
+            {
+                return false;
+            }
+            auto& bounds = m_bounds;
+
+            Rect.Left = std::max(clip.Left, static_cast<int>(std::floor(bounds.Left)));
+            Rect.Top = std::max(clip.Top, static_cast<int>(std::floor(bounds.Top)));
+            Rect.Right = std::min(clip.Right, static_cast<int>(std::ceil(bounds.Right)) + 1);
+            Rect.Bottom = std::min(clip.Bottom, static_cast<int>(std::ceil(bounds.Bottom)) + 1);
+            if (Rect.Left >= Rect.Right || Rect.Top >= Rect.Bottom)
+            {
+                return false;
+            }
+            auto width = Rect.Right - Rect.Left;
+            Coverage.assign(static_cast<size_t>(width) * (Rect.Bottom - Rect.Top), 0.0f);
+
+            // Edges become active in order of their top
+            std::sort(m_edges.begin(), m_edges.end(), [](Edge const& left, Edge const& right)
+                {
+                    return left.Y0 < right.Y0;
+                });
+            m_active.clear();
+            auto nextEdge = 0u;
+            auto weight = 1.0f / VerticalSamples;
+            for (auto y = Rect.Top; y < Rect.Bottom; y++)
+            {
+                auto row = Coverage.data() + static_cast<size_t>(y - Rect.Top) * width;
+                for (auto sample = 0; sample < VerticalSamples; sample++)
+                {
+                    auto sampleY = y + (sample + 0.5f) / VerticalSamples;
+                    while (nextEdge < m_edges.size() && m_edges[nextEdge].Y0 <= sampleY)
+                    {
+                        m_active.push_back({ &m_edges[nextEdge++], 0 });
+                    }
+                    m_active.erase(std::remove_if(m_active.begin(), m_active.end(), [sampleY](ActiveEdge const& active)
+                        {
+                            return active.Source->Y1 <= sampleY;
+                        }), m_active.end());
+
+                    for (auto& active : m_active)
+                    {
+                        auto edge = active.Source;
+                        auto t = (sampleY - edge->Y0) / (edge->Y1 - edge->Y0);
+                        active.X = edge->X0 + t * (edge->X1 - edge->X0);
+                    }
+                    // The order barely changes from one sample to the next,
+                    // so an insertion sort is close to a single pass
+                    for (auto i = 1u; i < m_active.size(); i++)
+                    {
+                        auto active = m_active[i];
+                        auto j = i;
+                        for (; j > 0 && m_active[j - 1].X > active.X; j--)
+                        {
+                            m_active[j] = m_active[j - 1];
+                        }
+                        m_active[j] = active;
+                    }
+
+                    auto winding = 0;
+                    auto spanStart = 0.0f;
+                    for (auto& [edge, x] : m_active)
+                    {
+                        auto wasInside = IsInside(winding, rule);
+                        winding += edge->Direction;
+                        auto isInside = IsInside(winding, rule);
+                        if (!wasInside && isInside)
+                        {
+                            spanStart = x;
+                        }
+                        else if (wasInside && !isInside)
+                        {
+                            AddSpan(row, spanStart, x, weight);
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        static bool IsInside(int winding, FillRule rule)
+        {
+            return rule == FillRule::NonZero ? winding != 0 : (winding & 1) != 0;
+        }
+
+        void AddSpan(float* row, float start, float end, float weight)
+        {
+            start = std::max(start, static_cast<float>(Rect.Left)) - Rect.Left;
+            end = std::min(end, static_cast<float>(Rect.Right)) - Rect.Left;
+            if (end <= start)
+            {
+                return;
+            }
+            auto first = static_cast<int>(start);
+            auto last = static_cast<int>(end);
+            if (first == last)
+            {
+                row[first] += (end - start) * weight;
+                return;
+            }
+            row[first] += (first + 1 - start) * weight;
+            for (auto x = first + 1; x < last; x++)
+            {
+                row[x] += weight;
+            }
+            if (last < Rect.Right - Rect.Left)
+            {
+                row[last] += (end - last) * weight;
+            }
+        }
+
+    private:
+        struct ActiveEdge
+        {
+            Edge const* Source;
+            // Where it crosses the current sample
+            float X;
+        };
+
+        std::vector<Edge> m_edges;
+        Bounds m_bounds;
+        std::vector<ActiveEdge> m_active;
+    };
+
+    // The stroke as a quad per segment and a round join wherever the
+    // outline turns. Every piece winds the same way, so filling them
+    // non-zero gives their union.
+    void AddStroke(CoverageMask& mask, std::vector<Contour> const& contours, float halfWidth)
+    {
+        auto joinSides = std::clamp(static_cast<int>(std::ceil(halfWidth * 4)), 6, 32);
+        auto minimumJoinCos = std::cos(MinimumJoinAngle * 3.14159265f / 180.0f);
+        Point join[32];
+        for (auto& contour : contours)
+        {
+            auto& points = contour.Points;
+            auto count = points.size();
+            auto segments = contour.Closed ? count : count - 1;
+            for (auto i = 0u; i < segments && count > 1; i++)
+            {
+                auto& a = points[i];
+                auto& b = points[(i + 1) % count];
+                auto dx = b.X - a.X;
+                auto dy = b.Y - a.Y;
+                auto length = std::sqrt(dx * dx + dy * dy);
+                if (length == 0)
+                {
+                    continue;
+                }
+                // The offset is the direction turned a quarter, so every
+                // quad winds the same way
+                auto nx = -dy / length * halfWidth;
+                auto ny = dx / length * halfWidth;
+                Point const quad[] = { { a.X + nx, a.Y + ny }, { b.X + nx, b.Y + ny }, { b.X - nx, b.Y - ny }, { a.X - nx, a.Y - ny } };
+                mask.AddPolygon(quad, 4);
+            }
+
+            for (auto i = 0u; i < count; i++)
+            {
+                if (!contour.Closed && (i == 0 || i == count - 1))
+                {
+                    continue;
+                }
+                auto& previous = points[(i + count - 1) % count];
+                auto& point = points[i];
+                auto& next = points[(i + 1) % count];
+                auto ax = point.X - previous.X;
+                auto ay = point.Y - previous.Y;
+                auto bx = next.X - point.X;
+                auto by = next.Y - point.Y;
+                auto lengths = std::sqrt((ax * ax + ay * ay) * (bx * bx + by * by));
+                if (lengths == 0 || (ax * bx + ay * by) / lengths > minimumJoinCos)
+                {
+                    continue;
+                }
+                // Counterclockwise on screen, same as the quads
+                for (auto side = 0; side < joinSides; side++)
+                {
+                    auto angle = -2.0f * 3.14159265f * side / joinSides;
+                    join[side] = { point.X + std::cos(angle) * halfWidth, point.Y + std::sin(angle) * halfWidth };
+                }
+                mask.AddPolygon(join, joinSides);
+            }
+        }
+    }
+
+    // Straight (not premultiplied) color, 0 to 1
+    struct ColorF
+    {
+        float R;
+        float G;
+        float B;
+        float A;
+    };
+
+    ColorF ToColorF(Color color)
+    {
+        return { color.R / 255.0f, color.G / 255.0f, color.B / 255.0f, color.A / 255.0f };
+    }
+
+    // Evaluates a brush at any pixel of one sprite
+    class BrushSampler
+    {
+    public:
+        BrushSampler(DocumentView const& document, int32_t brushIndex, Matrix const& transform, Bounds const& localBounds)
+        {
+            auto& brush = document.Brushes[brushIndex];
+            m_isGradient = brush.Type == BrushType::LinearGradient;
+            m_color = ToColorF(brush.Color);
+            if (!m_isGradient)
+            {
+                return;
+            }
+            for (auto i = 0u; i < brush.StopCount; i++)
+            {
+                auto& stop = document.Stops[brush.FirstStop + i];
+                m_stops.push_back({ stop.Offset, ToColorF(stop.Color) });
+            }
+            std::stable_sort(m_stops.begin(), m_stops.end(), [](auto const& left, auto const& right)
+                {
+                    return left.first < right.first;
+                });
+            m_transform = transform;
+            m_determinant = transform.M11 * transform.M22 - transform.M12 * transform.M21;
+            m_left = localBounds.Left;
+            m_width = localBounds.Right - localBounds.Left;
+        }
+
+        bool IsSolid() const { return !m_isGradient; }
+
+        ColorF Sample(float x, float y) const
+        {
+            if (!m_isGradient)
+            {
+                return m_color;
+            }
+            if (m_stops.empty() || m_determinant == 0 || m_width <= 0)
+            {
+                return m_stops.empty() ? ColorF{ 0, 0, 0, 0 } : m_stops.front().second;
+            }
+
+            // Only the x of the sprite's own space matters
+            auto dx = x - m_transform.M31;
+            auto dy = y - m_transform.M32;
+            auto localX = (dx * m_transform.M22 - dy * m_transform.M21) / m_determinant;
+            auto t = std::clamp((localX - m_left) / m_width, 0.0f, 1.0f);
+            if (t <= m_stops.front().first)
+            {
+                return m_stops.front().second;
+            }
+            for (auto i = 1u; i < m_stops.size(); i++)
+            {
+                auto& [offset, color] = m_stops[i];
+                if (t <= offset)
+                {
+                    auto& [previousOffset, previousColor] = m_stops[i - 1];
+                    auto span = offset - previousOffset;
+                    auto f = span > 0 ? (t - previousOffset) / span : 1.0f;
+                    return
+                    {
+                        previousColor.R + (color.R - previousColor.R) * f,
+                        previousColor.G + (color.G - previousColor.G) * f,
+                        previousColor.B + (color.B - previousColor.B) * f,
+                        previousColor.A + (color.A - previousColor.A) * f,
+                    };
+                }
+            }
+            return m_stops.back().second;
+        }
+
+    private:
+        bool m_isGradient = false;
+        ColorF m_color = {};
+        std::vector<std::pair<float, ColorF>> m_stops;
+        Matrix m_transform = Matrix::Identity();
+        float m_determinant = 1;
+        float m_left = 0;
+        float m_width = 0;
+    };
+
+    uint8_t ToByte(float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Source over, in premultiplied alpha
+    void Composite(GeometryRasterizer::Bitmap& bitmap, CoverageMask const& mask, BrushSampler const& brush)
+    {
+        auto width = mask.Rect.Right - mask.Rect.Left;
+        auto solid = brush.IsSolid();
+        auto color = brush.Sample(0, 0);
+        for (auto y = mask.Rect.Top; y < mask.Rect.Bottom; y++)
+        {
+            auto coverage = mask.Coverage.data() + static_cast<size_t>(y - mask.Rect.Top) * width;
+            auto pixel = bitmap.Row(y) + static_cast<size_t>(mask.Rect.Left) * 4;
+            for (auto x = 0; x < width; x++, pixel += 4)
+            {
+                auto amount = std::min(coverage[x], 1.0f);
+                if (amount <= 0)
+                {
+                    continue;
+                }
+                if (!solid)
+                {
+                    color = brush.Sample(mask.Rect.Left + x + 0.5f, y + 0.5f);
+                }
+                auto alpha = color.A * amount;
+                auto remaining = 1.0f - alpha;
+                pixel[0] = ToByte(color.R * alpha + pixel[0] / 255.0f * remaining);
+                pixel[1] = ToByte(color.G * alpha + pixel[1] / 255.0f * remaining);
+                pixel[2] = ToByte(color.B * alpha + pixel[2] / 255.0f * remaining);
+                pixel[3] = ToByte(alpha + pixel[3] / 255.0f * remaining);
+            }
+        }
+    }
+
+    // Maps the view box into the card, same as a CompositionViewBox with
+    // uniform stretch and centered alignment
+    Matrix ViewBoxTransform(DocumentView const& document, float width, float height)
+    {
+        auto& viewBox = document.ViewBox;
+        if (!document.HasViewBox() || viewBox.Width <= 0 || viewBox.Height <= 0)
+        {
+            return Matrix::Identity();
+        }
+        auto scale = std::min(width / viewBox.Width, height / viewBox.Height);
+        auto x = (width - viewBox.Width * scale) / 2.0f - viewBox.X * scale;
+        auto y = (height - viewBox.Height * scale) / 2.0f - viewBox.Y * scale;
+        return { scale, 0, 0, scale, x, y };
+    }
+}
+
+namespace GeometryRasterizer
+{
+    void Bitmap::Resize(uint32_t width, uint32_t height)
+    {
+        Width = width;
+        Height = height;
+        Pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    }
+
+    uint32_t ScaledSize(float size, float scale)
+    {
+        return static_cast<uint32_t>(std::ceil(size * scale));
+    }
+
+    void Render(
+        DocumentView const& document,
+        float width,
+        float height,
+        float scale,
+        Target const& target)
+    {
+        if (document.Nodes.empty())
+        {
+            return;
+        }
+        auto& bitmap = *target.Bitmap;
+        PixelRect clip =
+        {
+            static_cast<int>(target.X),
+            static_cast<int>(target.Y),
+            static_cast<int>(std::min(bitmap.Width, target.X + ScaledSize(width, scale))),
+            static_cast<int>(std::min(bitmap.Height, target.Y + ScaledSize(height, scale))),
+        };
+        auto toTarget = Multiply(
+            ViewBoxTransform(document, width, height),
+            { scale, 0, 0, scale, static_cast<float>(target.X), static_cast<float>(target.Y) });
+
+        // Children in drawing order, parents always come first
+        std::vector<std::vector<uint32_t>> children(document.Nodes.Size);
+        for (auto i = 1u; i < document.Nodes.Size; i++)
+        {
+            children[document.Nodes[i].Parent].push_back(i);
+        }
+        std::vector<Matrix> transforms(document.Nodes.Size);
+        transforms[0] = Multiply(TransformOf(document.Nodes[0]), toTarget);
+
+        CoverageMask mask;
+        std::vector<uint32_t> stack = { 0 };
+        while (!stack.empty())
+        {
+            auto index = stack.back();
+            stack.pop_back();
+            auto& node = document.Nodes[index];
+            auto& transform = transforms[index];
+            for (auto child = children[index].rbegin(); child != children[index].rend(); child++)
+            {
+                transforms[*child] = Multiply(TransformOf(document.Nodes[*child]), transform);
+                stack.push_back(*child);
+            }
+            if (node.Type == NodeType::Container)
+            {
+                continue;
+            }
+
+            auto pixelScale = ScaleOf(transform);
+            if (pixelScale == 0)
+            {
+                continue;
+            }
+            auto contours = BuildOutline(document, node, FlattenTolerance / pixelScale);
+            Bounds localBounds;
+            for (auto& contour : contours)
+            {
+                for (auto& point : contour.Points)
+                {
+                    localBounds.Add(point);
+                    point = transform.TransformPoint(point);
+                }
+            }
+
+            if (node.FillBrush != NoBrush)
+            {
+                mask.Clear();
+                for (auto& contour : contours)
+                {
+                    mask.AddPolygon(contour.Points.data(), contour.Points.size());
+                }
+                auto rule = node.Type == NodeType::Path ? FillRule::EvenOdd : FillRule::NonZero;
+                if (mask.Rasterize(rule, clip))
+                {
+                    Composite(bitmap, mask, BrushSampler(document, node.FillBrush, transform, localBounds));
+                }
+            }
+            if (node.StrokeBrush != NoBrush && node.StrokeWidth > 0)
+            {
+                mask.Clear();
+                AddStroke(mask, contours, node.StrokeWidth * pixelScale / 2.0f);
+                if (mask.Rasterize(FillRule::NonZero, clip))
+                {
+                    Composite(bitmap, mask, BrushSampler(document, node.StrokeBrush, transform, localBounds));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Draws CardGeometry documents on the CPU, for when a card face is shown
+// as a bitmap instead of a tree of composition shapes. It follows what
+// the compositor does with the same document closely enough that the two
+// are hard to tell apart at the card's size:
+//
+//   - The view box is fit into the card and centered, like a
+//     CompositionViewBox with its default settings.
+//   - Paths are filled even-odd (like the D2D geometry SvgShapesBuilder
+//     builds), curves are flattened to a quarter of a pixel.
+//   - Strokes get round joins and flat caps. Composition uses miter
+//     joins, which only differ on sharp corners of thick strokes.
+//   - Gradients run left to right across the shape's bounds, the
+//     default for a CompositionLinearGradientBrush.
+//
+// Edges are anti-aliased with 4 samples vertically and exact coverage
+// horizontally.
+namespace GeometryRasterizer
+{
+    // Premultiplied RGBA, 4 bytes per pixel with no padding between rows
+    struct Bitmap
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<uint8_t> Pixels;
+
+        void Resize(uint32_t width, uint32_t height);
+        uint8_t* Row(uint32_t y) { return Pixels.data() + static_cast<size_t>(y) * Width * 4; }
+        uint8_t const* Row(uint32_t y) const { return Pixels.data() + static_cast<size_t>(y) * Width * 4; }
+    };
+
+    struct Target
+    {
+        GeometryRasterizer::Bitmap* Bitmap = nullptr;
+        // Where the card's top left corner goes, drawing is clipped to
+        // the card's size at this scale
+        uint32_t X = 0;
+        uint32_t Y = 0;
+    };
+
+    // The size in pixels of a card drawn at the given scale
+    uint32_t ScaledSize(float size, float scale);
+
+    // Draws the document the way a ShapeVisual of width by height would
+    // show it, scaled by scale, over whatever is already in the target.
+    // Expects a valid document (see CardGeometry::Validate).
+    void Render(
+        CardGeometry::DocumentView const& document,
+        float width,
+        float height,
+        float scale,
+        Target const& target);
+}
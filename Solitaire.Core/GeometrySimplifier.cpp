@@ -0,0 +1,435 @@
+#include "GeometrySimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace CardGeometry;
+
+namespace
+{
+    struct Bounds
+    {
+        float Left = std::numeric_limits<float>::infinity();
+        float Top = std::numeric_limits<float>::infinity();
+        float Right = -std::numeric_limits<float>::infinity();
+        float Bottom = -std::numeric_limits<float>::infinity();
+
+        void Add(Point point)
+        {
+            Left = std::min(Left, point.X);
+            Top = std::min(Top, point.Y);
+            Right = std::max(Right, point.X);
+            Bottom = std::max(Bottom, point.Y);
+        }
+        void Add(Bounds const& other)
+        {
+            Left = std::min(Left, other.Left);
+            Top = std::min(Top, other.Top);
+            Right = std::max(Right, other.Right);
+            Bottom = std::max(Bottom, other.Bottom);
+        }
+        void Inflate(float amount)
+        {
+            Left -= amount;
+            Top -= amount;
+            Right += amount;
+            Bottom += amount;
+        }
+        float Width() const { return Right - Left; }
+        float Height() const { return Bottom - Top; }
+        bool Intersects(Bounds const& other) const
+        {
+            return Left <= other.Right && other.Left <= Right && Top <= other.Bottom && other.Top <= Bottom;
+        }
+    };
+
+    bool IsSprite(Node const& node)
+    {
+        return node.Type != NodeType::Container;
+    }
+
+    // How much a node's transform scales lengths, on average
+    float ScaleOf(Matrix const& matrix)
+    {
+        return std::sqrt(std::fabs(matrix.M11 * matrix.M22 - matrix.M12 * matrix.M21));
+    }
+
+    bool TryInvert(Matrix const& matrix, Matrix& result)
+    {
+        auto determinant = matrix.M11 * matrix.M22 - matrix.M12 * matrix.M21;
+        if (determinant == 0 || !std::isfinite(determinant))
+        {
+            return false;
+        }
+        auto inverse = 1.0f / determinant;
+        result.M11 = matrix.M22 * inverse;
+        result.M12 = -matrix.M12 * inverse;
+        result.M21 = -matrix.M21 * inverse;
+        result.M22 = matrix.M11 * inverse;
+        result.M31 = (matrix.M21 * matrix.M32 - matrix.M22 * matrix.M31) * inverse;
+        result.M32 = (matrix.M12 * matrix.M31 - matrix.M11 * matrix.M32) * inverse;
+        return true;
+    }
+
+    bool IsTranslation(Matrix const& matrix)
+    {
+        const float epsilon = 1e-5f;
+        return std::fabs(matrix.M11 - 1) < epsilon && std::fabs(matrix.M12) < epsilon &&
+            std::fabs(matrix.M21) < epsilon && std::fabs(matrix.M22 - 1) < epsilon;
+    }
+
+    float DistanceToSegment(Point point, Point start, Point end)
+    {
+        auto dx = end.X - start.X;
+        auto dy = end.Y - start.Y;
+        auto lengthSquared = dx * dx + dy * dy;
+        auto amount = 0.0f;
+        if (lengthSquared > 0)
+        {
+            amount = ((point.X - start.X) * dx + (point.Y - start.Y) * dy) / lengthSquared;
+            amount = std::clamp(amount, 0.0f, 1.0f);
+        }
+        auto x = start.X + dx * amount - point.X;
+        auto y = start.Y + dy * amount - point.Y;
+        return std::sqrt(x * x + y * y);
+    }
+
+    bool DrawsWith(DocumentView const& document, int32_t brush)
+    {
+        if (brush == NoBrush)
+        {
+            return false;
+        }
+        auto& value = document.Brushes[brush];
+        return value.Type != BrushType::Color || value.Color.A != 0;
+    }
+
+    bool IsSolid(DocumentView const& document, int32_t brush)
+    {
+        return brush == NoBrush || document.Brushes[brush].Type == BrushType::Color;
+    }
+
+    class PathSimplifier
+    {
+    public:
+        PathSimplifier(GeometrySimplifier::Stats& stats) : m_stats(stats) {}
+
+        // Appends the simplified path to segments/points, tolerance and
+        // stroke width are in the path's own units. Returns the bounds of
+        // what was kept.
+        Bounds Simplify(
+            DocumentView const& document,
+            Node const& node,
+            float tolerance,
+            float strokeWidth,
+            std::vector<SegmentType>& segments,
+            std::vector<Point>& points)
+        {
+            Bounds bounds;
+            auto point = document.Points.Data + node.FirstPoint;
+            auto segment = document.Segments.Data + node.FirstSegment;
+            auto const end = segment + node.SegmentCount;
+            while (segment < end)
+            {
+                // Every subpath starts with a move
+                auto start = *point++;
+                segment++;
+                m_subpathSegments.clear();
+                m_subpathPoints.clear();
+                m_run.clear();
+                m_run.push_back(start);
+                Bounds subpathBounds;
+                subpathBounds.Add(start);
+                auto current = start;
+
+                for (; segment < end && *segment != SegmentType::MoveTo; segment++)
+                {
+                    switch (*segment)
+                    {
+                    case SegmentType::LineTo:
+                        current = *point++;
+                        subpathBounds.Add(current);
+                        m_run.push_back(current);
+                        break;
+                    case SegmentType::CubicTo:
+                    {
+                        auto control1 = point[0];
+                        auto control2 = point[1];
+                        auto next = point[2];
+                        point += 3;
+                        subpathBounds.Add(control1);
+                        subpathBounds.Add(control2);
+                        subpathBounds.Add(next);
+                        // A cubic never strays more than 3/4 of its furthest
+                        // control point's distance from the chord.
+                        auto deviation = std::max(
+                            DistanceToSegment(control1, current, next),
+                            DistanceToSegment(control2, current, next)) * 0.75f;
+                        if (deviation <= tolerance)
+                        {
+                            m_stats.CurvesFlattened++;
+                            m_run.push_back(next);
+                        }
+                        else
+                        {
+                            FlushRun(tolerance);
+                            m_subpathSegments.push_back(SegmentType::CubicTo);
+                            m_subpathPoints.insert(m_subpathPoints.end(), { control1, control2, next });
+                            m_run.back() = next;
+                        }
+                        current = next;
+                    }
+                        break;
+                    case SegmentType::Close:
+                        FlushRun(tolerance);
+                        m_subpathSegments.push_back(SegmentType::Close);
+                        current = start;
+                        m_run.back() = start;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                FlushRun(tolerance);
+
+                // Nothing drawn, or too small to see
+                auto size = std::max(subpathBounds.Width(), subpathBounds.Height()) + strokeWidth;
+                if (m_subpathSegments.empty() || size <= tolerance)
+                {
+                    m_stats.SubpathsDropped++;
+                    continue;
+                }
+                segments.push_back(SegmentType::MoveTo);
+                points.push_back(start);
+                segments.insert(segments.end(), m_subpathSegments.begin(), m_subpathSegments.end());
+                points.insert(points.end(), m_subpathPoints.begin(), m_subpathPoints.end());
+                bounds.Add(subpathBounds);
+            }
+            return bounds;
+        }
+
+    private:
+        // Emits the pending run of lines (which starts at the current
+        // point) after running Douglas-Peucker over it.
+        void FlushRun(float tolerance)
+        {
+            auto count = m_run.size();
+            if (count >= 2)
+            {
+                m_keep.assign(count, false);
+                m_keep[0] = true;
+                m_keep[count - 1] = true;
+                m_stack.clear();
+                m_stack.push_back({ 0, count - 1 });
+                while (!m_stack.empty())
+                {
+                    auto range = m_stack.back();
+                    m_stack.pop_back();
+                    auto furthest = range.first;
+                    auto distance = 0.0f;
+                    for (auto i = range.first + 1; i < range.second; i++)
+                    {
+                        auto current = DistanceToSegment(m_run[i], m_run[range.first], m_run[range.second]);
+                        if (current > distance)
+                        {
+                            distance = current;
+                            furthest = i;
+                        }
+                    }
+                    if (distance > tolerance)
+                    {
+                        m_keep[furthest] = true;
+                        m_stack.push_back({ range.first, furthest });
+                        m_stack.push_back({ furthest, range.second });
+                    }
+                }
+
+                for (auto i = 1u; i < count; i++)
+                {
+                    if (m_keep[i])
+                    {
+                        m_subpathSegments.push_back(SegmentType::LineTo);
+                        m_subpathPoints.push_back(m_run[i]);
+                    }
+                    else
+                    {
+                        m_stats.LinesRemoved++;
+                    }
+                }
+            }
+            // The next run starts where this one ended
+            auto last = m_run.back();
+            m_run.clear();
+            m_run.push_back(last);
+        }
+
+    private:
+        GeometrySimplifier::Stats& m_stats;
+        std::vector<Point> m_run;
+        std::vector<bool> m_keep;
+        std::vector<std::pair<size_t, size_t>> m_stack;
+        std::vector<SegmentType> m_subpathSegments;
+        std::vector<Point> m_subpathPoints;
+    };
+}
+
+namespace GeometrySimplifier
+{
+    size_t Counts::GeometryBytes() const
+    {
+        return Segments * sizeof(SegmentType) + Points * sizeof(Point);
+    }
+
+    Counts Count(DocumentView const& document)
+    {
+        Counts counts;
+        for (auto& node : document.Nodes)
+        {
+            counts.Sprites += IsSprite(node) ? 1 : 0;
+        }
+        counts.Segments = document.Segments.Size;
+        counts.Points = document.Points.Size;
+        return counts;
+    }
+
+    Document Simplify(DocumentView const& document, Options const& options, Stats& stats)
+    {
+        stats = {};
+        stats.Before = Count(document);
+
+        Document result;
+        result.Flags = document.Flags;
+        result.ViewBox = document.ViewBox;
+        result.Brushes.assign(document.Brushes.begin(), document.Brushes.end());
+        result.Stops.assign(document.Stops.begin(), document.Stops.end());
+        if (options.Tolerance <= 0)
+        {
+            result.Nodes.assign(document.Nodes.begin(), document.Nodes.end());
+            result.Segments.assign(document.Segments.begin(), document.Segments.end());
+            result.Points.assign(document.Points.begin(), document.Points.end());
+            stats.After = stats.Before;
+            return result;
+        }
+
+        // From the document's units to the target's
+        auto targetScale = 1.0f;
+        if (document.HasViewBox() && document.ViewBox.Width > 0 && document.ViewBox.Height > 0)
+        {
+            targetScale = std::min(options.TargetWidth / document.ViewBox.Width, options.TargetHeight / document.ViewBox.Height);
+        }
+
+        std::vector<Matrix> worldTransforms(document.Nodes.Size);
+        std::vector<int32_t> newIndices(document.Nodes.Size, NoParent);
+        PathSimplifier pathSimplifier(stats);
+        // The last sprite that was kept, if it's a path that can take more
+        auto mergeTarget = NoParent;
+        auto mergeTargetSource = NoParent;
+        Bounds mergeBounds;
+
+        for (auto i = 0u; i < document.Nodes.Size; i++)
+        {
+            auto node = document.Nodes[i];
+            auto parentTransform = node.Parent == NoParent ? Matrix::Identity() : worldTransforms[node.Parent];
+            worldTransforms[i] = (node.Flags & NodeHasTransform) != 0 ? Multiply(node.Transform, parentTransform) : parentTransform;
+            if (node.Parent != NoParent)
+            {
+                node.Parent = newIndices[node.Parent];
+            }
+
+            if (!IsSprite(node))
+            {
+                newIndices[i] = static_cast<int32_t>(result.Nodes.size());
+                result.Nodes.push_back(node);
+                continue;
+            }
+
+            auto scale = ScaleOf(worldTransforms[i]) * targetScale;
+            auto stroked = DrawsWith(document, node.StrokeBrush) && node.StrokeWidth > 0;
+            auto visible = scale > 0 && (DrawsWith(document, node.FillBrush) || stroked);
+            if (!visible)
+            {
+                stats.SpritesDropped++;
+                continue;
+            }
+
+            auto tolerance = options.Tolerance / scale;
+            auto strokeWidth = stroked ? node.StrokeWidth : 0.0f;
+            if (node.Type != NodeType::Path)
+            {
+                // Everything else is some kind of box
+                auto width = node.Type == NodeType::Ellipse ? node.Params[2] * 2 : node.Params[2];
+                auto height = node.Type == NodeType::Ellipse ? node.Params[3] * 2 : node.Params[3];
+                if (std::max(width, height) + strokeWidth <= tolerance)
+                {
+                    stats.SpritesDropped++;
+                    continue;
+                }
+                newIndices[i] = static_cast<int32_t>(result.Nodes.size());
+                result.Nodes.push_back(node);
+                mergeTarget = NoParent;
+                continue;
+            }
+
+            auto firstSegment = result.Segments.size();
+            auto firstPoint = result.Points.size();
+            auto bounds = pathSimplifier.Simplify(document, document.Nodes[i], tolerance, strokeWidth, result.Segments, result.Points);
+            if (result.Segments.size() == firstSegment)
+            {
+                stats.SpritesDropped++;
+                continue;
+            }
+
+            // Merge into the previous path if nobody can tell the difference
+            if (mergeTarget != NoParent)
+            {
+                auto& target = result.Nodes[mergeTarget];
+                auto& source = document.Nodes[mergeTargetSource];
+                Matrix inverse;
+                auto compatible = target.FillBrush == node.FillBrush &&
+                    target.StrokeBrush == node.StrokeBrush &&
+                    IsSolid(document, node.FillBrush) &&
+                    IsSolid(document, node.StrokeBrush) &&
+                    TryInvert(worldTransforms[mergeTargetSource], inverse);
+                auto relative = compatible ? Multiply(worldTransforms[i], inverse) : Matrix::Identity();
+                if (compatible && stroked)
+                {
+                    // Strokes would scale along with the points
+                    compatible = node.StrokeWidth == source.StrokeWidth && IsTranslation(relative);
+                }
+                Bounds moved;
+                for (auto j = firstPoint; compatible && j < result.Points.size(); j++)
+                {
+                    moved.Add(relative.TransformPoint(result.Points[j]));
+                }
+                moved.Inflate(strokeWidth);
+                if (compatible && !moved.Intersects(mergeBounds))
+                {
+                    for (auto j = firstPoint; j < result.Points.size(); j++)
+                    {
+                        result.Points[j] = relative.TransformPoint(result.Points[j]);
+                    }
+                    target.SegmentCount += static_cast<uint32_t>(result.Segments.size() - firstSegment);
+                    target.PointCount += static_cast<uint32_t>(result.Points.size() - firstPoint);
+                    mergeBounds.Add(moved);
+                    stats.SpritesMerged++;
+                    continue;
+                }
+            }
+
+            node.FirstSegment = static_cast<uint32_t>(firstSegment);
+            node.SegmentCount = static_cast<uint32_t>(result.Segments.size() - firstSegment);
+            node.FirstPoint = static_cast<uint32_t>(firstPoint);
+            node.PointCount = static_cast<uint32_t>(result.Points.size() - firstPoint);
+            newIndices[i] = static_cast<int32_t>(result.Nodes.size());
+            result.Nodes.push_back(node);
+            mergeTarget = newIndices[i];
+            mergeTargetSource = static_cast<int32_t>(i);
+            mergeBounds = bounds;
+            mergeBounds.Inflate(strokeWidth);
+        }
+
+        stats.After = Count(result.View());
+        return result;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Trades a little fidelity for a lot less geometry. The card faces are
+// drawn at 167x243, but the court cards carry artwork detailed enough for
+// a poster. Everything here is measured against a tolerance in target
+// units (the size the document is drawn at):
+//
+//   - Cubics that stay within the tolerance of their chord become lines.
+//   - Runs of lines are simplified with Douglas-Peucker.
+//   - Subpaths and sprites smaller than the tolerance are dropped, and so
+//     are sprites that don't draw anything.
+//   - Consecutive paths with the same solid fill and stroke are merged
+//     into one sprite, as long as their bounds don't overlap (the paths
+//     are filled with the alternate fill mode, so overlapping would punch
+//     holes).
+//
+// Brushes and containers are left alone, so node indices change but the
+// drawing order doesn't.
+namespace GeometrySimplifier
+{
+    // A quarter of a logical pixel
+    const float DefaultTolerance = 0.25f;
+
+    struct Options
+    {
+        // The view box is fit into this size, same as CompositionViewBox
+        float TargetWidth = 167.0f;
+        float TargetHeight = 243.0f;
+        // Zero leaves the geometry as it is
+        float Tolerance = DefaultTolerance;
+    };
+
+    struct Counts
+    {
+        size_t Sprites = 0;
+        size_t Segments = 0;
+        size_t Points = 0;
+
+        size_t GeometryBytes() const;
+    };
+
+    struct Stats
+    {
+        Counts Before;
+        Counts After;
+        size_t CurvesFlattened = 0;
+        size_t LinesRemoved = 0;
+        size_t SubpathsDropped = 0;
+        size_t SpritesDropped = 0;
+        size_t SpritesMerged = 0;
+    };
+
+    Counts Count(CardGeometry::DocumentView const& document);
+    CardGeometry::Document Simplify(CardGeometry::DocumentView const& document, Options const& options, Stats& stats);
+}
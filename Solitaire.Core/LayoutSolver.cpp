@@ -0,0 +1,57 @@
+#include "LayoutSolver.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+BoardMetrics const& LayoutSolver::Solve(float width, float height, int tallestColumn)
+{
+    Key key{ static_cast<int>(std::lround(width)), static_cast<int>(std::lround(height)), tallestColumn };
+    auto search = m_cache.find(key);
+    if (search != m_cache.end())
+    {
+        m_cacheHits++;
+        return search->second;
+    }
+
+    m_cacheMisses++;
+    if (m_cache.size() >= MaxCacheEntries)
+    {
+        m_cache.clear();
+    }
+    auto [result, inserted] = m_cache.emplace(key, Compute(width, height, tallestColumn));
+    return result->second;
+}
+
+BoardMetrics LayoutSolver::Compute(float width, float height, int tallestColumn) const
+{
+    auto const& p = m_parameters;
+    assert(p.PreferredVerticalOffset >= p.MinimumVerticalOffset);
+    BoardMetrics metrics;
+    metrics.CardWidth = p.CardWidth;
+
+    // Spread the columns out over the width, but past a certain point
+    // it's nicer to keep them together and center the board.
+    auto const columns = static_cast<float>(NumberOfColumns);
+    auto spacing = (width - (2.0f * p.Margin) - (columns * p.CardWidth)) / (columns - 1.0f);
+    metrics.ColumnSpacing = std::clamp(spacing, p.MinimumColumnSpacing, p.MaximumColumnSpacing);
+    auto boardWidth = (columns * p.CardWidth) + ((columns - 1.0f) * metrics.ColumnSpacing);
+    metrics.BoardLeft = std::max((width - boardWidth) / 2.0f, p.Margin);
+    metrics.BoardTop = p.Margin;
+    metrics.PlayAreaTop = metrics.BoardTop + p.CardHeight + p.RowSpacing;
+
+    // The waste fans out towards the foundations, which start at the
+    // fourth column. Keep a column's worth of spacing between them.
+    auto wasteRoom = metrics.ColumnX(3) - metrics.ColumnX(1) - p.CardWidth - metrics.ColumnSpacing;
+    metrics.WasteHorizontalOffset = std::clamp(wasteRoom / 2.0f, p.MinimumWasteOffset, p.PreferredWasteOffset);
+
+    // Compress the tallest column so that it fits in the play area
+    metrics.CardStackVerticalOffset = p.PreferredVerticalOffset;
+    if (tallestColumn > 1)
+    {
+        auto available = height - p.Margin - metrics.PlayAreaTop - p.CardHeight;
+        auto offset = available / static_cast<float>(tallestColumn - 1);
+        metrics.CardStackVerticalOffset = std::clamp(offset, p.MinimumVerticalOffset, p.PreferredVerticalOffset);
+    }
+
+    return metrics;
+}
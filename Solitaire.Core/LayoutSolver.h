@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+struct LayoutSolverParameters
+{
+    float CardWidth = 167.0f;
+    float CardHeight = 243.0f;
+    // Enough to see the index in the corner of the card underneath, which
+    // is ShapeCache::TextHeight. There's no default, the caller has to
+    // pass it (Solve asserts that it did).
+    float PreferredVerticalOffset = 0.0f;
+    float MinimumVerticalOffset = 12.0f;
+    float PreferredWasteOffset = 65.0f;
+    float MinimumWasteOffset = 20.0f;
+    float MinimumColumnSpacing = 15.0f;
+    float MaximumColumnSpacing = 60.0f;
+    // Space between the top row (deck, waste, foundations) and the play area
+    float RowSpacing = 25.0f;
+    float Margin = 0.0f;
+};
+
+struct BoardMetrics
+{
+    float ColumnSpacing = 0.0f;
+    float BoardLeft = 0.0f;
+    float BoardTop = 0.0f;
+    float PlayAreaTop = 0.0f;
+    float CardStackVerticalOffset = 0.0f;
+    float WasteHorizontalOffset = 0.0f;
+    float CardWidth = 0.0f;
+
+    // The deck and waste sit above the first two columns and the
+    // foundations above the last four.
+    float ColumnX(int column) const { return BoardLeft + column * (CardWidth + ColumnSpacing); }
+};
+
+// Computes the board spacing for the space available and the tallest
+// column in the tableau. Solutions are memoized, the same handful of
+// sizes and column heights come up over and over again.
+class LayoutSolver
+{
+public:
+    static constexpr int NumberOfColumns = 7;
+
+    LayoutSolver() {}
+    LayoutSolver(LayoutSolverParameters const& parameters) : m_parameters(parameters) {}
+
+    LayoutSolverParameters const& Parameters() const { return m_parameters; }
+    BoardMetrics const& Solve(float width, float height, int tallestColumn);
+
+    uint64_t CacheHits() const { return m_cacheHits; }
+    uint64_t CacheMisses() const { return m_cacheMisses; }
+
+private:
+    BoardMetrics Compute(float width, float height, int tallestColumn) const;
+
+private:
+    // (width, height, tallest column). Sizes are in whole units, the
+    // solutions don't change in any meaningful way below that.
+    using Key = std::tuple<int, int, int>;
+    static constexpr size_t MaxCacheEntries = 256;
+
+    LayoutSolverParameters m_parameters;
+    std::map<Key, BoardMetrics> m_cache;
+    uint64_t m_cacheHits = 0;
+    uint64_t m_cacheMisses = 0;
+};
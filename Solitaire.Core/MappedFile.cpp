@@ -0,0 +1,104 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::Open(std::wstring const& path)
+{
+    Close();
+
+    // These all work from inside of the app container
+    auto file = CreateFile2(path.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    auto mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0 ?
+        CreateFileMappingFromApp(file, nullptr, PAGE_READONLY, 0, nullptr) :
+        nullptr;
+    // The mapping keeps the file open
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    auto data = MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t const*>(data);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::Open(std::string const& path)
+{
+    Close();
+
+    auto file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat info = {};
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // The mapping keeps the file open
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<uint8_t const*>(data);
+    m_size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// NOTE: This file is shared with Solitaire.Tools. It uses the platform's
+// file mapping APIs directly, but has no WinRT dependencies.
+
+// A read-only view of an entire file. Pages are only read in when they're
+// touched, and the mapping is released when this goes away.
+class MappedFile
+{
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    // Returns false if the file couldn't be opened or mapped
+#ifdef _WIN32
+    bool Open(std::wstring const& path);
+#else
+    bool Open(std::string const& path);
+#endif
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    uint8_t const* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    uint8_t const* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
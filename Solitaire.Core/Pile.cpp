@@ -2,6 +2,7 @@
 #include "Card.h"
 #include "CompositionCard.h"
 #include "ShapeCache.h"
+#include "BoardLayout.h"
 #include "Pile.h"
 
 namespace winrt
@@ -90,43 +91,67 @@ void Pile::ForceLayout()
         }
         index++;
     }
+    m_layoutDirtyStart = -1;
 }
 
-// The coordinates provides are assumed to be in "base space" (the local space for the base visual)
-Pile::HitTestResult Pile::HitTest(winrt::float2 point)
+void Pile::InvalidateLayout(int startIndex)
 {
-    Pile::HitTestResult result;
+    if (startIndex < 0)
+    {
+        startIndex = 0;
+    }
+    if (m_layoutDirtyStart < 0 || startIndex < m_layoutDirtyStart)
+    {
+        m_layoutDirtyStart = startIndex;
+    }
+}
 
-    for (int i = m_cards.size() - 1; i >= 0; i--)
+// Unlike ForceLayout, this only rewrites the offsets of the containers
+// that were invalidated and never touches the visual tree structure.
+void Pile::UpdateLayout()
+{
+    if (m_layoutDirtyStart < 0)
     {
-        auto card = m_cards[i];
+        return;
+    }
 
-        winrt::float3 accumulatedOffset = ComputeBaseSpaceOffset(i, m_cards.size());
+    auto totalCards = static_cast<int>(m_itemContainers.size());
+    for (auto index = m_layoutDirtyStart; index < totalCards; index++)
+    {
+        m_itemContainers[index].Root.Offset(ComputeOffset(index, totalCards));
+    }
+    m_layoutDirtyStart = -1;
+}
 
-        auto tempPoint = point;
-        tempPoint.x -= accumulatedOffset.x;
-        tempPoint.y -= accumulatedOffset.y;
-        if (card->HitTest(tempPoint))
-        {
-            result.Target = Pile::HitTestTarget::Card;
-            result.CardIndex = i;
-            return result;
-        }
+// Same as above, but takes the positions from the board layout. The layout
+// is in absolute coordinates and each container is nested inside of the
+// previous one, so each container only gets the difference.
+void Pile::UpdateLayout(BoardLayout& layout, int layoutPile)
+{
+    if (m_layoutDirtyStart < 0)
+    {
+        return;
     }
 
-    winrt::float2 const size = m_background.Size();
-    if (point.x >= 0 &&
-        point.x < size.x &&
-        point.y >= 0 &&
-        point.y < size.y)
+    auto totalCards = layout.CardCount(layoutPile);
+    if (totalCards != static_cast<int>(m_itemContainers.size()))
     {
-        result.Target = Pile::HitTestTarget::Base;
-        return result;
+        // Some of our cards are being moved around, so the layout
+        // doesn't describe every container.
+        UpdateLayout();
+        return;
     }
 
-    WINRT_ASSERT(result.Target == Pile::HitTestTarget::None);
-    WINRT_ASSERT(result.CardIndex < 0);
-    return result;
+    auto start = layout.PileStart(layoutPile);
+    auto x = layout.X() + start;
+    auto y = layout.Y() + start;
+    for (auto index = m_layoutDirtyStart; index < totalCards; index++)
+    {
+        auto previousX = index > 0 ? x[index - 1] : layout.OriginX(layoutPile);
+        auto previousY = index > 0 ? y[index - 1] : layout.OriginY(layoutPile);
+        m_itemContainers[index].Root.Offset({ x[index] - previousX, y[index] - previousY, 0 });
+    }
+    m_layoutDirtyStart = -1;
 }
 
 std::tuple<Pile::ItemContainerList, Pile::CardList, Pile::RemovalOperation> Pile::Split(int index)
@@ -299,12 +324,8 @@ void Pile::CompleteRemoval(Pile::RemovalOperation operation)
         }
         parentChildren.InsertAtTop(shiftedVisual);
 
-        auto currentIndex = operation.Index;
-        for (auto container = m_itemContainers.begin() + operation.Index; container != m_itemContainers.end(); container++)
-        {
-            container->Root.Offset(ComputeOffset(currentIndex, m_itemContainers.size()));
-            currentIndex++;
-        }
+        InvalidateLayout(operation.Index);
+        UpdateLayout();
     }
 
     WINRT_ASSERT(m_itemContainers.size() == m_cards.size());
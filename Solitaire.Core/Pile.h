@@ -2,6 +2,7 @@
 
 class ShapeCache;
 class CompositionCard;
+class BoardLayout;
 
 class Pile
 {
@@ -42,8 +43,6 @@ public:
         int CardIndex = -1;
     };
 
-    Pile::HitTestResult HitTest(winrt::Windows::Foundation::Numerics::float2 point);
-
     virtual bool CanSplit(int index) = 0;
     std::tuple<Pile::ItemContainerList, Pile::CardList, Pile::RemovalOperation> Split(int index);
 
@@ -57,10 +56,13 @@ public:
     void Add(Pile::CardList const& cards);
 
     void ForceLayout();
+    void InvalidateLayout(int startIndex = 0);
+    bool IsLayoutDirty() const { return m_layoutDirtyStart >= 0; }
+    void UpdateLayout();
+    void UpdateLayout(BoardLayout& layout, int layoutPile);
 
 protected:
     virtual winrt::Windows::Foundation::Numerics::float3 ComputeOffset(int index, int totalCards) = 0;
-    virtual winrt::Windows::Foundation::Numerics::float3 ComputeBaseSpaceOffset(int index, int totalCards) = 0;
     virtual void OnRemovalCompleted(Pile::RemovalOperation operation) = 0;
 
     void AddInternal(Pile::CardList const& cards);
@@ -70,4 +72,6 @@ protected:
     winrt::Windows::UI::Composition::VisualCollection m_children{ nullptr };
     Pile::CardList m_cards;
     Pile::ItemContainerList m_itemContainers;
+    // Index of the first container whose offset is stale, -1 if none are
+    int m_layoutDirtyStart = -1;
 };
\ No newline at end of file
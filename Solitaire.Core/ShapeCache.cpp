@@ -3,6 +3,11 @@
 #include "Card.h"
 #include "CompositionCard.h"
 #include "SvgShapesBuilder.h"
+#include "GeometryCache.h"
+#include "GeometryFlattener.h"
+#include "GeometrySimplifier.h"
+#include "StartupTrace.h"
+#include "SvgGeometryConverter.h"
 
 namespace winrt
 {
@@ -22,28 +27,37 @@ namespace util
     using namespace robmikh::common::uwp;
 }
 
+// Reading and parsing the SVGs is spread over this many workers. Faces
+// from the bundle only need converting, which happens one at a time, so
+// that gets a single worker.
+const uint32_t MaxCardFaceLoadWorkers = 8;
+
+const wchar_t* const CardFacesBundleFileName = L"CardFaces.bundle";
+const wchar_t* const CardFacesArchiveFileName = L"CardFaces.pack";
+const wchar_t* const DiskCacheFolderName = L"CardFaces";
+
+uint32_t GetCardId(Card const& card);
+CardGeometry::Document CopyDocument(CardGeometry::DocumentView const& view);
 std::wstring GetSvgFileName(Card const& card);
-winrt::CompositionSpriteShape BuildRoundedRectShape(
-    winrt::Compositor const& compositor,
-    winrt::float2 const& size,
-    winrt::float2 const& cornerRadius,
-    float strokeThickness,
-    winrt::CompositionBrush const& strokeBrush,
-    winrt::CompositionBrush const& fillBrush);
+double MillisecondsSince(std::chrono::steady_clock::time_point const& start);
+bool WriteFileReplacing(std::wstring const& path, std::vector<uint8_t> const& data);
 
 std::future<std::shared_ptr<ShapeCache>> ShapeCache::CreateAsync(
     winrt::Compositor const& compositor,
-    winrt::StorageFolder const& assetsFolder)
+    winrt::StorageFolder const& assetsFolder,
+    CardFaceRendering rendering,
+    StartupMode startupMode)
 {
     auto cache = std::make_shared<ShapeCache>();
-    co_await cache->FillCacheAsync(compositor, assetsFolder);
+    co_await cache->FillCacheAsync(compositor, assetsFolder, rendering, startupMode);
     co_return cache;
 }
 
 SvgCompositionShapes ShapeCache::GetCardFace(
     Card const& key)
 {
-    return m_geometryCache.at(key);
+    std::lock_guard lock(m_lock);
+    return m_cardFaces.at(key).Shapes;
 }
 
 winrt::CompositionShape ShapeCache::GetShape(ShapeType shapeType)
@@ -51,10 +65,128 @@ winrt::CompositionShape ShapeCache::GetShape(ShapeType shapeType)
     return m_shapeCache.at(shapeType);
 }
 
+void ShapeCache::PrioritizeCardFaces(std::vector<Card> const& cards, CardFacePriority priority)
+{
+    {
+        std::lock_guard lock(m_lock);
+        for (auto& card : cards)
+        {
+            auto& slot = m_cardFaces.at(card);
+            if (priority >= slot.Priority)
+            {
+                continue;
+            }
+            if (priority == CardFacePriority::Visible && !slot.Finished)
+            {
+                m_visiblePending++;
+            }
+            slot.Priority = priority;
+            slot.Order = m_nextOrder++;
+        }
+        m_loadingRequested = true;
+    }
+    StartLoadingCardFaces();
+}
+
+void ShapeCache::SetDisplayScale(float scale)
+{
+    if (m_atlas)
+    {
+        m_atlas->UpdateScale(scale);
+        return;
+    }
+
+    // This is the resize on the UI thread, so the faces are converted
+    // on a worker and keep their current level until it's done
+    {
+        std::lock_guard lock(m_lock);
+        auto level = DetailLevels::Select(scale, m_requestedDetailLevel);
+        if (level == m_requestedDetailLevel)
+        {
+            return;
+        }
+        m_requestedDetailLevel = level;
+
+        std::wstringstream stringStream;
+        stringStream << L"Card faces going to detail level " << level << L" for scale " << scale << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+        // A switch that's already running picks it up
+        if (m_switchingDetailLevel)
+        {
+            return;
+        }
+        m_switchingDetailLevel = true;
+    }
+    SwitchDetailLevelWorkerAsync(shared_from_this());
+}
+
+ShapeCacheAccounting ShapeCache::GetAccounting()
+{
+    ShapeCacheAccounting accounting;
+    accounting.Back = m_shapeCounts[ShapeType::Back];
+    accounting.Empty = m_shapeCounts[ShapeType::Empty];
+    accounting.Total += accounting.Back;
+    accounting.Total += accounting.Empty;
+
+    std::lock_guard lock(m_lock);
+    for (auto& [card, slot] : m_cardFaces)
+    {
+        auto counts = slot.Counts;
+        for (auto& levelCounts : slot.LevelCounts)
+        {
+            counts += levelCounts;
+        }
+        accounting.CardFaces.emplace(card, counts);
+        accounting.Total += counts;
+    }
+    accounting.LoadedCardFaces = m_loadedCount;
+    return accounting;
+}
+
+void PrintShapeCounts(std::wstring const& name, ShapeCounts const& counts, std::wstringstream& stream)
+{
+    stream << L"    " << name.c_str() << L": " << counts.Bytes << L" bytes, "
+        << counts.ContainerShapes << L" containers, "
+        << counts.SpriteShapes << L" sprites, "
+        << counts.PathGeometries << L" paths (" << counts.Segments << L" segments, " << counts.Points << L" points), "
+        << counts.OtherGeometries << L" other geometries, "
+        << counts.Brushes << L" brushes, "
+        << counts.ViewBoxes << L" view boxes" << std::endl;
+}
+
+void ShapeCache::PrintAccounting(std::wstringstream& stream)
+{
+    auto accounting = GetAccounting();
+    stream << L"Shapes created, " << accounting.LoadedCardFaces << L" of " << accounting.CardFaces.size() << L" faces loaded";
+    if (m_atlas)
+    {
+        stream << L" (faces are drawn into the atlas)";
+    }
+    stream << L":" << std::endl;
+    PrintShapeCounts(L"Total", accounting.Total, stream);
+    PrintShapeCounts(L"Back", accounting.Back, stream);
+    PrintShapeCounts(L"Empty", accounting.Empty, stream);
+
+    // Most expensive first, that's where a budget gets blown
+    std::vector<std::pair<Card, ShapeCounts>> faces(accounting.CardFaces.begin(), accounting.CardFaces.end());
+    std::sort(faces.begin(), faces.end(), [](auto const& left, auto const& right)
+        {
+            return left.second.Bytes > right.second.Bytes;
+        });
+    for (auto& [card, counts] : faces)
+    {
+        PrintShapeCounts(GetSvgFileName(card), counts, stream);
+    }
+}
+
 winrt::IAsyncAction ShapeCache::FillCacheAsync(
     winrt::Compositor const& compositor,
-    winrt::StorageFolder const& assetsFolder)
+    winrt::StorageFolder const& assetsFolder,
+    CardFaceRendering rendering,
+    StartupMode startupMode)
 {
+    StartupSpan span("FillCacheAsync");
+    m_startTime = std::chrono::steady_clock::now();
     std::vector<Card> cards;
     for (auto i = 0; i < (int)Face::King; i++)
     {
@@ -67,170 +199,929 @@ winrt::IAsyncAction ShapeCache::FillCacheAsync(
         }
     }
 
-    auto d3dDevice = util::CreateD3DDevice();
-    auto d2dFactory = util::CreateD2DFactory();
-    auto d2dDevice = util::CreateD2DDevice(d2dFactory, d3dDevice);
-    winrt::com_ptr<ID2D1DeviceContext> d2dContextBase;
-    winrt::check_hresult(d2dDevice->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, d2dContextBase.put()));
-    auto d2dContext = d2dContextBase.as<ID2D1DeviceContext5>();
-    m_geometryCache.clear();
-    auto height = 34.0f; // TODO: I guess this should be hardcoded now, get the right number later
-    auto cardFacesFolder = co_await assetsFolder.GetFolderAsync(L"CardFaces");
-    for (auto& card : cards)
-    {
-        auto fileName = GetSvgFileName(card);
-        auto file = co_await cardFacesFolder.GetFileAsync(fileName);
-        auto stream = co_await file.OpenReadAsync();
-        auto istream = util::CreateStreamFromRandomAccessStream(stream);
-        D2D1_SIZE_F viewport = D2D1::SizeF(1, 1);
-        winrt::com_ptr<ID2D1SvgDocument> document;
-        winrt::check_hresult(d2dContext->CreateSvgDocument(istream.get(), viewport, document.put()));
-        auto shapeInfo = SvgShapesBuilder::ConvertSvgDocumentToCompositionShapes(compositor, document);
-
-        m_geometryCache.emplace(card, shapeInfo);
-    }
-
-    m_shapeCache.clear();
-    {
-        auto shapeContainer = compositor.CreateContainerShape();
-        auto backgroundBaseColor = winrt::Colors::Blue();
-
-        auto rectShape = BuildRoundedRectShape(
-            compositor, 
-            CompositionCard::CardSize, 
-            CompositionCard::CornerRadius,
-            0.5f, 
-            compositor.CreateColorBrush(winrt::Colors::Black()), 
-            compositor.CreateColorBrush(backgroundBaseColor));
-        shapeContainer.Shapes().Append(rectShape);
-
-        winrt::float2 innerOffset{ 12, 12 };
-        auto innerRectShape = BuildRoundedRectShape(
-            compositor,
-            CompositionCard::CardSize - innerOffset,
-            CompositionCard::CornerRadius,
-            5,
-            compositor.CreateColorBrush(winrt::Colors::White()),
-            compositor.CreateColorBrush(backgroundBaseColor));
-        innerRectShape.Offset(innerRectShape.Offset() + (innerOffset / 2.0f));
-        shapeContainer.Shapes().Append(innerRectShape);
-
-        m_shapeCache.emplace(ShapeType::Back, shapeContainer);
-    }
-
-    {
-        auto shapeContainer = compositor.CreateContainerShape();
-        auto backgroundBaseColor = winrt::Colors::Blue();
-
-        auto rectShape = BuildRoundedRectShape(
-            compositor,
-            CompositionCard::CardSize,
-            CompositionCard::CornerRadius,
-            5,
-            compositor.CreateColorBrush(winrt::Colors::Gray()),
-            nullptr);
-        shapeContainer.Shapes().Append(rectShape);
-
-        winrt::float2 innerSize{ CompositionCard::CardSize / 2.0f };
-        auto innerRoundedRectGeometry = compositor.CreateRoundedRectangleGeometry();
-        innerRoundedRectGeometry.CornerRadius(CompositionCard::CornerRadius);
-        innerRoundedRectGeometry.Size(innerSize);
-        auto innerRectShape = compositor.CreateSpriteShape(innerRoundedRectGeometry);
-        innerRectShape.FillBrush(compositor.CreateColorBrush(winrt::Colors::Gray()));
-        innerRectShape.StrokeThickness(5);
-        innerRectShape.Offset((CompositionCard::CardSize - innerSize) / 2.0f);
-        shapeContainer.Shapes().Append(innerRectShape);
-
-        m_shapeCache.emplace(ShapeType::Empty, shapeContainer);
+    // Path geometry gets built on whichever worker converts the face,
+    // always under m_conversionLock
+    D2D1_FACTORY_OPTIONS options = {};
+    {
+        StartupSpan factorySpan("CreateD2DFactory");
+        winrt::check_hresult(D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED, options, m_d2dFactory.put()));
     }
-
     m_compositor = compositor;
-    m_textHeight = height;
+    m_textHeight = 34.0f; // TODO: I guess this should be hardcoded now, get the right number later
+
+    if (startupMode == StartupMode::WaitForAssets)
+    {
+        co_await OpenSourcesAsync(assetsFolder);
+    }
+
+    // The SVG path (or a bundle without them) leaves these to us, and so
+    // does progressive startup. They're drawn in code, so they're ready
+    // long before anything from disk.
+    CardGeometry::CardShapeMetrics metrics;
+    metrics.Width = CompositionCard::CardSize.x;
+    metrics.Height = CompositionCard::CardSize.y;
+    metrics.CornerRadius = CompositionCard::CornerRadius.x;
+    if (m_shapeCache.find(ShapeType::Back) == m_shapeCache.end())
+    {
+        auto back = CardGeometry::BuildCardBack(metrics);
+        auto shapes = SvgShapesBuilder::ConvertGeometryToCompositionShapes(compositor, m_d2dFactory, m_sharedResources, back.View(), m_shapeCounts[ShapeType::Back]);
+        m_shapeCache.emplace(ShapeType::Back, shapes.RootShape);
+    }
+    if (m_shapeCache.find(ShapeType::Empty) == m_shapeCache.end())
+    {
+        auto empty = CardGeometry::BuildEmptyPile(metrics);
+        auto shapes = SvgShapesBuilder::ConvertGeometryToCompositionShapes(compositor, m_d2dFactory, m_sharedResources, empty.View(), m_shapeCounts[ShapeType::Empty]);
+        m_shapeCache.emplace(ShapeType::Empty, shapes.RootShape);
+    }
+
+    // The atlas draws its own placeholder
+    if (rendering == CardFaceRendering::Raster)
+    {
+        StartupSpan atlasSpan("CreateAtlas");
+        m_atlas = std::make_shared<CardFaceAtlas>(compositor, m_d2dFactory, metrics);
+    }
+
+    {
+        StartupSpan placeholderSpan("Placeholders");
+
+        // Every face starts out as a blank card drawn in card coordinates.
+        // The placeholders share their geometry and brushes, so they're cheap.
+        auto placeholder = CardGeometry::BuildCardPlaceholder(metrics);
+        for (auto& card : cards)
+        {
+            CardFaceSlot slot;
+            if (m_atlas)
+            {
+                slot.Order = m_nextOrder++;
+                m_cardFaces.emplace(card, slot);
+                continue;
+            }
+            slot.Shapes.ViewBox = compositor.CreateViewBox();
+            slot.Shapes.ViewBox.Size(CompositionCard::CardSize);
+            slot.Shapes.RootShape = compositor.CreateContainerShape();
+            auto shapes = SvgShapesBuilder::ConvertGeometryToCompositionShapes(compositor, m_d2dFactory, m_sharedResources, placeholder.View(), slot.Counts);
+            slot.Shapes.RootShape.Shapes().Append(shapes.RootShape);
+            slot.Counts.ViewBoxes++;
+            slot.Counts.ContainerShapes++;
+            slot.Counts.Bytes += ShapeSink::EstimatedViewBoxBytes + ShapeSink::EstimatedShapeBytes;
+            slot.Order = m_nextOrder++;
+            m_cardFaces.emplace(card, slot);
+        }
+    }
+
+    if (startupMode == StartupMode::Progressive)
+    {
+        // The board goes up without waiting, and the faces start loading
+        // once their source is open
+        OpenSourcesWorkerAsync(shared_from_this(), assetsFolder);
+    }
     co_return;
 }
 
-std::wstring GetSvgFileName(Card const& card)
+winrt::IAsyncAction ShapeCache::OpenSourcesWorkerAsync(
+    std::shared_ptr<ShapeCache> cache,
+    winrt::StorageFolder assetsFolder)
 {
-    std::wstringstream fileName;
-    switch (card.Face())
-    {
-    case Face::Ace:
-        fileName << L"ace";
-        break;
-    case Face::Two:
-        fileName << L"2";
-        break;
-    case Face::Three:
-        fileName << L"3";
-        break;
-    case Face::Four:
-        fileName << L"4";
-        break;
-    case Face::Five:
-        fileName << L"5";
-        break;
-    case Face::Six:
-        fileName << L"6";
-        break;
-    case Face::Seven:
-        fileName << L"7";
-        break;
-    case Face::Eight:
-        fileName << L"8";
-        break;
-    case Face::Nine:
-        fileName << L"9";
-        break;
-    case Face::Ten:
-        fileName << L"10";
-        break;
-    case Face::Jack:
-        fileName << L"jack";
-        break;
-    case Face::Queen:
-        fileName << L"queen";
-        break;
-    case Face::King:
-        fileName << L"king";
-        break;
-    }
-    fileName << L"_of_";
-    switch (card.Suit())
-    {
-    case Suit::Diamond:
-        fileName << L"diamonds";
-        break;
-    case Suit::Spade:
-        fileName << L"spades";
-        break;
-    case Suit::Heart:
-        fileName << L"hearts";
-        break;
-    case Suit::Club:
-        fileName << L"clubs";
-        break;
-    }
-    fileName << L".svg";
-    return fileName.str();
-}
-
-winrt::CompositionSpriteShape BuildRoundedRectShape(
+    co_await winrt::resume_background();
+    try
+    {
+        co_await cache->OpenSourcesAsync(assetsFolder);
+    }
+    catch (winrt::hresult_error const& error)
+    {
+        // Nobody is waiting on this, so the cards keep their placeholders
+        std::wstringstream stringStream;
+        stringStream << L"Couldn't open the card faces: " << error.message().c_str() << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+    }
+}
+
+winrt::IAsyncAction ShapeCache::OpenSourcesAsync(
+    winrt::StorageFolder const& assetsFolder)
+{
+    StartupSpan span("OpenSources");
+    m_assetsFolder = assetsFolder;
+
+    // Parsing the SVGs is most of our startup time, so use the
+    // precompiled bundle when it's been deployed with the app.
+    auto bundlePath = std::wstring(assetsFolder.Path()) + L"\\" + CardFacesBundleFileName;
+    m_useBundle = TryOpenBundle(m_compositor, bundlePath);
+    if (!m_useBundle)
+    {
+        // The bundle is shared between instances through the file cache
+        // already, without one we look for what another instance converted
+        m_useSharedGeometry = TryOpenSharedGeometry(m_compositor);
+        m_useBundle = m_useSharedGeometry;
+    }
+    if (!m_useBundle)
+    {
+        // Otherwise one mapping beats looking up and opening 52 files
+        auto archivePath = std::wstring(assetsFolder.Path()) + L"\\" + CardFacesArchiveFileName;
+        m_useArchive = TryOpenArchive(archivePath);
+    }
+    if (!m_useBundle && !m_useArchive)
+    {
+        StartupSpan folderSpan("GetCardFacesFolder");
+        m_cardFacesFolder = co_await assetsFolder.GetFolderAsync(L"CardFaces");
+    }
+    if (!m_useBundle)
+    {
+        StartupSpan cacheSpan("OpenDiskCache");
+        try
+        {
+            auto localCache = winrt::ApplicationData::Current().LocalCacheFolder();
+            auto cacheFolder = co_await localCache.CreateFolderAsync(DiskCacheFolderName, winrt::CreationCollisionOption::OpenIfExists);
+            m_diskCachePath = cacheFolder.Path();
+        }
+        catch (winrt::hresult_error const& error)
+        {
+            std::wstringstream stringStream;
+            stringStream << L"Not caching card faces: " << error.message().c_str() << std::endl;
+            Debug::OutputDebugStringStream(stringStream);
+        }
+    }
+
+    {
+        std::lock_guard lock(m_lock);
+        m_sourcesOpen = true;
+        // The atlas only loads full detail faces, which leaves nothing
+        // for the other levels
+        m_publishSharedGeometry = !m_useBundle && !m_atlas;
+    }
+    StartLoadingCardFaces();
+}
+
+bool ShapeCache::TryOpenBundle(
+    winrt::Compositor const& compositor,
+    std::wstring const& bundlePath)
+{
+    StartupSpan span("OpenBundle");
+    auto start = std::chrono::steady_clock::now();
+    if (!m_bundleFile.Open(bundlePath))
+    {
+        OutputDebugStringW(L"No card face bundle, loading the SVGs instead\n");
+        return false;
+    }
+
+    if (!TryReadBundle(compositor, m_bundleFile.Data(), m_bundleFile.Size(), L"card face bundle"))
+    {
+        m_bundleFile.Close();
+        return false;
+    }
+    m_openTime = MillisecondsSince(start);
+    return true;
+}
+
+bool ShapeCache::TryOpenSharedGeometry(winrt::Compositor const& compositor)
+{
+    StartupSpan span("OpenSharedGeometry");
+    auto start = std::chrono::steady_clock::now();
+    if (!m_sharedGeometry.Open(SharedGeometry::SegmentName()))
+    {
+        // We're the first, or the others are from another build
+        return false;
+    }
+    if (!TryReadBundle(compositor, m_sharedGeometry.Data(), m_sharedGeometry.Size(), L"shared card faces"))
+    {
+        m_sharedGeometry.Close();
+        return false;
+    }
+    m_openTime = MillisecondsSince(start);
+
+    std::wstringstream stringStream;
+    stringStream << L"Using the card faces another instance converted, " << m_sharedGeometry.ReaderCount() << L" instances share them" << std::endl;
+    Debug::OutputDebugStringStream(stringStream);
+    return true;
+}
+
+bool ShapeCache::TryReadBundle(
     winrt::Compositor const& compositor,
-    winrt::float2 const& size,
-    winrt::float2 const& cornerRadius,
-    float strokeThickness,
-    winrt::CompositionBrush const& strokeBrush,
-    winrt::CompositionBrush const& fillBrush)
-{
-    winrt::float2 strokeAddedSize{ strokeThickness, strokeThickness };
-    auto strokeOffset = strokeAddedSize / 2.0f;
-    auto roundedRectGeometry = compositor.CreateRoundedRectangleGeometry();
-    roundedRectGeometry.CornerRadius(cornerRadius);
-    roundedRectGeometry.Size(size - strokeAddedSize);
-    auto rectShape = compositor.CreateSpriteShape(roundedRectGeometry);
-    rectShape.StrokeBrush(strokeBrush);
-    rectShape.FillBrush(fillBrush);
-    rectShape.StrokeThickness(strokeThickness);
-    rectShape.Offset(strokeOffset);
-    return rectShape;
-}
\ No newline at end of file
+    uint8_t const* data,
+    size_t size,
+    wchar_t const* source)
+{
+    std::string error;
+    if (!m_bundleReader.Open(data, size, error))
+    {
+        std::wstringstream stringStream;
+        stringStream << L"Ignoring " << source << L": " << winrt::to_hstring(error).c_str() << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+        return false;
+    }
+    // Hashing the 3.4 MB bundle takes about 5 ms, which progressive
+    // startup spends off the UI thread. A bad bundle falls back to the
+    // archive the same way a bad cache entry is converted again.
+    if (!m_bundleReader.VerifyContentHash())
+    {
+        std::wstringstream stringStream;
+        stringStream << L"Ignoring " << source << L": content hash mismatch" << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+        m_bundleReader = {};
+        return false;
+    }
+
+    // All or nothing, a bundle that's missing cards is from some other
+    // build. Checked up front so the workers never have to fall back.
+    for (auto i = 0; i < (int)Face::King; i++)
+    {
+        for (auto j = 0; j < (int)Suit::Club + 1; j++)
+        {
+            CardGeometry::DocumentView document;
+            if (!m_bundleReader.TryFind(AssetArchive::CardAssetName(AssetArchive::CardId(i + 1, j)), document))
+            {
+                std::wstringstream stringStream;
+                stringStream << L"Ignoring " << source << L", it's missing cards" << std::endl;
+                Debug::OutputDebugStringStream(stringStream);
+                m_bundleReader = {};
+                return false;
+            }
+        }
+    }
+
+    // Progressive startup has already put up the ones drawn in code
+    CardGeometry::DocumentView document;
+    if (m_shapeCache.find(ShapeType::Back) == m_shapeCache.end() && m_bundleReader.TryFind(GeometryBundle::CardBackName, document))
+    {
+        m_shapeCache.emplace(ShapeType::Back, SvgShapesBuilder::ConvertGeometryToCompositionShapes(compositor, m_d2dFactory, m_sharedResources, document, m_shapeCounts[ShapeType::Back]).RootShape);
+    }
+    if (m_shapeCache.find(ShapeType::Empty) == m_shapeCache.end() && m_bundleReader.TryFind(GeometryBundle::EmptyPileName, document))
+    {
+        m_shapeCache.emplace(ShapeType::Empty, SvgShapesBuilder::ConvertGeometryToCompositionShapes(compositor, m_d2dFactory, m_sharedResources, document, m_shapeCounts[ShapeType::Empty]).RootShape);
+    }
+    return true;
+}
+
+bool ShapeCache::TryOpenArchive(std::wstring const& archivePath)
+{
+    StartupSpan span("OpenArchive");
+    auto start = std::chrono::steady_clock::now();
+    if (!m_archiveFile.Open(archivePath))
+    {
+        OutputDebugStringW(L"No card face archive, loading the SVG files instead\n");
+        return false;
+    }
+
+    std::string error;
+    if (!m_archiveReader.Open(m_archiveFile.Data(), m_archiveFile.Size(), error))
+    {
+        std::wstringstream stringStream;
+        stringStream << L"Ignoring card face archive: " << winrt::to_hstring(error).c_str() << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+        m_archiveFile.Close();
+        return false;
+    }
+    // Hashing all 8 MB up front would hold up every face, so the workers
+    // check each one as they read it (see LoadCardFacesWorkerAsync)
+    for (auto i = 0u; i < AssetArchive::CardCount; i++)
+    {
+        std::string_view contents;
+        if (!m_archiveReader.TryGet(i, contents))
+        {
+            OutputDebugStringW(L"Card face archive is incomplete, loading the SVG files instead\n");
+            m_archiveReader = {};
+            m_archiveFile.Close();
+            return false;
+        }
+    }
+    m_openTime = MillisecondsSince(start);
+    return true;
+}
+
+void ShapeCache::StartLoadingCardFaces()
+{
+    {
+        std::lock_guard lock(m_lock);
+        if (m_loadingStarted || !m_sourcesOpen || !m_loadingRequested)
+        {
+            return;
+        }
+        m_loadingStarted = true;
+        m_numWorkers = m_useBundle ? 1 : std::min(std::max(std::thread::hardware_concurrency(), 1u), MaxCardFaceLoadWorkers);
+    }
+
+    // The workers keep the cache alive until every face is in
+    for (auto i = 0u; i < m_numWorkers; i++)
+    {
+        LoadCardFacesWorkerAsync(shared_from_this());
+    }
+}
+
+bool ShapeCache::TryReadCachedCardFace(
+    uint64_t key,
+    MappedFile& file,
+    CardGeometry::DocumentView& document,
+    CardFaceLoadTiming& timing)
+{
+    if (m_diskCachePath.empty())
+    {
+        return false;
+    }
+
+    SpanRecorder::Scope span(StartupTrace(), "ReadCache", winrt::to_string(timing.FileName));
+    auto start = std::chrono::steady_clock::now();
+    auto result = DiskCacheResult::Hit;
+    std::string error;
+    if (!file.Open(m_diskCachePath + L"\\" + winrt::to_hstring(GeometryCache::EntryFileName(key)).c_str()))
+    {
+        result = DiskCacheResult::Miss;
+    }
+    else if (!GeometryCache::TryReadEntry(file.Data(), file.Size(), key, document, error))
+    {
+        std::wstringstream stringStream;
+        stringStream << L"Replacing cached " << timing.FileName.c_str() << L": " << winrt::to_hstring(error).c_str() << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+        file.Close();
+        result = DiskCacheResult::Replaced;
+    }
+    timing.DiskCache = std::max(timing.DiskCache, result);
+    timing.ParseTime += MillisecondsSince(start);
+    return result == DiskCacheResult::Hit;
+}
+
+void ShapeCache::StoreCachedCardFace(uint64_t key, CardGeometry::Document const& document)
+{
+    if (m_diskCachePath.empty())
+    {
+        return;
+    }
+
+    auto path = m_diskCachePath + L"\\" + winrt::to_hstring(GeometryCache::EntryFileName(key)).c_str();
+    if (!WriteFileReplacing(path, GeometryCache::SerializeEntry(key, document)))
+    {
+        // Not worth failing over, it gets converted again next time
+        OutputDebugStringW(L"Couldn't write to the card face cache\n");
+    }
+}
+
+bool ShapeCache::TryClaimCardFace(Card& card)
+{
+    std::lock_guard lock(m_lock);
+    CardFaceSlot* next = nullptr;
+    for (auto& [key, slot] : m_cardFaces)
+    {
+        if (slot.Claimed)
+        {
+            continue;
+        }
+        if (next == nullptr ||
+            slot.Priority < next->Priority ||
+            (slot.Priority == next->Priority && slot.Order < next->Order))
+        {
+            next = &slot;
+            card = key;
+        }
+    }
+    if (next == nullptr)
+    {
+        return false;
+    }
+    next->Claimed = true;
+    return true;
+}
+
+void ShapeCache::CompleteCardFace(
+    Card const& card,
+    std::vector<CardGeometry::DocumentView> const& levels,
+    CardFaceLoadTiming const& timing)
+{
+    // The face is built into these first, m_lock is only taken to swap
+    // it in. A court card takes a while to convert, and GetCardFace (on
+    // the UI thread) and TryClaimCardFace shouldn't wait for it.
+    std::lock_guard conversionLock(m_conversionLock);
+    SpanRecorder::Scope span(StartupTrace(), m_atlas ? "Rasterize" : "Convert", winrt::to_string(timing.FileName));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<CardGeometry::DocumentView> documents;
+    std::vector<CardGeometry::Document> ownedDocuments;
+    SvgCompositionShapes shapes;
+    ShapeCounts counts;
+    if (m_atlas)
+    {
+        // Converting is drawing the face into the atlas, which only
+        // needs the full detail one. The atlas has its own lock.
+        m_atlas->SetFace(card, levels[0]);
+    }
+    else
+    {
+        // Only the level shown is converted now, the others wait for
+        // SwitchDetailLevel. The bundle stays mapped, anything else is
+        // gone once this returns and has to be copied.
+        if (m_useBundle)
+        {
+            documents = levels;
+        }
+        else
+        {
+            for (auto& document : levels)
+            {
+                ownedDocuments.push_back(CopyDocument(document));
+            }
+            for (auto& document : ownedDocuments)
+            {
+                documents.push_back(document.View());
+            }
+        }
+        shapes = SvgShapesBuilder::ConvertGeometryToCompositionShapes(
+            m_compositor, m_d2dFactory, m_levelResources[m_detailLevel], documents[m_detailLevel], counts);
+    }
+    if (m_publishSharedGeometry)
+    {
+        std::string name = AssetArchive::CardAssetName(GetCardId(card));
+        for (auto level = 0u; level < levels.size(); level++)
+        {
+            // Rasterizing doesn't keep a copy of its own
+            if (level < ownedDocuments.size())
+            {
+                m_sharedGeometryWriter.Add(DetailLevels::EntryName(name, level), ownedDocuments[level]);
+            }
+            else
+            {
+                m_sharedGeometryWriter.Add(DetailLevels::EntryName(name, level), CopyDocument(levels[level]));
+            }
+        }
+    }
+    std::vector<GeometrySimplifier::Counts> levelCounts;
+    for (auto& document : levels)
+    {
+        levelCounts.push_back(GeometrySimplifier::Count(document));
+    }
+
+    auto lastFace = false;
+    {
+        std::lock_guard lock(m_lock);
+        auto& slot = m_cardFaces.at(card);
+        for (auto level = 0u; level < levels.size(); level++)
+        {
+            auto& total = m_detailLevelCounts[level];
+            total.Sprites += levelCounts[level].Sprites;
+            total.Segments += levelCounts[level].Segments;
+            total.Points += levelCounts[level].Points;
+        }
+        if (!m_atlas)
+        {
+            // The views point into the documents' own storage, which
+            // moves with them
+            slot.Documents = std::move(documents);
+            slot.OwnedDocuments = std::move(ownedDocuments);
+            slot.Levels.resize(levels.size());
+            slot.LevelCounts.resize(levels.size());
+            slot.Levels[m_detailLevel] = shapes;
+            slot.LevelCounts[m_detailLevel] = counts;
+            ShowDetailLevel(slot);
+        }
+        slot.Loaded = true;
+        m_loadedCount++;
+
+        auto loadTiming = timing;
+        loadTiming.ConvertTime = MillisecondsSince(start);
+        m_loadTimings.push_back(loadTiming);
+        span.End();
+        lastFace = FinishCardFace(slot);
+    }
+    if (lastFace)
+    {
+        FinishLoading();
+    }
+}
+
+void ShapeCache::FailCardFace(Card const& card, CardFaceLoadTiming const& timing)
+{
+    // The last face to finish reports on the shared resources too
+    std::lock_guard conversionLock(m_conversionLock);
+    auto lastFace = false;
+    {
+        std::lock_guard lock(m_lock);
+        m_failedCount++;
+        m_loadTimings.push_back(timing);
+        m_loadTimings.back().Failed = true;
+        lastFace = FinishCardFace(m_cardFaces.at(card));
+    }
+    if (lastFace)
+    {
+        FinishLoading();
+    }
+}
+
+bool ShapeCache::FinishCardFace(CardFaceSlot& slot)
+{
+    slot.Finished = true;
+    auto finished = m_loadedCount + m_failedCount;
+    if (slot.Priority == CardFacePriority::Visible && --m_visiblePending == 0)
+    {
+        std::wstringstream stringStream;
+        stringStream << L"Visible card faces ready " << MillisecondsSince(m_startTime)
+            << L" ms after startup, " << m_loadedCount << L" of " << m_cardFaces.size() << L" faces loaded" << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+    }
+    return finished == m_cardFaces.size();
+}
+
+void ShapeCache::FinishLoading()
+{
+    // Nothing more is coming, whether or not every face made it, so
+    // nothing else touches the timings or the sources any more
+    MarkCardFacesLoaded();
+    ReportLoadTimings();
+    if (m_publishSharedGeometry && m_failedCount == 0)
+    {
+        PublishSharedGeometry();
+    }
+    m_sharedGeometryWriter = {};
+    m_archiveReader = {};
+    m_archiveFile.Close();
+    // The atlas has drawn everything it needs, the faces' levels are
+    // still converted from the bundle
+    if (m_atlas)
+    {
+        m_bundleReader = {};
+        m_bundleFile.Close();
+    }
+}
+
+void ShapeCache::ShowDetailLevel(CardFaceSlot& slot)
+{
+    auto& shapeInfo = slot.Levels[m_detailLevel];
+    // The placeholder was drawn in card coordinates, which is what a
+    // face without a view box is drawn in too
+    if (shapeInfo.ViewBox)
+    {
+        slot.Shapes.ViewBox.Offset(shapeInfo.ViewBox.Offset());
+        slot.Shapes.ViewBox.Size(shapeInfo.ViewBox.Size());
+    }
+    auto shapes = slot.Shapes.RootShape.Shapes();
+    shapes.Clear();
+    shapes.Append(shapeInfo.RootShape);
+}
+
+winrt::IAsyncAction ShapeCache::SwitchDetailLevelWorkerAsync(
+    std::shared_ptr<ShapeCache> cache)
+{
+    co_await winrt::resume_background();
+    cache->SwitchDetailLevel();
+}
+
+void ShapeCache::SwitchDetailLevel()
+{
+    // Faces that finish loading wait for this, and pick up the new level
+    // once it's done
+    std::lock_guard conversionLock(m_conversionLock);
+    while (true)
+    {
+        uint32_t level = 0;
+        std::vector<std::pair<Card, CardGeometry::DocumentView>> pending;
+        {
+            std::lock_guard lock(m_lock);
+            level = m_requestedDetailLevel;
+            if (level == m_detailLevel)
+            {
+                m_switchingDetailLevel = false;
+                return;
+            }
+            for (auto& [card, slot] : m_cardFaces)
+            {
+                if (slot.Loaded && !slot.Levels[level].RootShape)
+                {
+                    pending.emplace_back(card, slot.Documents[level]);
+                }
+            }
+        }
+
+        // Every face is built before any of them is swapped, so that they
+        // change level together
+        auto start = std::chrono::steady_clock::now();
+        std::vector<SvgCompositionShapes> shapes(pending.size());
+        std::vector<ShapeCounts> counts(pending.size());
+        for (auto i = 0u; i < pending.size(); i++)
+        {
+            shapes[i] = SvgShapesBuilder::ConvertGeometryToCompositionShapes(
+                m_compositor, m_d2dFactory, m_levelResources[level], pending[i].second, counts[i]);
+        }
+
+        std::lock_guard lock(m_lock);
+        for (auto i = 0u; i < pending.size(); i++)
+        {
+            auto& slot = m_cardFaces.at(pending[i].first);
+            slot.Levels[level] = shapes[i];
+            slot.LevelCounts[level] = counts[i];
+        }
+        // The board was resized again while these were built, the ones
+        // that aren't needed go when that level is swapped in
+        if (m_requestedDetailLevel != level)
+        {
+            continue;
+        }
+
+        m_previousDetailLevel = m_detailLevel;
+        m_detailLevel = level;
+        m_detailLevelChanges++;
+        for (auto& [card, slot] : m_cardFaces)
+        {
+            if (slot.Loaded)
+            {
+                ShowDetailLevel(slot);
+            }
+        }
+        for (auto other = 0u; other < DetailLevels::Count; other++)
+        {
+            if (other != m_detailLevel && other != m_previousDetailLevel)
+            {
+                ReleaseDetailLevel(other);
+            }
+        }
+
+        std::wstringstream stringStream;
+        stringStream << L"Card faces at detail level " << level << L": " << m_detailLevelCounts[level].Sprites << L" sprites, "
+            << m_detailLevelCounts[level].Segments << L" segments in the " << m_loadedCount << L" faces loaded, "
+            << pending.size() << L" converted in " << MillisecondsSince(start) << L" ms" << std::endl;
+        Debug::OutputDebugStringStream(stringStream);
+    }
+}
+
+void ShapeCache::ReleaseDetailLevel(uint32_t level)
+{
+    for (auto& [card, slot] : m_cardFaces)
+    {
+        if (slot.Loaded)
+        {
+            slot.Levels[level] = {};
+            slot.LevelCounts[level] = {};
+        }
+    }
+    m_levelResources[level] = {};
+}
+
+void ShapeCache::PublishSharedGeometry()
+{
+    auto start = std::chrono::steady_clock::now();
+    // The segment's name covers the versions, there's no source to hash
+    auto data = m_sharedGeometryWriter.Serialize(0);
+    m_sharedGeometryWriter = {};
+    m_publishSharedGeometry = false;
+
+    std::wstringstream stringStream;
+    if (m_sharedGeometry.Publish(SharedGeometry::SegmentName(), data.data(), data.size()))
+    {
+        stringStream << L"Shared " << data.size() << L" bytes of card faces with later instances in " << MillisecondsSince(start) << L" ms" << std::endl;
+    }
+    else
+    {
+        // Not worth failing over, the next instance converts them too
+        stringStream << L"Couldn't share the card faces, another instance might have got there first" << std::endl;
+    }
+    Debug::OutputDebugStringStream(stringStream);
+}
+
+void ShapeCache::ReportLoadTimings()
+{
+    // Report the slowest assets first
+    std::sort(m_loadTimings.begin(), m_loadTimings.end(), [](auto const& left, auto const& right)
+        {
+            return left.TotalTime() > right.TotalTime();
+        });
+
+    std::wstringstream stringStream;
+    stringStream << L"Card face load times (ms), ";
+    if (m_useSharedGeometry)
+    {
+        stringStream << L"shared by another instance, " << m_sharedGeometry.Size() << L" bytes mapped and validated in " << m_openTime << L" ms";
+    }
+    else if (m_useBundle)
+    {
+        stringStream << CardFacesBundleFileName << L", " << m_bundleFile.Size() << L" bytes mapped and validated in " << m_openTime << L" ms";
+    }
+    else if (m_useArchive)
+    {
+        stringStream << CardFacesArchiveFileName << L", " << m_archiveFile.Size() << L" bytes mapped and validated in " << m_openTime << L" ms, " << m_numWorkers << L" workers";
+    }
+    else
+    {
+        stringStream << m_numWorkers << L" workers";
+    }
+    stringStream << L", all loaded " << MillisecondsSince(m_startTime) << L" ms after startup:" << std::endl;
+    size_t cacheResults[4] = {};
+    for (auto& timing : m_loadTimings)
+    {
+        stringStream << L"    " << timing.FileName.c_str()
+            << L" (" << timing.FileSize << L" bytes): read " << timing.ReadTime
+            << L", parse " << timing.ParseTime
+            << L", convert " << timing.ConvertTime
+            << (timing.DiskCache == DiskCacheResult::Hit ? L" (cached)" : L"")
+            << (timing.Failed ? L" (failed)" : L"") << std::endl;
+        cacheResults[static_cast<size_t>(timing.DiskCache)]++;
+    }
+    if (!m_diskCachePath.empty())
+    {
+        auto hits = cacheResults[static_cast<size_t>(DiskCacheResult::Hit)];
+        auto lookups = hits + cacheResults[static_cast<size_t>(DiskCacheResult::Miss)] + cacheResults[static_cast<size_t>(DiskCacheResult::Replaced)];
+        stringStream << L"Disk cache: " << hits << L" hits, "
+            << cacheResults[static_cast<size_t>(DiskCacheResult::Miss)] << L" misses, "
+            << cacheResults[static_cast<size_t>(DiskCacheResult::Replaced)] << L" replaced ("
+            << (lookups > 0 ? 100.0 * hits / lookups : 0.0) << L"% hit rate)" << std::endl;
+    }
+    if (m_failedCount > 0)
+    {
+        stringStream << m_failedCount << L" faces failed to load and kept their placeholders" << std::endl;
+    }
+    for (auto level = 0u; level < DetailLevelCount(); level++)
+    {
+        stringStream << L"Detail level " << level << L": " << m_detailLevelCounts[level].Sprites << L" sprites, "
+            << m_detailLevelCounts[level].Segments << L" segments" << (level == m_detailLevel ? L" (shown)" : L"") << std::endl;
+    }
+    auto& resources = m_levelResources[m_detailLevel];
+    stringStream << L"Shared geometry: " << resources.Geometry.size()
+        << L" created for " << resources.Ids.GeometryRequested << L" sprites at the level shown" << std::endl;
+    stringStream << L"Shared brushes: " << resources.Brushes.size()
+        << L" created of " << resources.Ids.BrushesRequested << L" requested at the level shown" << std::endl;
+    Debug::OutputDebugStringStream(stringStream);
+}
+
+winrt::IAsyncAction ShapeCache::LoadCardFacesWorkerAsync(
+    std::shared_ptr<ShapeCache> cache)
+{
+    co_await winrt::resume_background();
+
+    // Claiming the next face each time (instead of splitting the cards up
+    // front) lets a late call to PrioritizeCardFaces jump the queue
+    Card card;
+    while (cache->TryClaimCardFace(card))
+    {
+        CardFaceLoadTiming timing = {};
+        timing.Card = card;
+        timing.FileName = GetSvgFileName(card);
+
+        auto levelCount = cache->DetailLevelCount();
+        std::vector<CardGeometry::DocumentView> levels(levelCount);
+
+        // Level 0 was checked when the bundle was opened, a bundle built
+        // before the other levels existed falls back to the level above
+        if (cache->m_useBundle)
+        {
+            std::string name = AssetArchive::CardAssetName(GetCardId(card));
+            for (auto level = 0u; level < levelCount; level++)
+            {
+                if (!cache->m_bundleReader.TryFind(DetailLevels::EntryName(name, level).c_str(), levels[level]))
+                {
+                    levels[level] = levels[level - 1];
+                }
+            }
+            cache->CompleteCardFace(card, levels, timing);
+            continue;
+        }
+
+        // The archive is mapped, so its files never need reading
+        auto start = std::chrono::steady_clock::now();
+        auto fileName = winrt::to_string(timing.FileName);
+        SpanRecorder::Scope readSpan(StartupTrace(), "Read", fileName);
+        std::string_view contents;
+        winrt::IBuffer buffer{ nullptr };
+        auto failed = false;
+        auto fromArchive = false;
+        if (cache->m_useArchive)
+        {
+            // Hashing a face is a fraction of parsing it. A face that
+            // doesn't match comes from the folder, the archive has no
+            // other copy.
+            auto cardId = GetCardId(card);
+            fromArchive = cache->m_archiveReader.TryGet(cardId, contents) && cache->m_archiveReader.VerifyEntry(cardId);
+            if (!fromArchive)
+            {
+                std::wstringstream stringStream;
+                stringStream << L"Card face archive has a bad copy of " << timing.FileName.c_str() << L", reading the SVG file instead" << std::endl;
+                Debug::OutputDebugStringStream(stringStream);
+                contents = {};
+            }
+        }
+        if (!fromArchive)
+        {
+            try
+            {
+                auto folder = cache->m_cardFacesFolder;
+                if (!folder)
+                {
+                    folder = co_await cache->m_assetsFolder.GetFolderAsync(L"CardFaces");
+                }
+                auto file = co_await folder.GetFileAsync(timing.FileName);
+                buffer = co_await winrt::FileIO::ReadBufferAsync(file);
+                contents = { reinterpret_cast<char const*>(buffer.data()), buffer.Length() };
+            }
+            catch (winrt::hresult_error const& error)
+            {
+                std::wstringstream stringStream;
+                stringStream << L"Failed to read " << timing.FileName.c_str() << L": " << error.message().c_str() << std::endl;
+                Debug::OutputDebugStringStream(stringStream);
+                failed = true;
+            }
+        }
+        readSpan.End();
+        timing.FileSize = contents.size();
+        timing.ReadTime = MillisecondsSince(start);
+        if (failed)
+        {
+            cache->FailCardFace(card, timing);
+            continue;
+        }
+
+        // Same simplification and flattening the bundle gets, so both look the same
+        GeometrySimplifier::Options options;
+        options.TargetWidth = CompositionCard::CardSize.x;
+        options.TargetHeight = CompositionCard::CardSize.y;
+
+        // Converting is deterministic, so an earlier launch's result is
+        // as good as a new one. Each level has its own entry (the
+        // tolerance is part of the key), and the SVG is only converted
+        // if one of them is missing.
+        std::vector<MappedFile> cachedFiles(levelCount);
+        std::vector<CardGeometry::Document> documents(levelCount);
+        CardGeometry::Document converted;
+        auto isConverted = false;
+        for (auto level = 0u; level < levelCount && !failed; level++)
+        {
+            auto levelOptions = DetailLevels::LevelOptions(options, level);
+            auto key = GeometryCache::EntryKey(contents.data(), contents.size(), levelOptions);
+            if (cache->TryReadCachedCardFace(key, cachedFiles[level], levels[level], timing))
+            {
+                continue;
+            }
+
+            start = std::chrono::steady_clock::now();
+            SpanRecorder::Scope parseSpan(StartupTrace(), "Parse", fileName);
+            try
+            {
+                if (!isConverted)
+                {
+                    converted = SvgGeometryConverter::Convert(contents.data(), contents.size());
+                    isConverted = true;
+                }
+                GeometrySimplifier::Stats stats;
+                auto simplified = GeometrySimplifier::Simplify(converted.View(), levelOptions, stats);
+                GeometryFlattener::Stats flattenStats;
+                documents[level] = GeometryFlattener::Flatten(simplified.View(), flattenStats);
+            }
+            catch (std::runtime_error const& error)
+            {
+                // Nobody is waiting on the workers, so the card keeps its
+                // placeholder and the rest still load
+                std::wstringstream stringStream;
+                stringStream << L"Failed to load " << timing.FileName.c_str() << L": " << winrt::to_hstring(error.what()).c_str() << std::endl;
+                Debug::OutputDebugStringStream(stringStream);
+                failed = true;
+                continue;
+            }
+            timing.ParseTime += MillisecondsSince(start);
+            parseSpan.End();
+
+            cache->StoreCachedCardFace(key, documents[level]);
+            levels[level] = documents[level].View();
+        }
+        if (failed)
+        {
+            cache->FailCardFace(card, timing);
+            continue;
+        }
+        // The views point into the cached files and the documents, which
+        // outlive the conversion
+        cache->CompleteCardFace(card, levels, timing);
+    }
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point const& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool WriteFileReplacing(std::wstring const& path, std::vector<uint8_t> const& data)
+{
+    // Written next to the entry and moved over it, so a reader never sees
+    // half of a file
+    auto tempPath = path + L"." + std::to_wstring(GetCurrentThreadId()) + L".tmp";
+    {
+        wil::unique_hfile file(CreateFile2(tempPath.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr));
+        if (!file)
+        {
+            return false;
+        }
+        DWORD written = 0;
+        if (!WriteFile(file.get(), data.data(), static_cast<DWORD>(data.size()), &written, nullptr) || written != data.size())
+        {
+            file.reset();
+            DeleteFileW(tempPath.c_str());
+            return false;
+        }
+    }
+    if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        DeleteFileW(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+uint32_t GetCardId(Card const& card)
+{
+    return AssetArchive::CardId(static_cast<uint32_t>(card.Face()), static_cast<uint32_t>(card.Suit()));
+}
+
+std::wstring GetSvgFileName(Card const& card)
+{
+    // The archive, the bundle and the CardFaces folder all use the same names
+    return std::wstring(winrt::to_hstring(AssetArchive::CardAssetName(GetCardId(card)))) + L".svg";
+}
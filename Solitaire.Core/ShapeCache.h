@@ -1,6 +1,12 @@
 #pragma once
 #include "Card.h"
 #include "SvgShapesBuilder.h"
+#include "AssetArchive.h"
+#include "CardFaceAtlas.h"
+#include "DetailLevels.h"
+#include "GeometryBundle.h"
+#include "MappedFile.h"
+#include "SharedGeometry.h"
 
 enum class ShapeType
 {
@@ -8,30 +14,269 @@ enum class ShapeType
     Empty
 };
 
-class ShapeCache
+// Ordered from best to worst, a face with several levels of detail
+// reports the worst of them
+enum class DiskCacheResult
+{
+    // Nothing to cache, the face came from the bundle
+    NotUsed,
+    Hit,
+    Miss,
+    // There was an entry but it couldn't be used
+    Replaced,
+};
+
+struct CardFaceLoadTiming
+{
+    ::Card Card;
+    std::wstring FileName;
+    uint64_t FileSize = 0;
+    // Time spent in each stage, in milliseconds
+    double ReadTime = 0;
+    double ParseTime = 0;
+    double ConvertTime = 0;
+    DiskCacheResult DiskCache = DiskCacheResult::NotUsed;
+    // It was read but couldn't be used, or couldn't be read
+    bool Failed = false;
+
+    double TotalTime() const { return ReadTime + ParseTime + ConvertTime; }
+};
+
+// The order card faces are loaded in, earlier values load first
+enum class CardFacePriority
+{
+    // Face up on the board
+    Visible,
+    // Could be turned over by the next move
+    NextReveal,
+    Background,
+};
+
+// Everything ShapeCache has built, see ShapeCounts
+struct ShapeCacheAccounting
+{
+    // The root and view box GetCardFace hands out, the placeholder and
+    // the levels of detail built so far. Faces drawn into the atlas have
+    // none.
+    std::map<Card, ShapeCounts> CardFaces;
+    ShapeCounts Back;
+    ShapeCounts Empty;
+    // All of the above
+    ShapeCounts Total;
+    size_t LoadedCardFaces = 0;
+};
+
+class ShapeCache : public std::enable_shared_from_this<ShapeCache>
 {
 public:
+    // Completes once the card back, the empty pile and a placeholder for
+    // every card face are ready, and with StartupMode::WaitForAssets once
+    // the faces' source is open too. The faces themselves load in the
+    // background, see PrioritizeCardFaces.
     static std::future<std::shared_ptr<ShapeCache>> CreateAsync(
         winrt::Windows::UI::Composition::Compositor const& compositor,
-        winrt::Windows::Storage::StorageFolder const& assetsFolder);
+        winrt::Windows::Storage::StorageFolder const& assetsFolder,
+        CardFaceRendering rendering,
+        StartupMode startupMode);
     ~ShapeCache() {}
 
     winrt::Windows::UI::Composition::Compositor Compositor() { return m_compositor; }
+    // Shows a blank card until the face has loaded, which then replaces
+    // it in place. Callers don't need to do anything when that happens.
+    // Only for CardFaceRendering::Shapes.
     SvgCompositionShapes GetCardFace(Card const& key);
+    // Where the faces go with CardFaceRendering::Raster, null otherwise
+    std::shared_ptr<CardFaceAtlas> Atlas() { return m_atlas; }
     winrt::Windows::UI::Composition::CompositionShape GetShape(ShapeType shapeType);
     float TextHeight() { return m_textHeight; }
 
+    // The scale the board is shown at. Picks the level of detail the
+    // faces are shown with (see DetailLevels), or the scale the atlas is
+    // drawn at when they're rasterized. A new level is built on a worker
+    // and the faces switch once it's done.
+    void SetDisplayScale(float scale);
+
+    // Moves cards up the load order, a card's priority is never lowered.
+    // Loading starts with the first call (or once the faces' source is
+    // open, if that's later), so the first faces loaded are the ones that
+    // were asked for.
+    void PrioritizeCardFaces(std::vector<Card> const& cards, CardFacePriority priority);
+
+    // A snapshot, faces that are still loading only count their
+    // placeholder so far
+    ShapeCacheAccounting GetAccounting();
+    // The totals, then every face from the most to the least expensive
+    void PrintAccounting(std::wstringstream& stream);
+
     // Workaround for make_shared
     ShapeCache() {}
 
 private:
+    struct CardFaceSlot
+    {
+        // What GetCardFace hands out, the view box and the contents of
+        // the root change when the face is swapped in
+        SvgCompositionShapes Shapes;
+        // One per level of detail once loaded, the root holds one of them.
+        // Only the levels in use are built, the rest are null.
+        std::vector<SvgCompositionShapes> Levels;
+        std::vector<ShapeCounts> LevelCounts;
+        // What the levels are built from, views into the bundle or into
+        // OwnedDocuments
+        std::vector<CardGeometry::DocumentView> Documents;
+        std::vector<CardGeometry::Document> OwnedDocuments;
+        // The placeholder
+        ShapeCounts Counts;
+        CardFacePriority Priority = CardFacePriority::Background;
+        // Cards with the same priority load in the order they were asked for
+        uint32_t Order = 0;
+        bool Claimed = false;
+        bool Loaded = false;
+        // Loaded, or failed and left with its placeholder
+        bool Finished = false;
+    };
+
+    static winrt::Windows::Foundation::IAsyncAction LoadCardFacesWorkerAsync(
+        std::shared_ptr<ShapeCache> cache);
+    static winrt::Windows::Foundation::IAsyncAction OpenSourcesWorkerAsync(
+        std::shared_ptr<ShapeCache> cache,
+        winrt::Windows::Storage::StorageFolder assetsFolder);
+
     winrt::Windows::Foundation::IAsyncAction FillCacheAsync(
         winrt::Windows::UI::Composition::Compositor const& compositor,
+        winrt::Windows::Storage::StorageFolder const& assetsFolder,
+        CardFaceRendering rendering,
+        StartupMode startupMode);
+    // The bundle, archive or folder the faces come from, and the disk cache
+    winrt::Windows::Foundation::IAsyncAction OpenSourcesAsync(
         winrt::Windows::Storage::StorageFolder const& assetsFolder);
 
+    bool TryOpenBundle(
+        winrt::Windows::UI::Composition::Compositor const& compositor,
+        std::wstring const& bundlePath);
+    bool TryOpenSharedGeometry(winrt::Windows::UI::Composition::Compositor const& compositor);
+    // Used by both of the above, the data has to stay mapped for as long
+    // as the faces' levels are converted from it
+    bool TryReadBundle(
+        winrt::Windows::UI::Composition::Compositor const& compositor,
+        uint8_t const* data,
+        size_t size,
+        wchar_t const* source);
+    bool TryOpenArchive(std::wstring const& archivePath);
+
+    void StartLoadingCardFaces();
+    bool TryClaimCardFace(Card& card);
+    // The view points into the file
+    bool TryReadCachedCardFace(
+        uint64_t key,
+        MappedFile& file,
+        CardGeometry::DocumentView& document,
+        CardFaceLoadTiming& timing);
+    void StoreCachedCardFace(uint64_t key, CardGeometry::Document const& document);
+    // Takes every level of detail, or just the first when rasterizing
+    void CompleteCardFace(
+        Card const& card,
+        std::vector<CardGeometry::DocumentView> const& levels,
+        CardFaceLoadTiming const& timing);
+    // Every claimed face ends up here or in CompleteCardFace
+    void FailCardFace(Card const& card, CardFaceLoadTiming const& timing);
+    // Under m_lock, once a face is done either way. Returns true for the
+    // last face, which then calls FinishLoading without m_lock.
+    bool FinishCardFace(CardFaceSlot& slot);
+    // Reports on the load and publishes the faces, under m_conversionLock
+    void FinishLoading();
+    // The level has to be built already
+    void ShowDetailLevel(CardFaceSlot& slot);
+    // Builds the requested level for every loaded face, then swaps them
+    // all in at once. Runs until the requested level stops changing.
+    static winrt::Windows::Foundation::IAsyncAction SwitchDetailLevelWorkerAsync(
+        std::shared_ptr<ShapeCache> cache);
+    void SwitchDetailLevel();
+    // Drops the level's shapes from every face, they're built again if
+    // it's shown later
+    void ReleaseDetailLevel(uint32_t level);
+    void PublishSharedGeometry();
+    uint32_t DetailLevelCount() const { return m_atlas ? 1 : DetailLevels::Count; }
+    void ReportLoadTimings();
+
 private:
-    winrt::Windows::UI::Composition::Compositor m_compositor;
-    std::map<Card, SvgCompositionShapes> m_geometryCache;
+    winrt::Windows::UI::Composition::Compositor m_compositor{ nullptr };
+    winrt::com_ptr<ID2D1Factory1> m_d2dFactory;
     std::map<ShapeType, winrt::Windows::UI::Composition::CompositionShape> m_shapeCache;
+    std::map<ShapeType, ShapeCounts> m_shapeCounts;
     float m_textHeight;
+    // Has its own lock
+    std::shared_ptr<CardFaceAtlas> m_atlas;
+
+    // Where the faces come from, in order of preference. The archive
+    // stays mapped until every face has loaded, and the bundle for as
+    // long as we're around, the levels that aren't shown yet are
+    // converted straight from it (the atlas lets go of it early). With
+    // StartupMode::Progressive these are filled in on another thread,
+    // nothing reads them until m_sourcesOpen is set.
+    MappedFile m_bundleFile;
+    GeometryBundle::Reader m_bundleReader;
+    bool m_useBundle = false;
+    // Faces another instance published (see SharedGeometry), read the
+    // same way as the bundle. The segment stays open for as long as we're
+    // around, so the instances after us can use it too.
+    SharedGeometrySegment m_sharedGeometry;
+    bool m_useSharedGeometry = false;
+    MappedFile m_archiveFile;
+    AssetArchive::Reader m_archiveReader;
+    bool m_useArchive = false;
+    double m_openTime = 0;
+    winrt::Windows::Storage::StorageFolder m_cardFacesFolder{ nullptr };
+    // For faces that don't match their hash in the archive, which are
+    // read from the folder instead
+    winrt::Windows::Storage::StorageFolder m_assetsFolder{ nullptr };
+    // Faces converted from SVG are cached here (see GeometryCache), empty
+    // if there's nowhere to put them
+    std::wstring m_diskCachePath;
+
+    // Converting to composition shapes happens one face at a time under
+    // m_conversionLock, which guards the level resources. The faces are
+    // built into local objects and only swapped in under m_lock, so the
+    // UI thread and the workers claiming faces never wait on a
+    // conversion. Take m_conversionLock first when taking both.
+    std::mutex m_conversionLock;
+    // The faces share geometry and brushes within a level, so that a
+    // level's go when it's released
+    SharedResourceCache m_levelResources[DetailLevels::Count];
+    // Set when nobody has published the faces yet, they're collected here
+    // as they load and published once they all have. The writer is also
+    // guarded by m_conversionLock, copying the faces into it takes a while.
+    bool m_publishSharedGeometry = false;
+    GeometryBundle::Writer m_sharedGeometryWriter;
+
+    // Everything below is shared with the workers and guarded by m_lock.
+    // The detail levels only change under both locks, either one is
+    // enough to read them.
+    std::mutex m_lock;
+    std::map<Card, CardFaceSlot> m_cardFaces;
+    // For the card back, the empty pile and the placeholders, which are
+    // all built before the workers start
+    SharedResourceCache m_sharedResources;
+    std::vector<CardFaceLoadTiming> m_loadTimings;
+    uint32_t m_nextOrder = 0;
+    // Loading starts once both are set
+    bool m_sourcesOpen = false;
+    bool m_loadingRequested = false;
+    bool m_loadingStarted = false;
+    size_t m_loadedCount = 0;
+    size_t m_failedCount = 0;
+    size_t m_visiblePending = 0;
+    uint32_t m_numWorkers = 0;
+    uint32_t m_detailLevel = 0;
+    // Kept built too, so that going back and forth over a boundary
+    // doesn't convert the faces every time
+    uint32_t m_previousDetailLevel = 0;
+    // What SetDisplayScale picked, the faces show m_detailLevel until a
+    // switch has built this one
+    uint32_t m_requestedDetailLevel = 0;
+    bool m_switchingDetailLevel = false;
+    uint32_t m_detailLevelChanges = 0;
+    // What the loaded faces add up to at each level
+    GeometrySimplifier::Counts m_detailLevelCounts[DetailLevels::Count] = {};
+    std::chrono::steady_clock::time_point m_startTime;
 };
\ No newline at end of file
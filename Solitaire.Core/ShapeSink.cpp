@@ -0,0 +1,504 @@
+#include "ShapeSink.h"
+#include <cstring>
+
+using namespace CardGeometry;
+
+namespace
+{
+    const char Magic[4] = { 'S', 'C', 'S', 'S' };
+    // Bump whenever the records change
+    const uint32_t StreamVersion = 1;
+
+    enum class Record : uint8_t
+    {
+        Document,
+        ViewBox,
+        Geometry,
+        Brush,
+        Container,
+        Sprite,
+    };
+
+    uint32_t PointsFor(SegmentType const* segments, uint32_t count)
+    {
+        uint32_t points = 0;
+        for (auto i = 0u; i < count; i++)
+        {
+            switch (segments[i])
+            {
+            case SegmentType::MoveTo:
+            case SegmentType::LineTo:
+                points += 1;
+                break;
+            case SegmentType::CubicTo:
+                points += 3;
+                break;
+            default:
+                break;
+            }
+        }
+        return points;
+    }
+
+    class StreamReader
+    {
+    public:
+        StreamReader(uint8_t const* data, size_t size) : m_data(data), m_size(size) {}
+
+        bool AtEnd() const { return m_position == m_size; }
+        // Checked before sizing anything from a count in the stream
+        bool Holds(size_t count, size_t elementSize) const { return count <= (m_size - m_position) / elementSize; }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            return ReadArray(&value, 1);
+        }
+
+        template <typename T>
+        bool ReadArray(T* values, size_t count)
+        {
+            if (count > (m_size - m_position) / sizeof(T))
+            {
+                return false;
+            }
+            if (count == 0)
+            {
+                return true;
+            }
+            memcpy(values, m_data + m_position, count * sizeof(T));
+            m_position += count * sizeof(T);
+            return true;
+        }
+
+    private:
+        uint8_t const* m_data;
+        size_t m_size;
+        size_t m_position = 0;
+    };
+
+    bool Fail(std::string& error, char const* message)
+    {
+        error = message;
+        return false;
+    }
+
+    bool ReadTransform(StreamReader& reader, Matrix& transform, bool& hasTransform)
+    {
+        uint8_t flag = 0;
+        if (!reader.Read(flag))
+        {
+            return false;
+        }
+        hasTransform = flag != 0;
+        return !hasTransform || reader.Read(transform);
+    }
+}
+
+ShapeCounts& ShapeCounts::operator+=(ShapeCounts const& other)
+{
+    ContainerShapes += other.ContainerShapes;
+    SpriteShapes += other.SpriteShapes;
+    PathGeometries += other.PathGeometries;
+    OtherGeometries += other.OtherGeometries;
+    Brushes += other.Brushes;
+    ViewBoxes += other.ViewBoxes;
+    Segments += other.Segments;
+    Points += other.Points;
+    Bytes += other.Bytes;
+    return *this;
+}
+
+namespace ShapeSink
+{
+    void Build(DocumentView const& document, SharedResources& resources, IShapeSink& sink)
+    {
+        sink.BeginDocument();
+        if (document.HasViewBox())
+        {
+            sink.SetViewBox(document.ViewBox);
+        }
+
+        auto getBrush = [&](int32_t brushIndex)
+        {
+            if (brushIndex == NoBrush)
+            {
+                return NoResource;
+            }
+            resources.BrushesRequested++;
+            auto hash = HashBrush(document, brushIndex);
+            auto found = resources.Brushes.find(hash);
+            if (found != resources.Brushes.end())
+            {
+                return found->second;
+            }
+            auto id = sink.CreateBrush(document, brushIndex);
+            resources.Brushes.emplace(hash, id);
+            return id;
+        };
+
+        // Parents always come before their children, so one pass is enough
+        for (auto& node : document.Nodes)
+        {
+            auto transform = (node.Flags & NodeHasTransform) ? &node.Transform : nullptr;
+            if (node.Type == NodeType::Container)
+            {
+                sink.AddContainer(node.Parent, transform);
+                continue;
+            }
+
+            resources.GeometryRequested++;
+            auto hash = HashGeometry(document, node);
+            auto found = resources.Geometry.find(hash);
+            uint32_t geometry = 0;
+            if (found != resources.Geometry.end())
+            {
+                geometry = found->second;
+            }
+            else
+            {
+                geometry = sink.CreateGeometry(document, node);
+                resources.Geometry.emplace(hash, geometry);
+            }
+
+            auto fill = getBrush(node.FillBrush);
+            auto stroke = getBrush(node.StrokeBrush);
+            sink.AddSprite(node.Parent, transform, geometry, fill, stroke, node.StrokeWidth);
+        }
+    }
+
+    bool Replay(uint8_t const* data, size_t size, IShapeSink& sink, std::string& error)
+    {
+        StreamReader reader(data, size);
+        char magic[4] = {};
+        uint32_t version = 0;
+        if (!reader.ReadArray(magic, sizeof(magic)) || !reader.Read(version) || memcmp(magic, Magic, sizeof(Magic)) != 0)
+        {
+            return Fail(error, "Not a shape stream");
+        }
+        if (version != StreamVersion)
+        {
+            return Fail(error, "Unsupported shape stream version");
+        }
+
+        // Ids in the stream are in the order things were created, these
+        // map them to whatever the sink hands back
+        std::vector<uint32_t> geometry;
+        std::vector<uint32_t> brushes;
+        auto inDocument = false;
+        int32_t nodeCount = 0;
+        auto checkNode = [&](int32_t parent)
+        {
+            return inDocument && parent >= NoParent && parent < nodeCount && (parent != NoParent || nodeCount == 0);
+        };
+        auto mapBrush = [&](uint32_t id, uint32_t& mapped)
+        {
+            if (id == NoResource)
+            {
+                mapped = NoResource;
+                return true;
+            }
+            if (id >= brushes.size())
+            {
+                return false;
+            }
+            mapped = brushes[id];
+            return true;
+        };
+
+        std::vector<SegmentType> segments;
+        std::vector<Point> points;
+        std::vector<GradientStop> stops;
+        while (!reader.AtEnd())
+        {
+            Record record;
+            if (!reader.Read(record))
+            {
+                return Fail(error, "Truncated record");
+            }
+            switch (record)
+            {
+            case Record::Document:
+                inDocument = true;
+                nodeCount = 0;
+                sink.BeginDocument();
+                break;
+            case Record::ViewBox:
+            {
+                ViewBox viewBox;
+                if (!inDocument || nodeCount != 0 || !reader.Read(viewBox))
+                {
+                    return Fail(error, "Bad view box");
+                }
+                sink.SetViewBox(viewBox);
+                break;
+            }
+            case Record::Geometry:
+            {
+                Node node = {};
+                uint32_t segmentCount = 0;
+                uint32_t pointCount = 0;
+                if (!reader.Read(node.Type) || !reader.ReadArray(node.Params, 6) ||
+                    !reader.Read(segmentCount) || !reader.Read(pointCount) ||
+                    node.Type == NodeType::Container || node.Type > NodeType::Ellipse)
+                {
+                    return Fail(error, "Bad geometry");
+                }
+                if (!reader.Holds(segmentCount, sizeof(SegmentType)) || !reader.Holds(pointCount, sizeof(Point)))
+                {
+                    return Fail(error, "Truncated geometry");
+                }
+                segments.resize(segmentCount);
+                points.resize(pointCount);
+                if (!reader.ReadArray(segments.data(), segmentCount) || !reader.ReadArray(points.data(), pointCount) ||
+                    PointsFor(segments.data(), segmentCount) != pointCount)
+                {
+                    return Fail(error, "Bad path geometry");
+                }
+                for (auto segment : segments)
+                {
+                    if (segment > SegmentType::Close)
+                    {
+                        return Fail(error, "Bad path segment");
+                    }
+                }
+                node.Parent = NoParent;
+                node.FillBrush = NoBrush;
+                node.StrokeBrush = NoBrush;
+                node.SegmentCount = segmentCount;
+                node.PointCount = pointCount;
+                DocumentView document;
+                document.Nodes = { &node, 1 };
+                document.Segments = { segments.data(), segments.size() };
+                document.Points = { points.data(), points.size() };
+                geometry.push_back(sink.CreateGeometry(document, node));
+                break;
+            }
+            case Record::Brush:
+            {
+                Brush brush = {};
+                if (!reader.Read(brush.Type) || !reader.Read(brush.Color) || !reader.Read(brush.StopCount) ||
+                    brush.Type > BrushType::LinearGradient)
+                {
+                    return Fail(error, "Bad brush");
+                }
+                if (!reader.Holds(brush.StopCount, sizeof(GradientStop)))
+                {
+                    return Fail(error, "Truncated gradient stops");
+                }
+                stops.resize(brush.StopCount);
+                if (!reader.ReadArray(stops.data(), stops.size()))
+                {
+                    return Fail(error, "Bad gradient stops");
+                }
+                DocumentView document;
+                document.Brushes = { &brush, 1 };
+                document.Stops = { stops.data(), stops.size() };
+                brushes.push_back(sink.CreateBrush(document, 0));
+                break;
+            }
+            case Record::Container:
+            {
+                int32_t parent = 0;
+                Matrix transform;
+                auto hasTransform = false;
+                if (!reader.Read(parent) || !ReadTransform(reader, transform, hasTransform) || !checkNode(parent))
+                {
+                    return Fail(error, "Bad container");
+                }
+                sink.AddContainer(parent, hasTransform ? &transform : nullptr);
+                nodeCount++;
+                break;
+            }
+            case Record::Sprite:
+            {
+                int32_t parent = 0;
+                Matrix transform;
+                auto hasTransform = false;
+                uint32_t geometryId = 0;
+                uint32_t fill = 0;
+                uint32_t stroke = 0;
+                float strokeWidth = 0;
+                // A sprite can't be the root, shapes go into containers
+                if (!reader.Read(parent) || !ReadTransform(reader, transform, hasTransform) ||
+                    !reader.Read(geometryId) || !reader.Read(fill) || !reader.Read(stroke) || !reader.Read(strokeWidth) ||
+                    !checkNode(parent) || parent == NoParent || geometryId >= geometry.size() ||
+                    !mapBrush(fill, fill) || !mapBrush(stroke, stroke))
+                {
+                    return Fail(error, "Bad sprite");
+                }
+                sink.AddSprite(parent, hasTransform ? &transform : nullptr, geometry[geometryId], fill, stroke, strokeWidth);
+                nodeCount++;
+                break;
+            }
+            default:
+                return Fail(error, "Unknown record");
+            }
+        }
+        return true;
+    }
+}
+
+void CountingShapeSink::BeginDocument()
+{
+    if (m_next != nullptr)
+    {
+        m_next->BeginDocument();
+    }
+}
+
+void CountingShapeSink::SetViewBox(ViewBox const& viewBox)
+{
+    m_counts.ViewBoxes++;
+    m_counts.Bytes += ShapeSink::EstimatedViewBoxBytes;
+    if (m_next != nullptr)
+    {
+        m_next->SetViewBox(viewBox);
+    }
+}
+
+uint32_t CountingShapeSink::CreateGeometry(DocumentView const& document, Node const& node)
+{
+    if (node.Type == NodeType::Path)
+    {
+        m_counts.PathGeometries++;
+        m_counts.Segments += node.SegmentCount;
+        m_counts.Points += node.PointCount;
+        m_counts.Bytes += node.SegmentCount * ShapeSink::EstimatedSegmentBytes + node.PointCount * ShapeSink::EstimatedPointBytes;
+    }
+    else
+    {
+        m_counts.OtherGeometries++;
+    }
+    m_counts.Bytes += ShapeSink::EstimatedGeometryBytes;
+    return m_next != nullptr ? m_next->CreateGeometry(document, node) : m_nextGeometry++;
+}
+
+uint32_t CountingShapeSink::CreateBrush(DocumentView const& document, int32_t brushIndex)
+{
+    m_counts.Brushes++;
+    m_counts.Bytes += ShapeSink::EstimatedBrushBytes + document.Brushes[brushIndex].StopCount * ShapeSink::EstimatedGradientStopBytes;
+    return m_next != nullptr ? m_next->CreateBrush(document, brushIndex) : m_nextBrush++;
+}
+
+void CountingShapeSink::AddContainer(int32_t parent, Matrix const* transform)
+{
+    m_counts.ContainerShapes++;
+    m_counts.Bytes += ShapeSink::EstimatedShapeBytes;
+    if (m_next != nullptr)
+    {
+        m_next->AddContainer(parent, transform);
+    }
+}
+
+void CountingShapeSink::AddSprite(
+    int32_t parent,
+    Matrix const* transform,
+    uint32_t geometry,
+    uint32_t fillBrush,
+    uint32_t strokeBrush,
+    float strokeWidth)
+{
+    m_counts.SpriteShapes++;
+    m_counts.Bytes += ShapeSink::EstimatedShapeBytes;
+    if (m_next != nullptr)
+    {
+        m_next->AddSprite(parent, transform, geometry, fillBrush, strokeBrush, strokeWidth);
+    }
+}
+
+template <typename T>
+void SerializingShapeSink::Write(T const& value)
+{
+    WriteArray(&value, 1);
+}
+
+template <typename T>
+void SerializingShapeSink::WriteArray(T const* values, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    auto bytes = reinterpret_cast<uint8_t const*>(values);
+    m_data.insert(m_data.end(), bytes, bytes + count * sizeof(T));
+}
+
+SerializingShapeSink::SerializingShapeSink()
+{
+    WriteArray(Magic, sizeof(Magic));
+    Write(StreamVersion);
+}
+
+void SerializingShapeSink::BeginDocument()
+{
+    Write(Record::Document);
+    m_documents++;
+}
+
+void SerializingShapeSink::SetViewBox(ViewBox const& viewBox)
+{
+    Write(Record::ViewBox);
+    Write(viewBox);
+}
+
+uint32_t SerializingShapeSink::CreateGeometry(DocumentView const& document, Node const& node)
+{
+    Write(Record::Geometry);
+    Write(node.Type);
+    WriteArray(node.Params, 6);
+    auto isPath = node.Type == NodeType::Path;
+    Write(isPath ? node.SegmentCount : 0u);
+    Write(isPath ? node.PointCount : 0u);
+    if (isPath)
+    {
+        WriteArray(document.Segments.Data + node.FirstSegment, node.SegmentCount);
+        WriteArray(document.Points.Data + node.FirstPoint, node.PointCount);
+    }
+    return m_nextGeometry++;
+}
+
+uint32_t SerializingShapeSink::CreateBrush(DocumentView const& document, int32_t brushIndex)
+{
+    auto& brush = document.Brushes[brushIndex];
+    Write(Record::Brush);
+    Write(brush.Type);
+    Write(brush.Color);
+    auto stopCount = brush.Type == BrushType::LinearGradient ? brush.StopCount : 0u;
+    Write(stopCount);
+    WriteArray(document.Stops.Data + brush.FirstStop, stopCount);
+    return m_nextBrush++;
+}
+
+void SerializingShapeSink::AddContainer(int32_t parent, Matrix const* transform)
+{
+    Write(Record::Container);
+    Write(parent);
+    WriteTransform(transform);
+}
+
+void SerializingShapeSink::AddSprite(
+    int32_t parent,
+    Matrix const* transform,
+    uint32_t geometry,
+    uint32_t fillBrush,
+    uint32_t strokeBrush,
+    float strokeWidth)
+{
+    Write(Record::Sprite);
+    Write(parent);
+    WriteTransform(transform);
+    Write(geometry);
+    Write(fillBrush);
+    Write(strokeBrush);
+    Write(strokeWidth);
+}
+
+void SerializingShapeSink::WriteTransform(Matrix const* transform)
+{
+    Write(static_cast<uint8_t>(transform != nullptr ? 1 : 0));
+    if (transform != nullptr)
+    {
+        Write(*transform);
+    }
+}
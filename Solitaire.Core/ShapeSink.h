@@ -0,0 +1,173 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Receives the shapes for a document from ShapeSink::Build. Nodes arrive
+// in document order, parents before their children, and a node is
+// referred to by its index in that order within its document. Geometry
+// and brushes are created before the first sprite that uses them and are
+// referred to by the ids the sink hands back.
+class IShapeSink
+{
+public:
+    virtual ~IShapeSink() {}
+
+    // Before anything else in each document. What was created for earlier
+    // documents can still be used.
+    virtual void BeginDocument() = 0;
+    // Only for documents that have one, before any of the nodes
+    virtual void SetViewBox(CardGeometry::ViewBox const& viewBox) = 0;
+    virtual uint32_t CreateGeometry(CardGeometry::DocumentView const& document, CardGeometry::Node const& node) = 0;
+    virtual uint32_t CreateBrush(CardGeometry::DocumentView const& document, int32_t brushIndex) = 0;
+    // The transform is null when the node doesn't have one
+    virtual void AddContainer(int32_t parent, CardGeometry::Matrix const* transform) = 0;
+    // Either brush can be ShapeSink::NoResource
+    virtual void AddSprite(
+        int32_t parent,
+        CardGeometry::Matrix const* transform,
+        uint32_t geometry,
+        uint32_t fillBrush,
+        uint32_t strokeBrush,
+        float strokeWidth) = 0;
+};
+
+// What a sink was asked to create. Only the first document to use a piece
+// of shared geometry or a brush pays for it.
+struct ShapeCounts
+{
+    size_t ContainerShapes = 0;
+    size_t SpriteShapes = 0;
+    size_t PathGeometries = 0;
+    // Rectangles, rounded rectangles and ellipses
+    size_t OtherGeometries = 0;
+    size_t Brushes = 0;
+    size_t ViewBoxes = 0;
+    // Held by the path geometries
+    size_t Segments = 0;
+    size_t Points = 0;
+    // What it would take as composition objects, which don't say what
+    // they cost, so this is an estimate (see ShapeSink::Estimated*). Good
+    // for budgets and for comparing one set of assets with another, not
+    // much else.
+    size_t Bytes = 0;
+
+    ShapeCounts& operator+=(ShapeCounts const& other);
+};
+
+namespace ShapeSink
+{
+    const uint32_t NoResource = UINT32_MAX;
+
+    // Ballpark sizes for ShapeCounts::Bytes: each composition object has
+    // a proxy in the app and its counterpart in the compositor, and path
+    // geometry keeps its points in a D2D geometry as well
+    const size_t EstimatedShapeBytes = 256;
+    const size_t EstimatedGeometryBytes = 192;
+    const size_t EstimatedBrushBytes = 160;
+    const size_t EstimatedGradientStopBytes = 96;
+    const size_t EstimatedViewBoxBytes = 128;
+    const size_t EstimatedSegmentBytes = 4;
+    const size_t EstimatedPointBytes = sizeof(CardGeometry::Point);
+
+    // Sprites with the same geometry (see CardGeometry::HashGeometry) or
+    // the same brush (CardGeometry::HashBrush) share what the sink created
+    // for the first of them, across every document built into that sink.
+    // Ids only mean something to the sink that made them, so keep one of
+    // these per sink.
+    struct SharedResources
+    {
+        std::unordered_map<uint64_t, uint32_t> Geometry;
+        std::unordered_map<uint64_t, uint32_t> Brushes;
+        // How many times each was asked for, the maps hold what was created
+        size_t GeometryRequested = 0;
+        size_t BrushesRequested = 0;
+    };
+
+    // Walks the document once and hands every node to the sink. A 64-bit
+    // hash is plenty for the few hundred paths we have.
+    void Build(CardGeometry::DocumentView const& document, SharedResources& resources, IShapeSink& sink);
+
+    // Feeds what a SerializingShapeSink wrote to another sink, as if the
+    // documents had been built into it directly. Fails on anything that
+    // doesn't look like a stream from this version.
+    bool Replay(uint8_t const* data, size_t size, IShapeSink& sink, std::string& error);
+}
+
+// Counts what it's asked to create (see ShapeCounts), and passes it on to
+// another sink if it's given one. Without one it hands out ids in order.
+class CountingShapeSink : public IShapeSink
+{
+public:
+    CountingShapeSink(IShapeSink* next = nullptr) : m_next(next) {}
+
+    ShapeCounts const& Counts() const { return m_counts; }
+    void Reset() { m_counts = {}; }
+
+    void BeginDocument() override;
+    void SetViewBox(CardGeometry::ViewBox const& viewBox) override;
+    uint32_t CreateGeometry(CardGeometry::DocumentView const& document, CardGeometry::Node const& node) override;
+    uint32_t CreateBrush(CardGeometry::DocumentView const& document, int32_t brushIndex) override;
+    void AddContainer(int32_t parent, CardGeometry::Matrix const* transform) override;
+    void AddSprite(
+        int32_t parent,
+        CardGeometry::Matrix const* transform,
+        uint32_t geometry,
+        uint32_t fillBrush,
+        uint32_t strokeBrush,
+        float strokeWidth) override;
+
+private:
+    IShapeSink* m_next;
+    ShapeCounts m_counts;
+    uint32_t m_nextGeometry = 0;
+    uint32_t m_nextBrush = 0;
+};
+
+// Writes everything it's given to a byte stream that ShapeSink::Replay
+// can play back into any other sink. Geometry and brushes are written
+// once, when they're created, so the stream is as shared as the sink's
+// SharedResources were. Values are in the machine's byte order, the same
+// as the bundle.
+//
+// One stream can hold any number of documents.
+class SerializingShapeSink : public IShapeSink
+{
+public:
+    SerializingShapeSink();
+
+    std::vector<uint8_t> const& Data() const { return m_data; }
+    uint32_t DocumentCount() const { return m_documents; }
+
+    void BeginDocument() override;
+    void SetViewBox(CardGeometry::ViewBox const& viewBox) override;
+    uint32_t CreateGeometry(CardGeometry::DocumentView const& document, CardGeometry::Node const& node) override;
+    uint32_t CreateBrush(CardGeometry::DocumentView const& document, int32_t brushIndex) override;
+    void AddContainer(int32_t parent, CardGeometry::Matrix const* transform) override;
+    void AddSprite(
+        int32_t parent,
+        CardGeometry::Matrix const* transform,
+        uint32_t geometry,
+        uint32_t fillBrush,
+        uint32_t strokeBrush,
+        float strokeWidth) override;
+
+private:
+    template <typename T>
+    void Write(T const& value);
+    template <typename T>
+    void WriteArray(T const* values, size_t count);
+    void WriteTransform(CardGeometry::Matrix const* transform);
+
+private:
+    std::vector<uint8_t> m_data;
+    uint32_t m_nextGeometry = 0;
+    uint32_t m_nextBrush = 0;
+    uint32_t m_documents = 0;
+};
@@ -0,0 +1,292 @@
+#include "SharedGeometry.h"
+#include "GeometryBundle.h"
+#include "GeometryCache.h"
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char SegmentMagic[4] = { 'S', 'C', 'S', 'G' };
+
+// The header is shared with other processes, these two fields are only
+// ever touched through here
+std::atomic<uint32_t>& AtomicField(uint32_t& field)
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+        "The header's atomics have to work across processes");
+    return *reinterpret_cast<std::atomic<uint32_t>*>(&field);
+}
+
+size_t GetPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info = {};
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+namespace SharedGeometry
+{
+    std::string SegmentName()
+    {
+        return "Solitaire.CardFaces." + std::to_string(FormatVersion) + "." +
+            std::to_string(GeometryBundle::FormatVersion) + "." + std::to_string(GeometryCache::ConverterVersion);
+    }
+}
+
+bool SharedGeometrySegment::Open(std::string const& name)
+{
+    Close();
+    if (!OpenMapping(name))
+    {
+        return false;
+    }
+
+    // Nothing past the state is read until it says the data is there
+    auto& header = *m_header;
+    auto valid = m_mappingSize >= sizeof(SharedGeometry::Header) &&
+        AtomicField(header.State).load(std::memory_order_acquire) == static_cast<uint32_t>(SharedGeometry::SegmentState::Published) &&
+        memcmp(header.Magic, SegmentMagic, sizeof(SegmentMagic)) == 0 &&
+        header.Version == SharedGeometry::FormatVersion &&
+        header.DataOffset >= sizeof(SharedGeometry::Header) &&
+        header.DataOffset <= m_mappingSize &&
+        header.DataSize <= m_mappingSize - header.DataOffset;
+    if (valid)
+    {
+        m_data = reinterpret_cast<uint8_t const*>(m_header) + header.DataOffset;
+        m_size = static_cast<size_t>(header.DataSize);
+        valid = ProtectData();
+    }
+    if (!valid)
+    {
+        ReleaseMapping(false);
+        return false;
+    }
+
+    // A count that's already at zero belongs to a segment that's on its
+    // way out, the process that took it there is about to remove it
+    auto& readers = AtomicField(header.Readers);
+    auto count = readers.load(std::memory_order_relaxed);
+    while (count > 0 && !readers.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel))
+    {
+    }
+    if (count == 0)
+    {
+        ReleaseMapping(false);
+        return false;
+    }
+    return true;
+}
+
+bool SharedGeometrySegment::Publish(std::string const& name, uint8_t const* data, size_t size)
+{
+    Close();
+
+    // The data starts on a page of its own, so that it can be made
+    // read-only without the header
+    auto dataOffset = GetPageSize();
+    if (!CreateMapping(name, dataOffset + size))
+    {
+        return false;
+    }
+
+    // A new segment is all zeroes, which is SegmentState::Writing
+    auto& header = *m_header;
+    auto base = reinterpret_cast<uint8_t*>(m_header);
+    memcpy(base + dataOffset, data, size);
+    memcpy(header.Magic, SegmentMagic, sizeof(SegmentMagic));
+    header.Version = SharedGeometry::FormatVersion;
+    header.DataOffset = dataOffset;
+    header.DataSize = size;
+    header.Readers = 1;
+    m_data = base + dataOffset;
+    m_size = size;
+    if (!ProtectData())
+    {
+        ReleaseMapping(true);
+        return false;
+    }
+    AtomicField(header.State).store(static_cast<uint32_t>(SharedGeometry::SegmentState::Published), std::memory_order_release);
+    return true;
+}
+
+void SharedGeometrySegment::Close()
+{
+    if (m_header == nullptr)
+    {
+        return;
+    }
+    auto last = AtomicField(m_header->Readers).fetch_sub(1, std::memory_order_acq_rel) == 1;
+    ReleaseMapping(last);
+}
+
+uint32_t SharedGeometrySegment::ReaderCount() const
+{
+    return m_header != nullptr ? AtomicField(m_header->Readers).load(std::memory_order_relaxed) : 0;
+}
+
+#ifdef _WIN32
+
+bool SharedGeometrySegment::CreateMapping(std::string const& name, size_t size)
+{
+    // Names in the app container's namespace are only seen by the same
+    // app, which is what we want anyway
+    auto path = L"Local\\" + std::wstring(name.begin(), name.end());
+    auto mapping = CreateFileMappingFromApp(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<ULONG64>(size), path.c_str());
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    auto view = MapViewOfFileFromApp(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, size);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_header = static_cast<SharedGeometry::Header*>(view);
+    m_mappingSize = size;
+    return true;
+}
+
+bool SharedGeometrySegment::OpenMapping(std::string const& name)
+{
+    auto path = L"Local\\" + std::wstring(name.begin(), name.end());
+    auto mapping = OpenFileMappingFromApp(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, path.c_str());
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    // The view covers the whole segment, rounded up to a page
+    MEMORY_BASIC_INFORMATION info = {};
+    auto view = MapViewOfFileFromApp(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0);
+    if (view == nullptr || VirtualQuery(view, &info, sizeof(info)) == 0)
+    {
+        if (view != nullptr)
+        {
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_header = static_cast<SharedGeometry::Header*>(view);
+    m_mappingSize = info.RegionSize;
+    return true;
+}
+
+bool SharedGeometrySegment::ProtectData()
+{
+    ULONG oldProtection = 0;
+    return m_size == 0 || VirtualProtectFromApp(const_cast<uint8_t*>(m_data), m_size, PAGE_READONLY, &oldProtection);
+}
+
+void SharedGeometrySegment::ReleaseMapping(bool)
+{
+    // The segment goes with the last handle to it
+    UnmapViewOfFile(m_header);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+    m_header = nullptr;
+    m_mappingSize = 0;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool SharedGeometrySegment::CreateMapping(std::string const& name, size_t size)
+{
+    auto path = "/" + name;
+    auto file = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    void* data = MAP_FAILED;
+    if (ftruncate(file, static_cast<off_t>(size)) == 0)
+    {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    // The mapping keeps the segment open
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    m_name = path;
+    m_header = static_cast<SharedGeometry::Header*>(data);
+    m_mappingSize = size;
+    return true;
+}
+
+bool SharedGeometrySegment::OpenMapping(std::string const& name)
+{
+    auto path = "/" + name;
+    auto file = shm_open(path.c_str(), O_RDWR, 0);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    // Until the process creating it has set its size, it's empty
+    struct stat info = {};
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_name = path;
+    m_header = static_cast<SharedGeometry::Header*>(data);
+    m_mappingSize = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+bool SharedGeometrySegment::ProtectData()
+{
+    return m_size == 0 || mprotect(const_cast<uint8_t*>(m_data), m_size, PROT_READ) == 0;
+}
+
+void SharedGeometrySegment::ReleaseMapping(bool remove)
+{
+    munmap(m_header, m_mappingSize);
+    if (remove)
+    {
+        shm_unlink(m_name.c_str());
+    }
+    m_name.clear();
+    m_header = nullptr;
+    m_mappingSize = 0;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
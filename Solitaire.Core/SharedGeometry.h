@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// NOTE: This file is shared with Solitaire.Tools. It uses the platform's
+// shared memory APIs directly, but has no WinRT dependencies.
+
+// Converted card faces shared between instances of the game running at the
+// same time. The first instance to load its faces publishes them as a
+// GeometryBundle in a named shared memory segment, and the instances after
+// it map that instead of reading and converting the faces again. The pages
+// are the same physical memory in every process.
+//
+//     Header              (the first page, the only part that's writable)
+//     data, DataSize      (at DataOffset, read-only once it's published)
+//
+// The segment's name carries the versions of everything that goes into
+// the data (see SegmentName), so instances from different builds never
+// see each other's segment.
+namespace SharedGeometry
+{
+    const uint32_t FormatVersion = 1;
+
+    enum class SegmentState : uint32_t
+    {
+        Writing,
+        Published,
+    };
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        // A SegmentState, only Published segments can be opened
+        uint32_t State;
+        // How many segments are open on it, across every process
+        uint32_t Readers;
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    // Made from FormatVersion, GeometryBundle::FormatVersion and
+    // GeometryCache::ConverterVersion. Bump FormatVersion if the levels of
+    // detail change, nothing else covers them.
+    std::string SegmentName();
+}
+
+// One process's view of a segment. The data stays mapped until this goes
+// away, and the last one out (in any process) removes the segment, so it
+// lives as long as any instance that uses it.
+//
+// Windows does that last part by itself, the segment goes with its last
+// handle. POSIX shared memory outlives its processes, so there Close
+// removes it once Readers drops to zero. A process that dies without
+// closing leaves its count behind, and the segment stays in /dev/shm
+// until it's removed by hand.
+class SharedGeometrySegment
+{
+public:
+    SharedGeometrySegment() {}
+    ~SharedGeometrySegment() { Close(); }
+    SharedGeometrySegment(SharedGeometrySegment const&) = delete;
+    SharedGeometrySegment& operator=(SharedGeometrySegment const&) = delete;
+
+    // Returns false if there isn't a segment with that name, or it's still
+    // being written or from a different version
+    bool Open(std::string const& name);
+    // Creates the segment and copies the data into it. Returns false if
+    // one with that name already exists (another process got there first)
+    // or it couldn't be created.
+    bool Publish(std::string const& name, uint8_t const* data, size_t size);
+    void Close();
+
+    bool IsOpen() const { return m_header != nullptr; }
+    uint8_t const* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    // Including this one
+    uint32_t ReaderCount() const;
+
+private:
+    // The platform's part, these map the whole segment read-write
+    bool CreateMapping(std::string const& name, size_t size);
+    bool OpenMapping(std::string const& name);
+    bool ProtectData();
+    // Removes the segment too if asked to, where that's up to us
+    void ReleaseMapping(bool remove);
+
+private:
+    SharedGeometry::Header* m_header = nullptr;
+    size_t m_mappingSize = 0;
+    uint8_t const* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#else
+    std::string m_name;
+#endif
+};
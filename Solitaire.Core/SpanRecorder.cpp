@@ -0,0 +1,234 @@
+#include "SpanRecorder.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    void AppendJsonString(std::string& json, std::string const& value)
+    {
+        json += '"';
+        for (auto c : value)
+        {
+            switch (c)
+            {
+            case '"': json += "\\\""; break;
+            case '\\': json += "\\\\"; break;
+            case '\n': json += "\\n"; break;
+            case '\r': json += "\\r"; break;
+            case '\t': json += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8] = {};
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    json += escaped;
+                }
+                else
+                {
+                    json += c;
+                }
+                break;
+            }
+        }
+        json += '"';
+    }
+
+    // Chrome traces are in microseconds
+    void AppendMicroseconds(std::string& json, double milliseconds)
+    {
+        char number[32] = {};
+        snprintf(number, sizeof(number), "%.3f", milliseconds * 1000.0);
+        json += number;
+    }
+}
+
+SpanRecorder::Scope::Scope(SpanRecorder& recorder, char const* name, std::string const& detail)
+{
+    m_recorder = &recorder;
+    m_span = recorder.Begin(name, detail);
+}
+
+void SpanRecorder::Scope::End()
+{
+    if (m_recorder != nullptr)
+    {
+        m_recorder->End(m_span);
+        m_recorder = nullptr;
+    }
+}
+
+SpanRecorder::SpanRecorder()
+{
+    m_epoch = Clock::now();
+}
+
+size_t SpanRecorder::Begin(char const* name, std::string const& detail)
+{
+    auto start = Now();
+    std::lock_guard lock(m_lock);
+    Span span;
+    span.Name = name;
+    span.Detail = detail;
+    span.Thread = GetThreadIndex();
+    auto& open = m_open[span.Thread];
+    span.Depth = static_cast<uint32_t>(open.size());
+    span.Parent = open.empty() ? -1 : static_cast<int32_t>(open.back());
+    span.Start = start;
+    auto index = m_spans.size();
+    m_spans.push_back(std::move(span));
+    open.push_back(index);
+    return index;
+}
+
+void SpanRecorder::End(size_t index)
+{
+    auto end = Now();
+    std::lock_guard lock(m_lock);
+    if (index >= m_spans.size() || m_spans[index].Ended)
+    {
+        return;
+    }
+    auto& span = m_spans[index];
+    span.Duration = end - span.Start;
+    span.Ended = true;
+    // Usually the innermost, but not if a child was never ended
+    auto& open = m_open[span.Thread];
+    open.erase(std::remove(open.begin(), open.end(), index), open.end());
+}
+
+double SpanRecorder::Now() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - m_epoch).count();
+}
+
+std::vector<SpanRecorder::Span> SpanRecorder::Spans() const
+{
+    std::lock_guard lock(m_lock);
+    return m_spans;
+}
+
+std::string SpanRecorder::ToChromeTrace() const
+{
+    auto spans = Spans();
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    auto first = true;
+    std::vector<bool> namedThreads;
+    for (auto& span : spans)
+    {
+        if (span.Thread >= namedThreads.size())
+        {
+            namedThreads.resize(span.Thread + 1, false);
+        }
+        if (!namedThreads[span.Thread])
+        {
+            namedThreads[span.Thread] = true;
+            json += first ? "" : ",";
+            first = false;
+            json += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + std::to_string(span.Thread) + ",\"args\":{\"name\":";
+            AppendJsonString(json, std::to_string(span.Thread) + " " + span.Name);
+            json += "}}";
+        }
+        if (!span.Ended)
+        {
+            continue;
+        }
+        json += first ? "" : ",";
+        first = false;
+        json += "{\"ph\":\"X\",\"cat\":\"startup\",\"pid\":1,\"tid\":" + std::to_string(span.Thread) + ",\"name\":";
+        AppendJsonString(json, span.Name);
+        json += ",\"ts\":";
+        AppendMicroseconds(json, span.Start);
+        json += ",\"dur\":";
+        AppendMicroseconds(json, span.Duration);
+        if (!span.Detail.empty())
+        {
+            json += ",\"args\":{\"detail\":";
+            AppendJsonString(json, span.Detail);
+            json += "}";
+        }
+        json += "}";
+    }
+    json += "]}\n";
+    return json;
+}
+
+std::string SpanRecorder::Summary(char const* title) const
+{
+    struct Total
+    {
+        std::string Name;
+        double Time = 0;
+        size_t Count = 0;
+    };
+
+    auto spans = Spans();
+    std::vector<Total> totals;
+    double end = 0;
+    for (auto& span : spans)
+    {
+        if (!span.Ended)
+        {
+            continue;
+        }
+        end = std::max(end, span.Start + span.Duration);
+
+        // Already counted as part of an enclosing span by the same name
+        auto nested = false;
+        for (auto parent = span.Parent; parent >= 0; parent = spans[parent].Parent)
+        {
+            if (spans[parent].Name == span.Name)
+            {
+                nested = true;
+                break;
+            }
+        }
+        if (nested)
+        {
+            continue;
+        }
+
+        auto total = std::find_if(totals.begin(), totals.end(), [&span](Total const& total)
+            {
+                return total.Name == span.Name;
+            });
+        if (total == totals.end())
+        {
+            totals.push_back({ span.Name });
+            total = totals.end() - 1;
+        }
+        total->Time += span.Duration;
+        total->Count++;
+    }
+
+    char number[64] = {};
+    snprintf(number, sizeof(number), " %.1f ms", end);
+    std::string summary = std::string(title) + number;
+    for (auto i = 0u; i < totals.size(); i++)
+    {
+        auto& total = totals[i];
+        if (total.Count > 1)
+        {
+            snprintf(number, sizeof(number), " %.1f (%zux)", total.Time, total.Count);
+        }
+        else
+        {
+            snprintf(number, sizeof(number), " %.1f", total.Time);
+        }
+        summary += (i == 0 ? ": " : ", ") + total.Name + number;
+    }
+    return summary;
+}
+
+uint32_t SpanRecorder::GetThreadIndex()
+{
+    auto id = std::this_thread::get_id();
+    auto existing = m_threads.find(id);
+    if (existing != m_threads.end())
+    {
+        return existing->second;
+    }
+    auto index = static_cast<uint32_t>(m_threads.size());
+    m_threads.emplace(id, index);
+    m_open.emplace_back();
+    return index;
+}
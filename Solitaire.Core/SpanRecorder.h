@@ -0,0 +1,91 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Records named spans of time, for finding out where startup goes. Spans
+// nest: one that begins while another is open on the same thread is its
+// child. A span can end on a different thread than it began on (which
+// coroutines do all the time), it still belongs to the thread it began on.
+//
+// Times are milliseconds since the recorder was created, from a monotonic
+// clock. The result can be written as a Chrome trace (load it in
+// chrome://tracing or ui.perfetto.dev) or summed up in one line.
+//
+// Safe to use from any thread.
+class SpanRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Span
+    {
+        std::string Name;
+        // Shown with the span, but not part of what it's summed up under,
+        // e.g. which card a span was for
+        std::string Detail;
+        // Small numbers in the order threads were first seen
+        uint32_t Thread = 0;
+        // Zero for spans that began with nothing open on their thread
+        uint32_t Depth = 0;
+        // Index of the enclosing span, -1 for none
+        int32_t Parent = -1;
+        double Start = 0;
+        double Duration = 0;
+        bool Ended = false;
+    };
+
+    // Ends its span when it goes out of scope
+    class Scope
+    {
+    public:
+        Scope(SpanRecorder& recorder, char const* name, std::string const& detail = {});
+        ~Scope() { End(); }
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        // Ends it early, later calls do nothing
+        void End();
+
+    private:
+        SpanRecorder* m_recorder;
+        size_t m_span;
+    };
+
+    SpanRecorder();
+
+    // Returns the span's index, which is what End takes
+    size_t Begin(char const* name, std::string const& detail = {});
+    void End(size_t span);
+
+    double Now() const;
+    // A copy, so that it can be read while spans are still being recorded
+    std::vector<Span> Spans() const;
+
+    // Every span that has ended, as "X" events in the Chrome trace event
+    // format. Threads are named after the first span they recorded.
+    std::string ToChromeTrace() const;
+    // "Startup 812.3 ms: name 12.1, name 300.2 (52x), ..." with the time
+    // summed by name, in the order each name was first seen. Spans nested
+    // under a span with the same name aren't counted twice.
+    std::string Summary(char const* title) const;
+
+private:
+    uint32_t GetThreadIndex();
+
+private:
+    Clock::time_point m_epoch;
+    mutable std::mutex m_lock;
+    std::vector<Span> m_spans;
+    std::map<std::thread::id, uint32_t> m_threads;
+    // The spans open on each thread, innermost last
+    std::vector<std::vector<size_t>> m_open;
+};
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "StartupTrace.h"
+
+const wchar_t* const StartupTraceFileName = L"Solitaire.startup.json";
+
+bool WriteFileReplacing(std::wstring const& path, std::vector<uint8_t> const& data);
+
+SpanRecorder& StartupTrace()
+{
+    // Created by the first span, which the apps begin before anything else
+    static SpanRecorder recorder;
+    return recorder;
+}
+
+// Milliseconds on the trace's clock, negative until they happen
+std::mutex StartupMilestoneLock;
+double FirstFrameTime = -1;
+double CardFacesLoadedTime = -1;
+
+void FinishStartupTrace();
+
+void MarkStartupMilestone(double& time, wchar_t const* description)
+{
+    auto now = StartupTrace().Now();
+    auto finished = false;
+    {
+        std::lock_guard lock(StartupMilestoneLock);
+        if (time >= 0)
+        {
+            return;
+        }
+        time = now;
+        finished = FirstFrameTime >= 0 && CardFacesLoadedTime >= 0;
+    }
+
+    std::wstringstream stringStream;
+    stringStream << description << L" " << now << L" ms after startup" << std::endl;
+    Debug::OutputDebugStringStream(stringStream);
+    if (finished)
+    {
+        FinishStartupTrace();
+    }
+}
+
+void MarkFirstFrame()
+{
+    MarkStartupMilestone(FirstFrameTime, L"First frame");
+}
+
+void MarkCardFacesLoaded()
+{
+    MarkStartupMilestone(CardFacesLoadedTime, L"All card faces loaded");
+}
+
+void FinishStartupTrace()
+{
+    static std::once_flag finished;
+    std::call_once(finished, []()
+        {
+            auto& recorder = StartupTrace();
+            std::wstringstream stringStream;
+            stringStream << winrt::to_hstring(recorder.Summary("Startup")).c_str() << std::endl;
+            stringStream << L"First frame " << FirstFrameTime << L" ms, fully loaded " << CardFacesLoadedTime << L" ms" << std::endl;
+
+            // The temp folder works packaged or not
+            std::wstring path(MAX_PATH + 1, L'\0');
+            path.resize(GetTempPathW(static_cast<DWORD>(path.size()), path.data()));
+            auto trace = recorder.ToChromeTrace();
+            if (!path.empty() && WriteFileReplacing(path + StartupTraceFileName, { trace.begin(), trace.end() }))
+            {
+                stringStream << L"Startup trace written to " << path << StartupTraceFileName << std::endl;
+            }
+            else
+            {
+                stringStream << L"Couldn't write the startup trace" << std::endl;
+            }
+            Debug::OutputDebugStringStream(stringStream);
+        });
+}
+
+StartupSpan::StartupSpan(char const* name)
+{
+    m_span = StartupTrace().Begin(name);
+}
+
+StartupSpan::~StartupSpan()
+{
+    StartupTrace().End(m_span);
+}
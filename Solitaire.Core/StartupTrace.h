@@ -0,0 +1,17 @@
+#pragma once
+#include "SpanRecorder.h"
+
+// Every startup span goes here, StartupSpan (see Solitaire.Core.h) is the
+// way in for the apps. Spans for a particular card go straight to the
+// recorder with the card as their detail.
+SpanRecorder& StartupTrace();
+
+// The two ends of startup, each goes to the debug output when it happens.
+// Once both have, the trace is written to Solitaire.startup.json in the
+// temp folder and the summary to the debug output. Only the first call to
+// each does anything.
+//
+// The first frame with the board in it, see GameApp
+void MarkFirstFrame();
+// Every card face has loaded
+void MarkCardFacesLoaded();
@@ -0,0 +1,294 @@
+#include "SvgAttributes.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using CardGeometry::Color;
+using CardGeometry::Matrix;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    struct NamedColor
+    {
+        char const* Name;
+        CardGeometry::Color Color;
+    };
+
+    // The card faces only ever use hex colors, these are here for
+    // hand-written documents.
+    NamedColor const NamedColors[] =
+    {
+        { "black", { 255, 0, 0, 0 } },
+        { "white", { 255, 255, 255, 255 } },
+        { "red", { 255, 255, 0, 0 } },
+        { "green", { 255, 0, 128, 0 } },
+        { "blue", { 255, 0, 0, 255 } },
+        { "gray", { 255, 128, 128, 128 } },
+        { "grey", { 255, 128, 128, 128 } },
+        { "yellow", { 255, 255, 255, 0 } },
+        { "transparent", { 0, 0, 0, 0 } },
+        { "currentColor", { 255, 0, 0, 0 } },
+    };
+
+    bool IsSeparator(char value)
+    {
+        return value == ' ' || value == ',' || value == '\t' || value == '\r' || value == '\n';
+    }
+
+    int HexDigit(char value)
+    {
+        if (value >= '0' && value <= '9') { return value - '0'; }
+        if (value >= 'a' && value <= 'f') { return value - 'a' + 10; }
+        if (value >= 'A' && value <= 'F') { return value - 'A' + 10; }
+        return -1;
+    }
+
+    // Reads the next number in a list, returns false if there isn't one
+    bool ReadListNumber(std::string_view& list, float& result)
+    {
+        while (!list.empty() && IsSeparator(list.front()))
+        {
+            list.remove_prefix(1);
+        }
+        char buffer[64] = {};
+        auto length = 0u;
+        while (length < list.size() && length < sizeof(buffer) - 1 && !IsSeparator(list[length]) && list[length] != ')')
+        {
+            buffer[length] = list[length];
+            length++;
+        }
+        char* end = nullptr;
+        auto value = strtod(buffer, &end);
+        if (end == buffer)
+        {
+            return false;
+        }
+        list.remove_prefix(end - buffer);
+        result = static_cast<float>(value);
+        return true;
+    }
+}
+
+namespace SvgAttributes
+{
+    std::string_view Trim(std::string_view value)
+    {
+        while (!value.empty() && IsSeparator(value.front()) && value.front() != ',')
+        {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && IsSeparator(value.back()) && value.back() != ',')
+        {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    bool ParseNumber(std::string_view value, float& result)
+    {
+        // Units (px, pt, ...) are ignored
+        value = Trim(value);
+        return ReadListNumber(value, result);
+    }
+
+    bool ParseOffset(std::string_view value, float& result)
+    {
+        value = Trim(value);
+        if (!ParseNumber(value, result))
+        {
+            return false;
+        }
+        if (!value.empty() && value.back() == '%')
+        {
+            result /= 100.0f;
+        }
+        result = result < 0.0f ? 0.0f : (result > 1.0f ? 1.0f : result);
+        return true;
+    }
+
+    bool ParseColor(std::string_view value, Color& result)
+    {
+        value = Trim(value);
+        if (!value.empty() && value.front() == '#')
+        {
+            auto digits = value.substr(1);
+            int values[6] = {};
+            for (auto i = 0u; i < digits.size() && i < 6; i++)
+            {
+                values[i] = HexDigit(digits[i]);
+                if (values[i] < 0)
+                {
+                    return false;
+                }
+            }
+            if (digits.size() == 6)
+            {
+                result = { 255,
+                    static_cast<uint8_t>(values[0] * 16 + values[1]),
+                    static_cast<uint8_t>(values[2] * 16 + values[3]),
+                    static_cast<uint8_t>(values[4] * 16 + values[5]) };
+                return true;
+            }
+            if (digits.size() == 3)
+            {
+                result = { 255,
+                    static_cast<uint8_t>(values[0] * 17),
+                    static_cast<uint8_t>(values[1] * 17),
+                    static_cast<uint8_t>(values[2] * 17) };
+                return true;
+            }
+            return false;
+        }
+
+        if (value.substr(0, 4) == "rgb(" && value.back() == ')')
+        {
+            auto list = value.substr(4, value.size() - 5);
+            float channels[3] = {};
+            for (auto& channel : channels)
+            {
+                if (!ReadListNumber(list, channel))
+                {
+                    return false;
+                }
+                if (!list.empty() && list.front() == '%')
+                {
+                    channel = channel * 255.0f / 100.0f;
+                    list.remove_prefix(1);
+                }
+                channel = channel < 0.0f ? 0.0f : (channel > 255.0f ? 255.0f : channel);
+            }
+            result = { 255,
+                static_cast<uint8_t>(std::lround(channels[0])),
+                static_cast<uint8_t>(std::lround(channels[1])),
+                static_cast<uint8_t>(std::lround(channels[2])) };
+            return true;
+        }
+
+        for (auto& namedColor : NamedColors)
+        {
+            if (value == namedColor.Name)
+            {
+                result = namedColor.Color;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParsePaint(std::string_view value, Paint& result)
+    {
+        value = Trim(value);
+        result = {};
+        if (value == "none")
+        {
+            result.Type = PaintType::None;
+            return true;
+        }
+        if (value.substr(0, 4) == "url(")
+        {
+            auto end = value.find(')');
+            if (end == std::string_view::npos)
+            {
+                return false;
+            }
+            result.Type = PaintType::Url;
+            result.Id = ParseReference(Trim(value.substr(4, end - 4)));
+            return true;
+        }
+        result.Type = PaintType::Color;
+        return ParseColor(value, result.Color);
+    }
+
+    bool ParseTransform(std::string_view value, Matrix& result)
+    {
+        // Each transform in the list applies before the ones to its left
+        auto combined = Matrix::Identity();
+        value = Trim(value);
+        while (!value.empty())
+        {
+            auto open = value.find('(');
+            auto close = value.find(')');
+            if (open == std::string_view::npos || close == std::string_view::npos || close < open)
+            {
+                return false;
+            }
+            auto name = Trim(value.substr(0, open));
+            auto list = value.substr(open + 1, close - open - 1);
+            value = value.substr(close + 1);
+            while (!value.empty() && IsSeparator(value.front()))
+            {
+                value.remove_prefix(1);
+            }
+
+            float args[6] = {};
+            auto count = 0;
+            while (count < 6 && ReadListNumber(list, args[count]))
+            {
+                count++;
+            }
+
+            Matrix transform = Matrix::Identity();
+            if (name == "matrix" && count == 6)
+            {
+                transform = { args[0], args[1], args[2], args[3], args[4], args[5] };
+            }
+            else if (name == "translate" && (count == 1 || count == 2))
+            {
+                transform = Matrix::Translation(args[0], count == 2 ? args[1] : 0.0f);
+            }
+            else if (name == "scale" && (count == 1 || count == 2))
+            {
+                transform.M11 = args[0];
+                transform.M22 = count == 2 ? args[1] : args[0];
+            }
+            else if (name == "rotate" && (count == 1 || count == 3))
+            {
+                auto angle = args[0] * Pi / 180.0;
+                auto cosAngle = static_cast<float>(std::cos(angle));
+                auto sinAngle = static_cast<float>(std::sin(angle));
+                transform = { cosAngle, sinAngle, -sinAngle, cosAngle, 0, 0 };
+                if (count == 3)
+                {
+                    // Rotate around (cx, cy)
+                    transform = CardGeometry::Multiply(Matrix::Translation(-args[1], -args[2]), transform);
+                    transform = CardGeometry::Multiply(transform, Matrix::Translation(args[1], args[2]));
+                }
+            }
+            else if (name == "skewX" && count == 1)
+            {
+                transform.M21 = static_cast<float>(std::tan(args[0] * Pi / 180.0));
+            }
+            else if (name == "skewY" && count == 1)
+            {
+                transform.M12 = static_cast<float>(std::tan(args[0] * Pi / 180.0));
+            }
+            else
+            {
+                return false;
+            }
+            combined = CardGeometry::Multiply(transform, combined);
+        }
+        result = combined;
+        return true;
+    }
+
+    bool ParseViewBox(std::string_view value, CardGeometry::ViewBox& result)
+    {
+        return ReadListNumber(value, result.X) &&
+            ReadListNumber(value, result.Y) &&
+            ReadListNumber(value, result.Width) &&
+            ReadListNumber(value, result.Height);
+    }
+
+    std::string_view ParseReference(std::string_view value)
+    {
+        value = Trim(value);
+        if (!value.empty() && value.front() == '#')
+        {
+            value.remove_prefix(1);
+        }
+        return value;
+    }
+}
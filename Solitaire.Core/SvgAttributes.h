@@ -0,0 +1,56 @@
+#pragma once
+#include <string_view>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Parsers for the attribute values that the card faces use. None of these
+// allocate, and all of them return false if the value can't be parsed.
+namespace SvgAttributes
+{
+    enum class PaintType
+    {
+        None,
+        Color,
+        Url,
+    };
+
+    struct Paint
+    {
+        PaintType Type = PaintType::None;
+        CardGeometry::Color Color = {};
+        // Without the leading '#'
+        std::string_view Id;
+    };
+
+    std::string_view Trim(std::string_view value);
+    bool ParseNumber(std::string_view value, float& result);
+    // Accepts both "0.5" and "50%"
+    bool ParseOffset(std::string_view value, float& result);
+    bool ParseColor(std::string_view value, CardGeometry::Color& result);
+    bool ParsePaint(std::string_view value, Paint& result);
+    bool ParseTransform(std::string_view value, CardGeometry::Matrix& result);
+    bool ParseViewBox(std::string_view value, CardGeometry::ViewBox& result);
+    // "#id" -> "id"
+    std::string_view ParseReference(std::string_view value);
+
+    // Calls callback(name, value) for each "name: value" declaration in a
+    // style attribute.
+    template <typename Callback>
+    void ForEachStyleDeclaration(std::string_view style, Callback&& callback)
+    {
+        while (!style.empty())
+        {
+            auto end = style.find(';');
+            auto declaration = style.substr(0, end);
+            style = end == std::string_view::npos ? std::string_view() : style.substr(end + 1);
+
+            auto colon = declaration.find(':');
+            if (colon != std::string_view::npos)
+            {
+                callback(Trim(declaration.substr(0, colon)), Trim(declaration.substr(colon + 1)));
+            }
+        }
+    }
+}
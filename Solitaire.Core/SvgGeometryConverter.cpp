@@ -0,0 +1,424 @@
+#include "SvgGeometryConverter.h"
+#include "SvgAttributes.h"
+#include "SvgNames.h"
+#include <stdexcept>
+#include <string>
+
+using namespace CardGeometry;
+
+namespace
+{
+    // Guards against references that (eventually) point back at themselves
+    const int MaxReferenceDepth = 32;
+
+    float GetFloat(SvgElementAttributes const& attributes, SvgName name)
+    {
+        auto value = 0.0f;
+        auto attribute = attributes[name];
+        if (!attribute.empty())
+        {
+            SvgAttributes::ParseNumber(attribute, value);
+        }
+        return value;
+    }
+
+    std::string_view GetReference(SvgElementAttributes const& attributes)
+    {
+        auto href = attributes[SvgName::XlinkHref];
+        return SvgAttributes::ParseReference(href.empty() ? attributes[SvgName::Href] : href);
+    }
+
+    // Records where each element with an id starts
+    class ElementIndexer : public ISvgReaderHandler
+    {
+    public:
+        ElementIndexer(std::pmr::map<std::string_view, size_t>& offsets) : m_offsets(offsets) {}
+
+        void OnStartElement(std::string_view, Span<SvgAttribute> attributes, size_t offset) override
+        {
+            // Only the one attribute, no need to intern the rest
+            for (auto& attribute : attributes)
+            {
+                if (attribute.Name == "id" && !attribute.Value.empty())
+                {
+                    m_offsets.emplace(attribute.Value, offset);
+                }
+            }
+        }
+        void OnEndElement(std::string_view) override {}
+
+    private:
+        std::pmr::map<std::string_view, size_t>& m_offsets;
+    };
+
+    // Reads a gradient element: what it is, where it points and its stops
+    class GradientReader : public ISvgReaderHandler
+    {
+    public:
+        SvgName Tag = SvgName::Unknown;
+        std::string_view Reference;
+        std::pmr::vector<GradientStop> Stops;
+
+        GradientReader(std::pmr::memory_resource* resource) : Stops(resource) {}
+
+        void OnStartElement(std::string_view tag, Span<SvgAttribute> attributes, size_t) override
+        {
+            m_depth++;
+            if (m_depth == 1)
+            {
+                Tag = SvgNames::Intern(tag);
+                Reference = GetReference(SvgElementAttributes(attributes));
+            }
+            else if (m_depth == 2 && SvgNames::Intern(tag) == SvgName::Stop)
+            {
+                GradientStop stop = { 0.0f, { 255, 0, 0, 0 } };
+                auto applyStopAttribute = [&](SvgName name, std::string_view value)
+                {
+                    if (name == SvgName::Offset)
+                    {
+                        SvgAttributes::ParseOffset(value, stop.Offset);
+                    }
+                    else if (name == SvgName::StopColor)
+                    {
+                        SvgAttributes::ParseColor(value, stop.Color);
+                    }
+                };
+                // Anything in the style attribute wins
+                SvgElementAttributes values(attributes);
+                applyStopAttribute(SvgName::Offset, values[SvgName::Offset]);
+                applyStopAttribute(SvgName::StopColor, values[SvgName::StopColor]);
+                SvgAttributes::ForEachStyleDeclaration(values[SvgName::Style], [&](auto name, auto value)
+                    {
+                        applyStopAttribute(SvgNames::Intern(name), value);
+                    });
+                Stops.push_back(stop);
+            }
+        }
+        void OnEndElement(std::string_view) override { m_depth--; }
+
+    private:
+        int m_depth = 0;
+    };
+}
+
+Document SvgGeometryConverter::Convert(char const* data, size_t size)
+{
+    SvgGeometryConverter converter(data, size);
+    SvgReader reader(data, size, &converter.m_arena);
+    if (!reader.Read(converter))
+    {
+        throw std::runtime_error(reader.Error() + " at offset " + std::to_string(reader.ErrorOffset()));
+    }
+    return converter.Finish();
+}
+
+SvgGeometryConverter::SvgGeometryConverter(char const* data, size_t size) :
+    m_data(data),
+    m_size(size),
+    m_arena(m_initialArena, sizeof(m_initialArena)),
+    m_segments(&m_arena),
+    m_points(&m_arena),
+    m_frames(&m_arena),
+    m_instances(&m_arena),
+    m_elementOffsets(&m_arena),
+    m_pathTokenizer(&m_arena)
+{
+}
+
+Document SvgGeometryConverter::Finish()
+{
+    m_document.Segments.assign(m_segments.begin(), m_segments.end());
+    m_document.Points.assign(m_points.begin(), m_points.end());
+    return std::move(m_document);
+}
+
+void SvgGeometryConverter::StartRoot(SvgName tag, SvgElementAttributes const& attributes)
+{
+    // Assumption: There is only one "svg" element and it is at the root.
+    if (tag != SvgName::Svg)
+    {
+        throw std::runtime_error("Root element is not svg");
+    }
+
+    auto viewBox = attributes[SvgName::ViewBox];
+    if (!viewBox.empty() && SvgAttributes::ParseViewBox(viewBox, m_document.ViewBox))
+    {
+        m_document.Flags |= DocumentHasViewBox;
+    }
+
+    auto container = m_document.AddContainer(NoParent);
+    Presentation presentation =
+    {
+        m_document.AddColorBrush({ 255, 0, 0, 0 }),
+        // Transparent, same as Colors::Transparent
+        m_document.AddColorBrush({ 0, 255, 255, 255 }),
+        1.0f
+    };
+    m_frames.push_back({ container, presentation });
+}
+
+void SvgGeometryConverter::OnStartElement(
+    std::string_view tagName,
+    Span<SvgAttribute> attributeList,
+    size_t)
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth++;
+        return;
+    }
+    auto tag = SvgNames::Intern(tagName);
+    SvgElementAttributes attributes(attributeList);
+    if (m_document.Nodes.empty())
+    {
+        StartRoot(tag, attributes);
+        return;
+    }
+    if (tag == SvgName::Defs)
+    {
+        m_skipDepth = 1;
+        return;
+    }
+
+    auto current = m_document.AddContainer(m_frames.back().Node);
+    Presentation presentation = m_frames.back().Presentation;
+
+    // General attributes, anything in the style attribute wins
+    auto transform = Matrix::Identity();
+    auto hasTransform = false;
+    if (!attributes[SvgName::Transform].empty())
+    {
+        hasTransform = SvgAttributes::ParseTransform(attributes[SvgName::Transform], transform);
+    }
+    for (auto name : { SvgName::Fill, SvgName::Stroke, SvgName::StrokeWidth })
+    {
+        if (!attributes[name].empty())
+        {
+            ApplyPresentationAttribute(name, attributes[name], presentation);
+        }
+    }
+    SvgAttributes::ForEachStyleDeclaration(attributes[SvgName::Style], [&](auto name, auto value)
+        {
+            ApplyPresentationAttribute(SvgNames::Intern(name), value, presentation);
+        });
+
+    if (tag == SvgName::Use)
+    {
+        // The use element's x and y translate the referenced content
+        auto x = GetFloat(attributes, SvgName::X);
+        auto y = GetFloat(attributes, SvgName::Y);
+        if (x != 0 || y != 0)
+        {
+            transform = Multiply(Matrix::Translation(x, y), transform);
+            hasTransform = true;
+        }
+    }
+    if (hasTransform && !transform.IsIdentity())
+    {
+        auto& node = m_document.Nodes[current];
+        node.Flags |= NodeHasTransform;
+        node.Transform = transform;
+    }
+    m_frames.push_back({ current, presentation });
+
+    // Special cases
+    switch (tag)
+    {
+    case SvgName::Use:
+        AddReference(GetReference(attributes), current, presentation);
+        break;
+    case SvgName::Circle:
+    {
+        auto sprite = m_document.AddSprite(current, NodeType::Ellipse, presentation.Fill, presentation.Stroke, presentation.StrokeWidth);
+        auto radius = GetFloat(attributes, SvgName::R);
+        auto& params = m_document.Nodes[sprite].Params;
+        params[0] = GetFloat(attributes, SvgName::Cx);
+        params[1] = GetFloat(attributes, SvgName::Cy);
+        params[2] = radius;
+        params[3] = radius;
+    }
+        break;
+    case SvgName::Rect:
+    {
+        auto sprite = m_document.AddSprite(current, NodeType::Rectangle, presentation.Fill, presentation.Stroke, presentation.StrokeWidth);
+        auto& params = m_document.Nodes[sprite].Params;
+        params[0] = GetFloat(attributes, SvgName::X);
+        params[1] = GetFloat(attributes, SvgName::Y);
+        params[2] = GetFloat(attributes, SvgName::Width);
+        params[3] = GetFloat(attributes, SvgName::Height);
+    }
+        break;
+    case SvgName::Path:
+    {
+        auto firstSegment = static_cast<uint32_t>(m_segments.size());
+        auto firstPoint = static_cast<uint32_t>(m_points.size());
+        // Keep whatever parsed before an error, same as Direct2D
+        m_pathTokenizer.Parse(attributes[SvgName::D], m_segments, m_points);
+        auto sprite = m_document.AddSprite(current, NodeType::Path, presentation.Fill, presentation.Stroke, presentation.StrokeWidth);
+        auto& node = m_document.Nodes[sprite];
+        node.FirstSegment = firstSegment;
+        node.SegmentCount = static_cast<uint32_t>(m_segments.size()) - firstSegment;
+        node.FirstPoint = firstPoint;
+        node.PointCount = static_cast<uint32_t>(m_points.size()) - firstPoint;
+    }
+        break;
+    default:
+        // Everything else (g, gradients, stops, metadata, ...) is just a container
+        break;
+    }
+}
+
+void SvgGeometryConverter::AddReference(std::string_view id, int32_t parent, Presentation const& presentation)
+{
+    // The referenced element ends up inside of the use element's container
+    size_t offset = 0;
+    if (!TryFindElement(id, offset))
+    {
+        return;
+    }
+    if (m_referenceDepth >= MaxReferenceDepth)
+    {
+        m_truncatedReferences++;
+        return;
+    }
+
+    InstanceKey key = { offset, presentation };
+    auto search = m_instances.find(key);
+    if (search != m_instances.end())
+    {
+        // Same nodes under a new parent, the path data is shared
+        auto instance = search->second;
+        auto firstNode = static_cast<int32_t>(m_document.Nodes.size());
+        for (auto i = 0u; i < instance.NodeCount; i++)
+        {
+            auto node = m_document.Nodes[instance.FirstNode + i];
+            node.Parent = i == 0 ? parent : node.Parent - static_cast<int32_t>(instance.FirstNode) + firstNode;
+            m_document.Nodes.push_back(node);
+        }
+        return;
+    }
+
+    auto firstNode = static_cast<uint32_t>(m_document.Nodes.size());
+    auto truncatedReferences = m_truncatedReferences;
+    m_referenceDepth++;
+    ReadElement(offset, *this);
+    m_referenceDepth--;
+    if (truncatedReferences == m_truncatedReferences)
+    {
+        m_instances.emplace(key, Instance{ firstNode, static_cast<uint32_t>(m_document.Nodes.size()) - firstNode });
+    }
+}
+
+void SvgGeometryConverter::OnEndElement(std::string_view)
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth--;
+        return;
+    }
+    m_frames.pop_back();
+}
+
+void SvgGeometryConverter::ApplyPresentationAttribute(
+    SvgName name,
+    std::string_view value,
+    Presentation& presentation)
+{
+    switch (name)
+    {
+    case SvgName::Fill:
+        presentation.Fill = GetBrush(value, presentation.Fill);
+        break;
+    case SvgName::Stroke:
+        presentation.Stroke = GetBrush(value, presentation.Stroke);
+        break;
+    case SvgName::StrokeWidth:
+        SvgAttributes::ParseNumber(value, presentation.StrokeWidth);
+        break;
+    default:
+        break;
+    }
+}
+
+int32_t SvgGeometryConverter::GetBrush(std::string_view value, int32_t current)
+{
+    SvgAttributes::Paint paint;
+    if (!SvgAttributes::ParsePaint(value, paint))
+    {
+        return current;
+    }
+
+    switch (paint.Type)
+    {
+    case SvgAttributes::PaintType::Color:
+        return m_document.AddColorBrush(paint.Color);
+    case SvgAttributes::PaintType::Url:
+    {
+        size_t offset = 0;
+        if (TryFindElement(paint.Id, offset))
+        {
+            return GetLinearGradientBrush(offset);
+        }
+    }
+        break;
+    default:
+        break;
+    }
+    return NoBrush;
+}
+
+int32_t SvgGeometryConverter::GetLinearGradientBrush(size_t offset)
+{
+    GradientReader gradient(&m_arena);
+    ReadElement(offset, gradient);
+    if (gradient.Tag != SvgName::LinearGradient)
+    {
+        return NoBrush;
+    }
+
+    // Inkscape likes to keep the stops in a separate gradient and
+    // reference it with xlink:href.
+    for (auto i = 0; i < MaxReferenceDepth && gradient.Stops.empty() && !gradient.Reference.empty(); i++)
+    {
+        if (!TryFindElement(gradient.Reference, offset))
+        {
+            break;
+        }
+        gradient = GradientReader(&m_arena);
+        ReadElement(offset, gradient);
+    }
+    return m_document.AddLinearGradientBrush({ gradient.Stops.data(), gradient.Stops.size() });
+}
+
+bool SvgGeometryConverter::TryFindElement(std::string_view id, size_t& offset)
+{
+    if (id.empty())
+    {
+        return false;
+    }
+    if (!m_elementsIndexed)
+    {
+        ElementIndexer indexer(m_elementOffsets);
+        SvgReader reader(m_data, m_size, &m_arena);
+        reader.Read(indexer);
+        m_elementsIndexed = true;
+    }
+
+    auto search = m_elementOffsets.find(id);
+    if (search == m_elementOffsets.end())
+    {
+        return false;
+    }
+    offset = search->second;
+    return true;
+}
+
+void SvgGeometryConverter::ReadElement(size_t offset, ISvgReaderHandler& handler)
+{
+    // The outer read is still in progress, so this needs its own reader
+    SvgReader reader(m_data, m_size, &m_arena);
+    if (!reader.ReadElement(offset, handler))
+    {
+        throw std::runtime_error(reader.Error() + " at offset " + std::to_string(reader.ErrorOffset()));
+    }
+}
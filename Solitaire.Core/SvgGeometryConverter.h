@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "CardGeometry.h"
+#include "SvgNames.h"
+#include "SvgPathTokenizer.h"
+#include "SvgReader.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Converts an SVG document into CardGeometry as it streams through
+// SvgReader. Every element gets a container (with its transform),
+// drawable elements add a sprite to that container, and
+// fill/stroke/stroke-width are inherited down the tree. Elements from
+// other namespaces (Inkscape, RDF, ...) and the contents of defs are
+// skipped since they never render. References (use, url(#id) paints) are
+// resolved by reading the referenced element again from its offset. Each
+// use target is only converted once per inherited presentation, later uses
+// copy its nodes and share its path data.
+//
+// Everything that's only needed during the conversion (reader buffers, the
+// element stack, the id index, path data as it's being built) comes from
+// an arena that is released in one go with the converter. Tags and
+// attributes are interned (see SvgNames) and brushes are indices into the
+// document, so nothing is copied per element.
+class SvgGeometryConverter : private ISvgReaderHandler
+{
+public:
+    // Throws std::runtime_error if the document can't be read
+    static CardGeometry::Document Convert(char const* data, size_t size);
+
+private:
+    struct Presentation
+    {
+        int32_t Fill;
+        int32_t Stroke;
+        float StrokeWidth;
+    };
+
+    struct Frame
+    {
+        int32_t Node;
+        SvgGeometryConverter::Presentation Presentation;
+    };
+
+    // What a use target looks like depends on what it inherits
+    struct InstanceKey
+    {
+        size_t Offset;
+        SvgGeometryConverter::Presentation Presentation;
+
+        bool operator<(InstanceKey const& other) const
+        {
+            return std::tie(Offset, Presentation.Fill, Presentation.Stroke, Presentation.StrokeWidth) <
+                std::tie(other.Offset, other.Presentation.Fill, other.Presentation.Stroke, other.Presentation.StrokeWidth);
+        }
+    };
+
+    // The nodes a use target was converted to, its root comes first
+    struct Instance
+    {
+        uint32_t FirstNode;
+        uint32_t NodeCount;
+    };
+
+    // The start of the arena is part of the converter (which lives on the
+    // stack), most of the card faces fit in it without the path data.
+    static const size_t InitialArenaSize = 16 * 1024;
+
+    SvgGeometryConverter(char const* data, size_t size);
+    CardGeometry::Document Finish();
+
+    void OnStartElement(std::string_view tag, CardGeometry::Span<SvgAttribute> attributes, size_t offset) override;
+    void OnEndElement(std::string_view tag) override;
+
+    void StartRoot(SvgName tag, SvgElementAttributes const& attributes);
+    void AddReference(std::string_view id, int32_t parent, Presentation const& presentation);
+    void ApplyPresentationAttribute(SvgName name, std::string_view value, Presentation& presentation);
+    int32_t GetBrush(std::string_view value, int32_t current);
+    int32_t GetLinearGradientBrush(size_t offset);
+    bool TryFindElement(std::string_view id, size_t& offset);
+    void ReadElement(size_t offset, ISvgReaderHandler& handler);
+
+private:
+    char const* m_data;
+    size_t m_size;
+    alignas(std::max_align_t) std::byte m_initialArena[InitialArenaSize];
+    std::pmr::monotonic_buffer_resource m_arena;
+    CardGeometry::Document m_document;
+    // Path data is built up here and copied into the document at the
+    // end, so the document's arrays are allocated once at their size
+    std::pmr::vector<CardGeometry::SegmentType> m_segments;
+    std::pmr::vector<CardGeometry::Point> m_points;
+    std::pmr::vector<Frame> m_frames;
+    // Depth inside of a defs element, nothing in there is drawn
+    int m_skipDepth = 0;
+    int m_referenceDepth = 0;
+    // Bumped whenever a reference is too deep to follow, those conversions
+    // are incomplete and can't be reused
+    int m_truncatedReferences = 0;
+    std::pmr::map<InstanceKey, Instance> m_instances;
+    // Only built if the document references anything
+    bool m_elementsIndexed = false;
+    std::pmr::map<std::string_view, size_t> m_elementOffsets;
+    SvgPathTokenizer m_pathTokenizer;
+};
@@ -0,0 +1,69 @@
+#include "SvgNames.h"
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    struct NameEntry
+    {
+        std::string_view Name;
+        SvgName Id;
+    };
+
+    // Sorted by name for the binary search
+    const NameEntry Names[] =
+    {
+        { "circle", SvgName::Circle },
+        { "cx", SvgName::Cx },
+        { "cy", SvgName::Cy },
+        { "d", SvgName::D },
+        { "defs", SvgName::Defs },
+        { "fill", SvgName::Fill },
+        { "height", SvgName::Height },
+        { "href", SvgName::Href },
+        { "id", SvgName::Id },
+        { "linearGradient", SvgName::LinearGradient },
+        { "offset", SvgName::Offset },
+        { "path", SvgName::Path },
+        { "r", SvgName::R },
+        { "rect", SvgName::Rect },
+        { "stop", SvgName::Stop },
+        { "stop-color", SvgName::StopColor },
+        { "stroke", SvgName::Stroke },
+        { "stroke-width", SvgName::StrokeWidth },
+        { "style", SvgName::Style },
+        { "svg", SvgName::Svg },
+        { "transform", SvgName::Transform },
+        { "use", SvgName::Use },
+        { "viewBox", SvgName::ViewBox },
+        { "width", SvgName::Width },
+        { "x", SvgName::X },
+        { "xlink:href", SvgName::XlinkHref },
+        { "y", SvgName::Y },
+    };
+    static_assert(std::size(Names) == static_cast<size_t>(SvgName::Count) - 1, "Every name needs an entry");
+}
+
+namespace SvgNames
+{
+    SvgName Intern(std::string_view name)
+    {
+        auto search = std::lower_bound(std::begin(Names), std::end(Names), name, [](NameEntry const& entry, std::string_view name)
+            {
+                return entry.Name < name;
+            });
+        if (search != std::end(Names) && search->Name == name)
+        {
+            return search->Id;
+        }
+        return SvgName::Unknown;
+    }
+}
+
+SvgElementAttributes::SvgElementAttributes(CardGeometry::Span<SvgAttribute> attributes)
+{
+    for (auto& attribute : attributes)
+    {
+        m_values[static_cast<size_t>(SvgNames::Intern(attribute.Name))] = attribute.Value;
+    }
+}
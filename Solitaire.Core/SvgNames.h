@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "CardGeometry.h"
+#include "SvgReader.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// The tag and attribute names SvgGeometryConverter understands, interned
+// so that each name is looked up once per element and everything after
+// that is a switch or an array index.
+enum class SvgName : uint8_t
+{
+    Unknown,
+
+    // Tags
+    Circle,
+    Defs,
+    LinearGradient,
+    Path,
+    Rect,
+    Stop,
+    Svg,
+    Use,
+
+    // Attributes
+    Cx,
+    Cy,
+    D,
+    Fill,
+    Height,
+    Href,
+    Id,
+    Offset,
+    R,
+    StopColor,
+    Stroke,
+    StrokeWidth,
+    Style,
+    Transform,
+    ViewBox,
+    Width,
+    X,
+    XlinkHref,
+    Y,
+
+    Count,
+};
+
+namespace SvgNames
+{
+    // Unknown for anything that isn't listed above
+    SvgName Intern(std::string_view name);
+}
+
+// The values of an element's known attributes, indexed by name. Built in
+// one pass over the attributes, unknown ones are dropped.
+class SvgElementAttributes
+{
+public:
+    SvgElementAttributes(CardGeometry::Span<SvgAttribute> attributes);
+
+    // Empty if the element doesn't have the attribute
+    std::string_view operator[](SvgName name) const { return m_values[static_cast<size_t>(name)]; }
+
+private:
+    std::string_view m_values[static_cast<size_t>(SvgName::Count)];
+};
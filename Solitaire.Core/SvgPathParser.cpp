@@ -0,0 +1,409 @@
+#include "SvgPathParser.h"
+#include <cmath>
+#include <cstdlib>
+
+using CardGeometry::Point;
+using CardGeometry::SegmentType;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    class PathReader
+    {
+    public:
+        PathReader(std::string const& pathData) : m_current(pathData.c_str()), m_end(pathData.c_str() + pathData.size()) {}
+
+        void SkipSeparators()
+        {
+            while (m_current < m_end && (*m_current == ' ' || *m_current == ',' || *m_current == '\t' || *m_current == '\r' || *m_current == '\n'))
+            {
+                m_current++;
+            }
+        }
+
+        bool AtEnd()
+        {
+            SkipSeparators();
+            return m_current >= m_end;
+        }
+
+        bool NextIsNumber()
+        {
+            SkipSeparators();
+            if (m_current >= m_end)
+            {
+                return false;
+            }
+            auto value = *m_current;
+            return (value >= '0' && value <= '9') || value == '-' || value == '+' || value == '.';
+        }
+
+        bool ReadCommand(char& command)
+        {
+            SkipSeparators();
+            if (m_current >= m_end)
+            {
+                return false;
+            }
+            command = *m_current++;
+            return true;
+        }
+
+        bool ReadNumber(float& result)
+        {
+            SkipSeparators();
+            if (!NextIsNumber())
+            {
+                return false;
+            }
+            char* end = nullptr;
+            auto value = strtod(m_current, &end);
+            if (end == m_current)
+            {
+                return false;
+            }
+            m_current = end;
+            result = static_cast<float>(value);
+            return true;
+        }
+
+        bool ReadPoint(Point& result)
+        {
+            return ReadNumber(result.X) && ReadNumber(result.Y);
+        }
+
+        // Arc flags are a single digit and don't need a separator after them
+        bool ReadFlag(bool& result)
+        {
+            SkipSeparators();
+            if (m_current >= m_end || (*m_current != '0' && *m_current != '1'))
+            {
+                return false;
+            }
+            result = *m_current++ == '1';
+            return true;
+        }
+
+    private:
+        char const* m_current;
+        char const* m_end;
+    };
+
+    Point Add(Point left, Point right) { return { left.X + right.X, left.Y + right.Y }; }
+    Point Reflect(Point point, Point center) { return { 2 * center.X - point.X, 2 * center.Y - point.Y }; }
+    Point Lerp(Point from, Point to, float amount) { return { from.X + (to.X - from.X) * amount, from.Y + (to.Y - from.Y) * amount }; }
+}
+
+bool SvgPathParser::Parse(
+    std::string const& pathData,
+    std::pmr::vector<SegmentType>& segments,
+    std::pmr::vector<Point>& points)
+{
+    PathReader reader(pathData);
+    Point current = { 0, 0 };
+    Point subpathStart = { 0, 0 };
+    // For S and T, the control point of the previous curve
+    Point lastCubicControl = { 0, 0 };
+    Point lastQuadControl = { 0, 0 };
+    char previousCommand = 0;
+    bool needMove = true;
+    bool first = true;
+
+    auto emit = [&](SegmentType type, std::initializer_list<Point> segmentPoints)
+    {
+        if (needMove && type != SegmentType::MoveTo)
+        {
+            // Drawing after a close starts a new subpath at the same place
+            segments.push_back(SegmentType::MoveTo);
+            points.push_back(subpathStart);
+        }
+        needMove = false;
+        segments.push_back(type);
+        points.insert(points.end(), segmentPoints);
+    };
+
+    char command = 0;
+    while (!reader.AtEnd())
+    {
+        if (!reader.NextIsNumber())
+        {
+            reader.ReadCommand(command);
+        }
+        else if (command == 0 || command == 'Z' || command == 'z')
+        {
+            // Numbers without a command to repeat
+            return false;
+        }
+        else if (command == 'M')
+        {
+            // Extra coordinates after a move are lines
+            command = 'L';
+        }
+        else if (command == 'm')
+        {
+            command = 'l';
+        }
+
+        // The first command has to be a move
+        if (first && command != 'M' && command != 'm')
+        {
+            return false;
+        }
+
+        auto relative = command >= 'a' && command <= 'z';
+        auto origin = relative ? current : Point{ 0, 0 };
+        switch (command)
+        {
+        case 'M':
+        case 'm':
+        {
+            Point point;
+            if (!reader.ReadPoint(point))
+            {
+                return false;
+            }
+            // A relative move at the start of the path is absolute
+            current = first ? point : Add(origin, point);
+            subpathStart = current;
+            emit(SegmentType::MoveTo, { current });
+        }
+            break;
+        case 'L':
+        case 'l':
+        {
+            Point point;
+            if (!reader.ReadPoint(point))
+            {
+                return false;
+            }
+            current = Add(origin, point);
+            emit(SegmentType::LineTo, { current });
+        }
+            break;
+        case 'H':
+        case 'h':
+        {
+            float x;
+            if (!reader.ReadNumber(x))
+            {
+                return false;
+            }
+            current.X = relative ? current.X + x : x;
+            emit(SegmentType::LineTo, { current });
+        }
+            break;
+        case 'V':
+        case 'v':
+        {
+            float y;
+            if (!reader.ReadNumber(y))
+            {
+                return false;
+            }
+            current.Y = relative ? current.Y + y : y;
+            emit(SegmentType::LineTo, { current });
+        }
+            break;
+        case 'C':
+        case 'c':
+        {
+            Point control1, control2, end;
+            if (!reader.ReadPoint(control1) || !reader.ReadPoint(control2) || !reader.ReadPoint(end))
+            {
+                return false;
+            }
+            control1 = Add(origin, control1);
+            control2 = Add(origin, control2);
+            current = Add(origin, end);
+            lastCubicControl = control2;
+            emit(SegmentType::CubicTo, { control1, control2, current });
+        }
+            break;
+        case 'S':
+        case 's':
+        {
+            Point control2, end;
+            if (!reader.ReadPoint(control2) || !reader.ReadPoint(end))
+            {
+                return false;
+            }
+            auto previous = previousCommand | 0x20;
+            auto control1 = previous == 'c' || previous == 's' ? Reflect(lastCubicControl, current) : current;
+            control2 = Add(origin, control2);
+            current = Add(origin, end);
+            lastCubicControl = control2;
+            emit(SegmentType::CubicTo, { control1, control2, current });
+        }
+            break;
+        case 'Q':
+        case 'q':
+        case 'T':
+        case 't':
+        {
+            Point control, end;
+            if (command == 'Q' || command == 'q')
+            {
+                if (!reader.ReadPoint(control))
+                {
+                    return false;
+                }
+                control = Add(origin, control);
+            }
+            else
+            {
+                auto previous = previousCommand | 0x20;
+                control = previous == 'q' || previous == 't' ? Reflect(lastQuadControl, current) : current;
+            }
+            if (!reader.ReadPoint(end))
+            {
+                return false;
+            }
+            end = Add(origin, end);
+            lastQuadControl = control;
+            // Degree elevation
+            auto control1 = Lerp(current, control, 2.0f / 3.0f);
+            auto control2 = Lerp(end, control, 2.0f / 3.0f);
+            current = end;
+            emit(SegmentType::CubicTo, { control1, control2, current });
+        }
+            break;
+        case 'A':
+        case 'a':
+        {
+            float radiusX, radiusY, rotation;
+            bool largeArc, sweep;
+            Point end;
+            if (!reader.ReadNumber(radiusX) ||
+                !reader.ReadNumber(radiusY) ||
+                !reader.ReadNumber(rotation) ||
+                !reader.ReadFlag(largeArc) ||
+                !reader.ReadFlag(sweep) ||
+                !reader.ReadPoint(end))
+            {
+                return false;
+            }
+            end = Add(origin, end);
+            if (needMove)
+            {
+                segments.push_back(SegmentType::MoveTo);
+                points.push_back(subpathStart);
+                needMove = false;
+            }
+            AppendArc(current, radiusX, radiusY, rotation, largeArc, sweep, end, segments, points);
+            current = end;
+        }
+            break;
+        case 'Z':
+        case 'z':
+            if (!needMove)
+            {
+                segments.push_back(SegmentType::Close);
+            }
+            current = subpathStart;
+            needMove = true;
+            break;
+        default:
+            return false;
+        }
+        previousCommand = command;
+        first = false;
+    }
+    return true;
+}
+
+void SvgPathParser::AppendArc(
+    Point from,
+    float radiusX,
+    float radiusY,
+    float xAxisRotation,
+    bool largeArc,
+    bool sweep,
+    Point to,
+    std::pmr::vector<SegmentType>& segments,
+    std::pmr::vector<Point>& points)
+{
+    // https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
+    if (from.X == to.X && from.Y == to.Y)
+    {
+        return;
+    }
+    double rx = std::fabs(radiusX);
+    double ry = std::fabs(radiusY);
+    if (rx == 0 || ry == 0)
+    {
+        segments.push_back(SegmentType::LineTo);
+        points.push_back(to);
+        return;
+    }
+
+    auto phi = xAxisRotation * Pi / 180.0;
+    auto cosPhi = std::cos(phi);
+    auto sinPhi = std::sin(phi);
+    auto halfDx = (from.X - to.X) / 2.0;
+    auto halfDy = (from.Y - to.Y) / 2.0;
+    auto x1 = cosPhi * halfDx + sinPhi * halfDy;
+    auto y1 = -sinPhi * halfDx + cosPhi * halfDy;
+
+    // Scale up the radii if they can't span the end points
+    auto lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1)
+    {
+        auto scale = std::sqrt(lambda);
+        rx *= scale;
+        ry *= scale;
+    }
+
+    auto numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    auto denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    auto coefficient = std::sqrt(std::fmax(0.0, numerator / denominator));
+    if (largeArc == sweep)
+    {
+        coefficient = -coefficient;
+    }
+    auto centerX1 = coefficient * rx * y1 / ry;
+    auto centerY1 = coefficient * -ry * x1 / rx;
+    auto centerX = cosPhi * centerX1 - sinPhi * centerY1 + (from.X + to.X) / 2.0;
+    auto centerY = sinPhi * centerX1 + cosPhi * centerY1 + (from.Y + to.Y) / 2.0;
+
+    auto startAngle = std::atan2((y1 - centerY1) / ry, (x1 - centerX1) / rx);
+    auto endAngle = std::atan2((-y1 - centerY1) / ry, (-x1 - centerX1) / rx);
+    auto sweepAngle = endAngle - startAngle;
+    if (!sweep && sweepAngle > 0)
+    {
+        sweepAngle -= 2 * Pi;
+    }
+    else if (sweep && sweepAngle < 0)
+    {
+        sweepAngle += 2 * Pi;
+    }
+
+    // One cubic per quarter turn (or less)
+    auto count = static_cast<int>(std::ceil(std::fabs(sweepAngle) / (Pi / 2.0) - 1e-6));
+    count = count < 1 ? 1 : count;
+    auto step = sweepAngle / count;
+    auto handle = 4.0 / 3.0 * std::tan(step / 4.0);
+    auto map = [&](double x, double y)
+    {
+        return Point
+        {
+            static_cast<float>(centerX + rx * cosPhi * x - ry * sinPhi * y),
+            static_cast<float>(centerY + rx * sinPhi * x + ry * cosPhi * y),
+        };
+    };
+
+    auto angle = startAngle;
+    for (auto i = 0; i < count; i++)
+    {
+        auto nextAngle = angle + step;
+        auto cos1 = std::cos(angle);
+        auto sin1 = std::sin(angle);
+        auto cos2 = std::cos(nextAngle);
+        auto sin2 = std::sin(nextAngle);
+        segments.push_back(SegmentType::CubicTo);
+        points.push_back(map(cos1 - handle * sin1, sin1 + handle * cos1));
+        points.push_back(map(cos2 + handle * sin2, sin2 - handle * cos2));
+        points.push_back(i == count - 1 ? to : map(cos2, sin2));
+        angle = nextAngle;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+// Turns the "d" attribute of a path element into move/line/cubic/close
+// segments. Quadratic curves and arcs are converted to cubics, and
+// relative coordinates are resolved. On malformed data everything up to
+// the error is kept (which is what browsers do) and false is returned.
+// The output is appended to polymorphic vectors so that a converter can
+// build it in its arena.
+class SvgPathParser
+{
+public:
+    static bool Parse(
+        std::string const& pathData,
+        std::pmr::vector<CardGeometry::SegmentType>& segments,
+        std::pmr::vector<CardGeometry::Point>& points);
+
+    // Shared with any other path parser so that they produce the exact
+    // same curves for arcs.
+    static void AppendArc(
+        CardGeometry::Point from,
+        float radiusX,
+        float radiusY,
+        float xAxisRotation,
+        bool largeArc,
+        bool sweep,
+        CardGeometry::Point to,
+        std::pmr::vector<CardGeometry::SegmentType>& segments,
+        std::pmr::vector<CardGeometry::Point>& points);
+
+private:
+    SvgPathParser() {}
+};
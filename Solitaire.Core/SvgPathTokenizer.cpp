@@ -0,0 +1,448 @@
+#include "SvgPathTokenizer.h"
+#include "SvgPathParser.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SVG_PATH_TOKENIZER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+using CardGeometry::Point;
+using CardGeometry::SegmentType;
+
+namespace
+{
+    // Every power of ten up to here is exact in a double
+    double const PowersOfTen[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    const int MaxExactPowerOfTen = 22;
+    const uint64_t MaxExactMantissa = 1ull << 53;
+    // More digits than this could overflow the mantissa
+    const int MaxMantissaDigits = 19;
+
+    bool IsSeparator(char value)
+    {
+        return value == ' ' || value == ',' || value == '\t' || value == '\r' || value == '\n';
+    }
+
+    bool IsDigit(char value)
+    {
+        return static_cast<unsigned char>(value - '0') < 10;
+    }
+
+    bool IsNumberStart(char value)
+    {
+        return IsDigit(value) || value == '-' || value == '+' || value == '.';
+    }
+
+#ifdef SVG_PATH_TOKENIZER_SSE2
+    int CountTrailingZeros(uint32_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+#endif
+
+    // Length of the run of digits at the start of [current, end)
+    size_t CountDigits(char const* current, char const* end)
+    {
+        size_t count = 0;
+#ifdef SVG_PATH_TOKENIZER_SSE2
+        // Digits map to 0-9 after subtracting '0'. SSE2 only has signed
+        // compares, so flip the sign bit to compare them as unsigned.
+        auto const zero = _mm_set1_epi8('0');
+        auto const signBit = _mm_set1_epi8(static_cast<char>(0x80));
+        auto const limit = _mm_set1_epi8(static_cast<char>(0x80 + 10));
+        while (end - current >= 16)
+        {
+            auto chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(current));
+            auto digits = _mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(chunk, zero), signBit), limit);
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(digits));
+            if (mask != 0xFFFF)
+            {
+                return count + CountTrailingZeros(~mask);
+            }
+            count += 16;
+            current += 16;
+        }
+#endif
+        while (current < end && IsDigit(*current))
+        {
+            count++;
+            current++;
+        }
+        return count;
+    }
+
+    // Same grammar as strtod for the characters a path can contain: an
+    // optional sign, digits with an optional fraction (at least one digit
+    // overall), and an optional exponent. Returns nullptr if there isn't a
+    // number at current.
+    char const* ReadNumber(char const* current, char const* end, float& result)
+    {
+        auto start = current;
+        auto negative = false;
+        if (current < end && (*current == '-' || *current == '+'))
+        {
+            negative = *current == '-';
+            current++;
+        }
+
+        uint64_t mantissa = 0;
+        auto digits = 0;
+        auto exponent = 0;
+        auto integerDigits = CountDigits(current, end);
+        for (auto i = 0u; i < integerDigits; i++)
+        {
+            mantissa = mantissa * 10 + (current[i] - '0');
+        }
+        digits += static_cast<int>(integerDigits);
+        current += integerDigits;
+
+        size_t fractionDigits = 0;
+        if (current < end && *current == '.')
+        {
+            current++;
+            fractionDigits = CountDigits(current, end);
+            for (auto i = 0u; i < fractionDigits; i++)
+            {
+                mantissa = mantissa * 10 + (current[i] - '0');
+            }
+            digits += static_cast<int>(fractionDigits);
+            exponent -= static_cast<int>(fractionDigits);
+            current += fractionDigits;
+        }
+        if (integerDigits == 0 && fractionDigits == 0)
+        {
+            return nullptr;
+        }
+
+        // Only an exponent if there are digits after it, otherwise the 'e'
+        // is left for whoever reads next (just like strtod).
+        if (current < end && (*current == 'e' || *current == 'E'))
+        {
+            auto exponentStart = current + 1;
+            auto exponentNegative = false;
+            if (exponentStart < end && (*exponentStart == '-' || *exponentStart == '+'))
+            {
+                exponentNegative = *exponentStart == '-';
+                exponentStart++;
+            }
+            auto exponentDigits = CountDigits(exponentStart, end);
+            if (exponentDigits > 0)
+            {
+                auto value = 0;
+                for (auto i = 0u; i < exponentDigits; i++)
+                {
+                    // Anything this large is out of range anyway
+                    value = value < 10000 ? value * 10 + (exponentStart[i] - '0') : value;
+                }
+                exponent += exponentNegative ? -value : value;
+                current = exponentStart + exponentDigits;
+            }
+        }
+
+        // With an exact mantissa and an exact power of ten, a single
+        // multiply or divide is correctly rounded, same as strtod.
+        if (digits <= MaxMantissaDigits &&
+            mantissa <= MaxExactMantissa &&
+            exponent >= -MaxExactPowerOfTen &&
+            exponent <= MaxExactPowerOfTen)
+        {
+            auto value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / PowersOfTen[-exponent] : value * PowersOfTen[exponent];
+            result = static_cast<float>(negative ? -value : value);
+            return current;
+        }
+
+        // Rare enough (long or extreme numbers) that a copy doesn't matter
+        std::string number(start, current);
+        result = static_cast<float>(strtod(number.c_str(), nullptr));
+        return current;
+    }
+
+    int ArgumentCount(char command)
+    {
+        switch (command | 0x20)
+        {
+        case 'm':
+        case 'l':
+        case 't':
+            return 2;
+        case 'h':
+        case 'v':
+            return 1;
+        case 'c':
+            return 6;
+        case 's':
+        case 'q':
+            return 4;
+        case 'a':
+            return 7;
+        case 'z':
+            return 0;
+        default:
+            return -1;
+        }
+    }
+
+    Point Add(Point left, Point right) { return { left.X + right.X, left.Y + right.Y }; }
+    Point Reflect(Point point, Point center) { return { 2 * center.X - point.X, 2 * center.Y - point.Y }; }
+    Point Lerp(Point from, Point to, float amount) { return { from.X + (to.X - from.X) * amount, from.Y + (to.Y - from.Y) * amount }; }
+}
+
+bool SvgPathTokenizer::Parse(
+    std::string_view pathData,
+    std::pmr::vector<SegmentType>& segments,
+    std::pmr::vector<Point>& points)
+{
+    // A tokenizer error still leaves the commands before it to emit
+    auto tokenized = Tokenize(pathData);
+    return Emit(segments, points) && tokenized;
+}
+
+bool SvgPathTokenizer::Tokenize(std::string_view pathData)
+{
+    m_commands.clear();
+    m_numbers.clear();
+
+    auto current = pathData.data();
+    auto const end = current + pathData.size();
+    while (true)
+    {
+        while (current < end && IsSeparator(*current))
+        {
+            current++;
+        }
+        if (current >= end)
+        {
+            return true;
+        }
+
+        if (!IsNumberStart(*current))
+        {
+            m_commands.push_back({ *current++, static_cast<uint32_t>(m_numbers.size()), 0 });
+            continue;
+        }
+        if (m_commands.empty())
+        {
+            // Numbers without a command
+            return false;
+        }
+
+        auto& command = m_commands.back();
+        auto argument = command.NumberCount % 7;
+        if ((command.Letter | 0x20) == 'a' && (argument == 3 || argument == 4))
+        {
+            // Arc flags are a single digit and don't need a separator after them
+            if (*current != '0' && *current != '1')
+            {
+                return false;
+            }
+            m_numbers.push_back(*current++ == '1' ? 1.0f : 0.0f);
+        }
+        else
+        {
+            float value = 0;
+            auto next = ReadNumber(current, end, value);
+            if (next == nullptr)
+            {
+                return false;
+            }
+            m_numbers.push_back(value);
+            current = next;
+        }
+        command.NumberCount++;
+    }
+}
+
+bool SvgPathTokenizer::Emit(
+    std::pmr::vector<SegmentType>& segments,
+    std::pmr::vector<Point>& points)
+{
+    Point current = { 0, 0 };
+    Point subpathStart = { 0, 0 };
+    // For S and T, the control point of the previous curve
+    Point lastCubicControl = { 0, 0 };
+    Point lastQuadControl = { 0, 0 };
+    char previousCommand = 0;
+    bool needMove = true;
+    bool first = true;
+
+    auto startSegment = [&]()
+    {
+        if (needMove)
+        {
+            // Drawing after a close starts a new subpath at the same place
+            segments.push_back(SegmentType::MoveTo);
+            points.push_back(subpathStart);
+            needMove = false;
+        }
+    };
+
+    for (auto& token : m_commands)
+    {
+        auto arguments = ArgumentCount(token.Letter);
+        if (arguments < 0)
+        {
+            return false;
+        }
+        if (arguments == 0)
+        {
+            // The first command has to be a move
+            if (first)
+            {
+                return false;
+            }
+            if (!needMove)
+            {
+                segments.push_back(SegmentType::Close);
+            }
+            current = subpathStart;
+            needMove = true;
+            previousCommand = token.Letter;
+            if (token.NumberCount > 0)
+            {
+                // Numbers without a command to repeat
+                return false;
+            }
+            continue;
+        }
+        if (token.NumberCount == 0)
+        {
+            return false;
+        }
+
+        auto command = token.Letter;
+        auto relative = command >= 'a' && command <= 'z';
+        auto numbers = m_numbers.data() + token.FirstNumber;
+        auto remaining = token.NumberCount;
+        for (; remaining > 0; numbers += arguments, remaining -= arguments)
+        {
+            if (first && command != 'M' && command != 'm')
+            {
+                return false;
+            }
+            if (remaining < static_cast<uint32_t>(arguments))
+            {
+                return false;
+            }
+
+            auto origin = relative ? current : Point{ 0, 0 };
+            switch (command)
+            {
+            case 'M':
+            case 'm':
+                // A relative move at the start of the path is absolute
+                current = first ? Point{ numbers[0], numbers[1] } : Add(origin, { numbers[0], numbers[1] });
+                subpathStart = current;
+                segments.push_back(SegmentType::MoveTo);
+                points.push_back(current);
+                needMove = false;
+                break;
+            case 'L':
+            case 'l':
+                current = Add(origin, { numbers[0], numbers[1] });
+                startSegment();
+                segments.push_back(SegmentType::LineTo);
+                points.push_back(current);
+                break;
+            case 'H':
+            case 'h':
+                current.X = relative ? current.X + numbers[0] : numbers[0];
+                startSegment();
+                segments.push_back(SegmentType::LineTo);
+                points.push_back(current);
+                break;
+            case 'V':
+            case 'v':
+                current.Y = relative ? current.Y + numbers[0] : numbers[0];
+                startSegment();
+                segments.push_back(SegmentType::LineTo);
+                points.push_back(current);
+                break;
+            case 'C':
+            case 'c':
+            {
+                auto control1 = Add(origin, { numbers[0], numbers[1] });
+                auto control2 = Add(origin, { numbers[2], numbers[3] });
+                current = Add(origin, { numbers[4], numbers[5] });
+                lastCubicControl = control2;
+                startSegment();
+                segments.push_back(SegmentType::CubicTo);
+                points.insert(points.end(), { control1, control2, current });
+            }
+                break;
+            case 'S':
+            case 's':
+            {
+                auto previous = previousCommand | 0x20;
+                auto control1 = previous == 'c' || previous == 's' ? Reflect(lastCubicControl, current) : current;
+                auto control2 = Add(origin, { numbers[0], numbers[1] });
+                current = Add(origin, { numbers[2], numbers[3] });
+                lastCubicControl = control2;
+                startSegment();
+                segments.push_back(SegmentType::CubicTo);
+                points.insert(points.end(), { control1, control2, current });
+            }
+                break;
+            case 'Q':
+            case 'q':
+            case 'T':
+            case 't':
+            {
+                Point control;
+                Point end;
+                if (command == 'Q' || command == 'q')
+                {
+                    control = Add(origin, { numbers[0], numbers[1] });
+                    end = Add(origin, { numbers[2], numbers[3] });
+                }
+                else
+                {
+                    auto previous = previousCommand | 0x20;
+                    control = previous == 'q' || previous == 't' ? Reflect(lastQuadControl, current) : current;
+                    end = Add(origin, { numbers[0], numbers[1] });
+                }
+                lastQuadControl = control;
+                // Degree elevation
+                auto control1 = Lerp(current, control, 2.0f / 3.0f);
+                auto control2 = Lerp(end, control, 2.0f / 3.0f);
+                current = end;
+                startSegment();
+                segments.push_back(SegmentType::CubicTo);
+                points.insert(points.end(), { control1, control2, current });
+            }
+                break;
+            case 'A':
+            case 'a':
+            {
+                auto end = Add(origin, { numbers[5], numbers[6] });
+                startSegment();
+                SvgPathParser::AppendArc(current, numbers[0], numbers[1], numbers[2], numbers[3] != 0, numbers[4] != 0, end, segments, points);
+                current = end;
+            }
+                break;
+            }
+
+            // Extra coordinates after a move are lines
+            previousCommand = command;
+            command = command == 'M' ? 'L' : (command == 'm' ? 'l' : command);
+            first = false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,354 @@
+#include "SvgReader.h"
+#include <cstring>
+
+namespace
+{
+    bool IsWhitespace(char value)
+    {
+        return value == ' ' || value == '\t' || value == '\r' || value == '\n';
+    }
+
+    bool IsNameEnd(char value)
+    {
+        return IsWhitespace(value) || value == '=' || value == '>' || value == '/' || value == '<';
+    }
+
+    // Namespace declarations and anything from another namespace (inkscape:*,
+    // sodipodi:*, ...) are of no use to anyone reading the shapes.
+    bool IsSvgAttribute(std::string_view name)
+    {
+        auto colon = name.find(':');
+        if (colon == std::string_view::npos)
+        {
+            return name != "xmlns";
+        }
+        auto prefix = name.substr(0, colon);
+        return prefix == "xlink" || prefix == "xml";
+    }
+
+    // Returns false for elements from other namespaces
+    bool GetSvgTag(std::string_view name, std::string_view& tag)
+    {
+        auto colon = name.find(':');
+        if (colon == std::string_view::npos)
+        {
+            tag = name;
+            return true;
+        }
+        if (name.substr(0, colon) == "svg")
+        {
+            tag = name.substr(colon + 1);
+            return true;
+        }
+        return false;
+    }
+}
+
+bool SvgReader::Read(ISvgReaderHandler& handler)
+{
+    m_position = 0;
+    return ReadContent(handler, false);
+}
+
+bool SvgReader::ReadElement(size_t offset, ISvgReaderHandler& handler)
+{
+    if (offset >= m_size || m_data[offset] != '<')
+    {
+        m_position = offset;
+        return Fail("Not the start of an element");
+    }
+    m_position = offset;
+    return ReadContent(handler, true);
+}
+
+bool SvgReader::Fail(char const* message)
+{
+    m_error = message;
+    m_errorOffset = m_position;
+    return false;
+}
+
+bool SvgReader::ReadContent(ISvgReaderHandler& handler, bool singleElement)
+{
+    m_error.clear();
+    m_elementsReported = 0;
+    m_elementsSkipped = 0;
+    m_bytesSkipped = 0;
+    // Names of the open elements, to match up end tags
+    auto& open = m_openElements;
+    open.clear();
+    auto sawRoot = false;
+
+    while (true)
+    {
+        auto next = static_cast<char const*>(memchr(m_data + m_position, '<', m_size - m_position));
+        if (next == nullptr)
+        {
+            m_position = m_size;
+            if (!open.empty() || !sawRoot)
+            {
+                return Fail(sawRoot ? "Unterminated element" : "No root element");
+            }
+            return true;
+        }
+        m_position = next - m_data;
+
+        auto offset = m_position;
+        auto skipped = false;
+        if (!SkipMarkup(skipped))
+        {
+            return false;
+        }
+        if (skipped)
+        {
+            m_bytesSkipped += m_position - offset;
+            continue;
+        }
+
+        TagKind kind;
+        std::string_view name;
+        if (!ReadTag(kind, name, true))
+        {
+            return false;
+        }
+
+        std::string_view tag;
+        auto isSvg = GetSvgTag(name, tag);
+        if (kind == TagKind::End)
+        {
+            if (open.empty() || open.back() != name)
+            {
+                m_position = offset;
+                return Fail("Mismatched end tag");
+            }
+            open.pop_back();
+            handler.OnEndElement(tag);
+        }
+        else if (!isSvg)
+        {
+            m_elementsSkipped++;
+            if (kind == TagKind::Start && !SkipForeignElement())
+            {
+                return false;
+            }
+            m_bytesSkipped += m_position - offset;
+        }
+        else
+        {
+            if (open.empty() && sawRoot && !singleElement)
+            {
+                m_position = offset;
+                return Fail("More than one root element");
+            }
+            sawRoot = true;
+            m_elementsReported++;
+            handler.OnStartElement(tag, { m_attributes.data(), m_attributes.size() }, offset);
+            if (kind == TagKind::Empty)
+            {
+                handler.OnEndElement(tag);
+            }
+            else
+            {
+                open.push_back(name);
+            }
+        }
+
+        if (singleElement && open.empty())
+        {
+            return true;
+        }
+    }
+}
+
+bool SvgReader::SkipForeignElement()
+{
+    auto depth = 1;
+    while (depth > 0)
+    {
+        auto next = static_cast<char const*>(memchr(m_data + m_position, '<', m_size - m_position));
+        if (next == nullptr)
+        {
+            m_position = m_size;
+            return Fail("Unterminated element");
+        }
+        m_position = next - m_data;
+
+        auto skipped = false;
+        if (!SkipMarkup(skipped))
+        {
+            return false;
+        }
+        if (skipped)
+        {
+            continue;
+        }
+
+        TagKind kind;
+        std::string_view name;
+        if (!ReadTag(kind, name, false))
+        {
+            return false;
+        }
+        switch (kind)
+        {
+        case TagKind::Start:
+            m_elementsSkipped++;
+            depth++;
+            break;
+        case TagKind::Empty:
+            m_elementsSkipped++;
+            break;
+        case TagKind::End:
+            depth--;
+            break;
+        }
+    }
+    return true;
+}
+
+bool SvgReader::SkipMarkup(bool& skipped)
+{
+    std::string_view rest(m_data + m_position, m_size - m_position);
+    char const* terminator = nullptr;
+    if (rest.compare(0, 4, "<!--") == 0)
+    {
+        terminator = "-->";
+    }
+    else if (rest.compare(0, 9, "<![CDATA[") == 0)
+    {
+        terminator = "]]>";
+    }
+    else if (rest.compare(0, 2, "<?") == 0)
+    {
+        terminator = "?>";
+    }
+    else if (rest.compare(0, 2, "<!") == 0)
+    {
+        terminator = ">";
+    }
+
+    skipped = terminator != nullptr;
+    if (skipped)
+    {
+        auto end = rest.find(terminator);
+        if (end == std::string_view::npos)
+        {
+            return Fail("Unterminated markup");
+        }
+        m_position += end + strlen(terminator);
+    }
+    return true;
+}
+
+bool SvgReader::ReadTag(TagKind& kind, std::string_view& name, bool collectAttributes)
+{
+    auto const end = m_data + m_size;
+    auto current = m_data + m_position + 1;
+    auto fail = [&](char const* message)
+    {
+        m_position = current - m_data;
+        return Fail(message);
+    };
+    auto skipWhitespace = [&]()
+    {
+        while (current < end && IsWhitespace(*current))
+        {
+            current++;
+        }
+    };
+    auto readName = [&]()
+    {
+        auto start = current;
+        while (current < end && !IsNameEnd(*current))
+        {
+            current++;
+        }
+        return std::string_view(start, current - start);
+    };
+
+    kind = TagKind::Start;
+    if (current < end && *current == '/')
+    {
+        current++;
+        kind = TagKind::End;
+    }
+    name = readName();
+    if (name.empty())
+    {
+        return fail("Expected a tag name");
+    }
+
+    if (kind == TagKind::End)
+    {
+        skipWhitespace();
+        if (current >= end || *current != '>')
+        {
+            return fail("Expected '>'");
+        }
+        m_position = current + 1 - m_data;
+        return true;
+    }
+
+    if (collectAttributes)
+    {
+        m_attributes.clear();
+    }
+    while (true)
+    {
+        skipWhitespace();
+        if (current >= end)
+        {
+            return fail("Unterminated start tag");
+        }
+        if (*current == '>')
+        {
+            current++;
+            break;
+        }
+        if (*current == '/')
+        {
+            if (current + 1 >= end || current[1] != '>')
+            {
+                return fail("Expected '>'");
+            }
+            current += 2;
+            kind = TagKind::Empty;
+            break;
+        }
+
+        auto attributeName = readName();
+        if (attributeName.empty())
+        {
+            return fail("Expected an attribute name");
+        }
+        skipWhitespace();
+        if (current >= end || *current != '=')
+        {
+            return fail("Expected '=' after attribute name");
+        }
+        current++;
+        skipWhitespace();
+        if (current >= end || (*current != '"' && *current != '\''))
+        {
+            return fail("Expected a quoted attribute value");
+        }
+        auto quote = *current++;
+        auto valueEnd = static_cast<char const*>(memchr(current, quote, end - current));
+        if (valueEnd == nullptr)
+        {
+            return fail("Unterminated attribute value");
+        }
+        if (collectAttributes && IsSvgAttribute(attributeName))
+        {
+            m_attributes.push_back({ attributeName, std::string_view(current, valueEnd - current) });
+        }
+        else if (collectAttributes)
+        {
+            m_bytesSkipped += valueEnd + 1 - attributeName.data();
+        }
+        current = valueEnd + 1;
+    }
+
+    m_position = current - m_data;
+    return true;
+}
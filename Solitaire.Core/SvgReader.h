@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CardGeometry.h"
+
+// NOTE: This file is shared with Solitaire.Tools and must stay free of
+// any Windows or WinRT dependencies.
+
+struct SvgAttribute
+{
+    std::string_view Name;
+    // Raw, entity references are not expanded. The card faces don't use
+    // any outside of text content.
+    std::string_view Value;
+};
+
+class ISvgReaderHandler
+{
+public:
+    virtual ~ISvgReaderHandler() {}
+
+    // The tag has any svg namespace prefix removed. Offset is where the
+    // element starts in the document, it can be passed to ReadElement
+    // later to read the element again.
+    virtual void OnStartElement(
+        std::string_view tag,
+        CardGeometry::Span<SvgAttribute> attributes,
+        size_t offset) = 0;
+    virtual void OnEndElement(std::string_view tag) = 0;
+};
+
+// A streaming reader for SVG documents. Nothing is copied, names and
+// values point into the document, which has to outlive the reader.
+//
+// Elements from other namespaces (Inkscape, RDF, Dublin Core, ...) are
+// skipped along with everything inside of them, and so are attributes
+// from other namespaces. The only prefixed attributes that are reported
+// are xlink:* and xml:*. Text, comments, CDATA, processing instructions
+// and doctypes are skipped too. Once the attribute buffer has grown to
+// fit the largest element nothing allocates, and what it does allocate
+// comes from the given memory resource.
+class SvgReader
+{
+public:
+    SvgReader(char const* data, size_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+        m_data(data), m_size(size), m_attributes(resource), m_openElements(resource) {}
+
+    // Returns false on malformed input, see Error()
+    bool Read(ISvgReaderHandler& handler);
+    // Reads a single element (and its children) starting at offset
+    bool ReadElement(size_t offset, ISvgReaderHandler& handler);
+
+    std::string const& Error() const { return m_error; }
+    size_t ErrorOffset() const { return m_errorOffset; }
+    // Counters from the last read
+    size_t ElementsReported() const { return m_elementsReported; }
+    size_t ElementsSkipped() const { return m_elementsSkipped; }
+    // Bytes of markup that never reach the handler: elements and
+    // attributes from other namespaces, comments, CDATA, processing
+    // instructions and doctypes
+    size_t BytesSkipped() const { return m_bytesSkipped; }
+
+private:
+    enum class TagKind
+    {
+        Start,
+        Empty,
+        End,
+    };
+
+    bool ReadContent(ISvgReaderHandler& handler, bool singleElement);
+    bool ReadTag(TagKind& kind, std::string_view& name, bool collectAttributes);
+    bool SkipMarkup(bool& skipped);
+    bool SkipForeignElement();
+    bool Fail(char const* message);
+
+private:
+    char const* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+    std::pmr::vector<SvgAttribute> m_attributes;
+    std::pmr::vector<std::string_view> m_openElements;
+    std::string m_error;
+    size_t m_errorOffset = 0;
+    size_t m_elementsReported = 0;
+    size_t m_elementsSkipped = 0;
+    size_t m_bytesSkipped = 0;
+};
@@ -14,396 +14,232 @@ namespace util
     using namespace robmikh::common::uwp;
 }
 
-winrt::Color D2DColorToWinRTColor(D2D1_COLOR_F const& color)
+winrt::CompositionGeometry CreateGeometryFromNode(
+    winrt::Compositor const& compositor,
+    winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+    CardGeometry::DocumentView const& document,
+    CardGeometry::Node const& node);
+winrt::CompositionBrush CreateBrushFromGeometry(
+    winrt::Compositor const& compositor,
+    CardGeometry::DocumentView const& document,
+    int32_t brushIndex);
+
+winrt::Color GeometryColorToWinRTColor(CardGeometry::Color const& color)
 {
-    return winrt::Color
-    {
-        static_cast<uint8_t>(color.a * 255.0f),
-        static_cast<uint8_t>(color.r * 255.0f),
-        static_cast<uint8_t>(color.g * 255.0f),
-        static_cast<uint8_t>(color.b * 255.0f),
-    };
+    return winrt::Color{ color.A, color.R, color.G, color.B };
 }
 
-std::wstring GetTag(winrt::com_ptr<ID2D1SvgElement> const& element)
+SvgCompositionShapes SvgShapesBuilder::ConvertGeometryToCompositionShapes(
+    winrt::Compositor const& compositor,
+    winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+    SharedResourceCache& resourceCache,
+    CardGeometry::DocumentView const& document,
+    ShapeCounts& counts)
 {
-    auto length = element->GetTagNameLength();
-    std::wstring name(length + 1, 0);
-    element->GetTagName(name.data(), name.length());
-    name.resize(length);
-    return name;
+    CompositionShapeSink sink(compositor, d2dFactory, resourceCache);
+    CountingShapeSink counter(&sink);
+    ShapeSink::Build(document, resourceCache.Ids, counter);
+    counts = counter.Counts();
+    return sink.Shapes();
 }
 
-D2D1_SVG_VIEWBOX GetRectangleAttribute(winrt::com_ptr<ID2D1SvgElement> const& element, std::wstring const& attributeName)
+CompositionShapeSink::CompositionShapeSink(
+    winrt::Compositor const& compositor,
+    winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+    SharedResourceCache& resourceCache) :
+    m_compositor(compositor),
+    m_d2dFactory(d2dFactory),
+    m_resourceCache(resourceCache)
 {
-    D2D1_SVG_VIEWBOX rect = {};
-    winrt::check_hresult(element->GetAttributeValue(
-        attributeName.c_str(),
-        D2D1_SVG_ATTRIBUTE_POD_TYPE_VIEWBOX,
-        static_cast<void*>(&rect),
-        sizeof(rect)));
-    return rect;
 }
 
-std::wstring GetIdAttribute(winrt::com_ptr<ID2D1SvgElement> const& element, std::wstring const& attributeName)
+SvgCompositionShapes CompositionShapeSink::Shapes() const
 {
-    uint32_t attributeLength = 0;
-    winrt::check_hresult(element->GetAttributeValueLength(
-        attributeName.c_str(),
-        D2D1_SVG_ATTRIBUTE_STRING_TYPE_ID,
-        &attributeLength));
-    std::wstring result(attributeLength + 1, 0);
-    winrt::check_hresult(element->GetAttributeValue(
-        attributeName.c_str(),
-        D2D1_SVG_ATTRIBUTE_STRING_TYPE_ID,
-        result.data(),
-        result.length()));
-    result.resize(attributeLength);
-    return result;
+    if (m_containers.empty())
+    {
+        return { m_viewBox, nullptr };
+    }
+    return { m_viewBox, m_containers[0] };
 }
 
-float GetFloatAttribute(winrt::com_ptr<ID2D1SvgElement> const& element, std::wstring const& attributeName)
+void CompositionShapeSink::BeginDocument()
 {
-    float value = 0;
-    winrt::check_hresult(element->GetAttributeValue(
-        attributeName.c_str(),
-        &value));
-    return value;
+    m_viewBox = nullptr;
+    m_containers.clear();
 }
 
-winrt::float3x2 GetTransformAttribute(winrt::com_ptr<ID2D1SvgElement> const& element, std::wstring const& attributeName)
+void CompositionShapeSink::SetViewBox(CardGeometry::ViewBox const& viewBox)
 {
-    winrt::float3x2 value = {};
-    winrt::check_hresult(element->GetAttributeValue(
-        attributeName.c_str(),
-        reinterpret_cast<D2D1_MATRIX_3X2_F*>(&value)));
-    return value;
+    m_viewBox = m_compositor.CreateViewBox();
+    m_viewBox.Size({ viewBox.Width, viewBox.Height });
+    m_viewBox.Offset({ viewBox.X, viewBox.Y });
 }
 
-winrt::Color GetColorAttribute(winrt::com_ptr<ID2D1SvgElement> const& element, std::wstring const& attributeName)
+void CompositionShapeSink::AddContainer(int32_t parent, CardGeometry::Matrix const* transform)
 {
-    D2D1_COLOR_F color = {};
-    winrt::check_hresult(element->GetAttributeValue(
-        attributeName.c_str(),
-        &color));
-    return D2DColorToWinRTColor(color);
+    auto container = m_compositor.CreateContainerShape();
+    AddShape(parent, transform, container);
+    m_containers.back() = container;
 }
 
-std::vector<std::wstring> GetSpecifiedAttributes(winrt::com_ptr<ID2D1SvgElement> const& element)
+void CompositionShapeSink::AddSprite(
+    int32_t parent,
+    CardGeometry::Matrix const* transform,
+    uint32_t geometry,
+    uint32_t fillBrush,
+    uint32_t strokeBrush,
+    float strokeWidth)
 {
-    std::vector<std::wstring> names;
-    uint32_t count = element->GetSpecifiedAttributeCount();
-    for (auto i = 0; i < count; i++)
-    {
-        uint32_t length = 0;
-        winrt::check_hresult(element->GetSpecifiedAttributeNameLength(i, &length, FALSE));
-        std::wstring name(length + 1, 0);
-        winrt::check_hresult(element->GetSpecifiedAttributeName(i, name.data(), name.length(), FALSE));
-        name.resize(length);
-        names.push_back(name);
-    }
-    return names;
+    auto spriteShape = m_compositor.CreateSpriteShape(m_resourceCache.Geometry[geometry]);
+    spriteShape.FillBrush(GetBrush(fillBrush));
+    spriteShape.StrokeBrush(GetBrush(strokeBrush));
+    spriteShape.StrokeThickness(strokeWidth);
+    AddShape(parent, transform, spriteShape);
 }
 
-SvgCompositionShapes SvgShapesBuilder::ConvertSvgDocumentToCompositionShapes(
-    winrt::Compositor const& compositor, 
-    winrt::com_ptr<ID2D1SvgDocument> const& document)
+void CompositionShapeSink::AddShape(
+    int32_t parent,
+    CardGeometry::Matrix const* transform,
+    winrt::CompositionShape const& shape)
 {
-    auto rootVisual = compositor.CreateShapeVisual();
-
-    // Assumption: There is only one "svg" element and it is at the root.
-    // Techincally this is incorrect, as the spec specifically states that
-    // having multiple "svg" elements embeded in each other is possible.
-    // https://www.w3.org/TR/SVG11/struct.html
-    winrt::com_ptr<ID2D1SvgElement> rootElement;
-    document->GetRoot(rootElement.put());
-    auto tag = GetTag(rootElement);
-    WINRT_VERIFY(tag == L"svg");
-
-    winrt::CompositionViewBox viewBox{ nullptr };
-
-    if (rootElement->IsAttributeSpecified(L"viewBox"))
+    if (transform != nullptr)
     {
-        auto rect = GetRectangleAttribute(rootElement, L"viewBox");
-        viewBox = compositor.CreateViewBox();
-        viewBox.Size({ rect.width, rect.height });
-        viewBox.Offset({ rect.x, rect.y });
+        shape.TransformMatrix({ transform->M11, transform->M12, transform->M21, transform->M22, transform->M31, transform->M32 });
     }
-
-    auto container = compositor.CreateContainerShape();
-    std::stack<Presentation> presentationStack;
-    presentationStack.push(Presentation
-        {
-            std::make_shared<ColorBrushInfo>(winrt::Colors::Black()),
-            std::make_shared<ColorBrushInfo>(winrt::Colors::Transparent()),
-            1.0f
-        });
-
-    winrt::com_ptr<ID2D1SvgElement> child;
-    rootElement->GetFirstChild(child.put());
-    while (child != nullptr)
+    if (parent != CardGeometry::NoParent)
     {
-        ProcessSvgElement(presentationStack, container, child);
-        winrt::com_ptr<ID2D1SvgElement> newChild;
-        winrt::check_hresult(rootElement->GetNextChild(child.get(), newChild.put()));
-        child = newChild;
+        m_containers[parent].Shapes().Append(shape);
     }
-
-    return { viewBox, container };
+    m_containers.push_back(nullptr);
 }
 
-void SvgShapesBuilder::ProcessSvgElement(
-    std::stack<Presentation>& presentationStack, 
-    winrt::CompositionContainerShape const& parentShape,
-    winrt::com_ptr<ID2D1SvgElement> const& element)
+winrt::CompositionBrush CompositionShapeSink::GetBrush(uint32_t brush) const
 {
-    auto current = element;
-    if (!current->IsTextContent())
-    {
-        auto compositor = parentShape.Compositor();
-        auto currentShape = compositor.CreateContainerShape();
-        parentShape.Shapes().Append(currentShape);
+    return brush == ShapeSink::NoResource ? nullptr : m_resourceCache.Brushes[brush];
+}
 
-        auto& currentPresentation = presentationStack.top();
-        Presentation presentation = currentPresentation;
+uint32_t CompositionShapeSink::CreateGeometry(CardGeometry::DocumentView const& document, CardGeometry::Node const& node)
+{
+    m_resourceCache.Geometry.push_back(CreateGeometryFromNode(m_compositor, m_d2dFactory, document, node));
+    return static_cast<uint32_t>(m_resourceCache.Geometry.size() - 1);
+}
 
-        // Record the id for debugging
-        if (current->IsAttributeSpecified(L"id"))
-        {
-            auto id = GetIdAttribute(current, L"id");
-            currentShape.Comment(id);
-        }
+uint32_t CompositionShapeSink::CreateBrush(CardGeometry::DocumentView const& document, int32_t brushIndex)
+{
+    m_resourceCache.Brushes.push_back(CreateBrushFromGeometry(m_compositor, document, brushIndex));
+    return static_cast<uint32_t>(m_resourceCache.Brushes.size() - 1);
+}
 
-        // General attributes
-        auto attributeNames = GetSpecifiedAttributes(current);
-        for (auto&& attributeName : attributeNames) 
+winrt::CompositionGeometry CreateGeometryFromNode(
+    winrt::Compositor const& compositor,
+    winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+    CardGeometry::DocumentView const& document,
+    CardGeometry::Node const& node)
+{
+    auto& params = node.Params;
+    switch (node.Type)
+    {
+    case CardGeometry::NodeType::Path:
+    {
+        winrt::com_ptr<ID2D1PathGeometry1> d2dGeometry;
+        winrt::check_hresult(d2dFactory->CreatePathGeometry(d2dGeometry.put()));
+        winrt::com_ptr<ID2D1GeometrySink> sink;
+        winrt::check_hresult(d2dGeometry->Open(sink.put()));
+        sink->SetFillMode(D2D1_FILL_MODE_ALTERNATE);
+
+        auto figureOpen = false;
+        auto point = document.Points.Data + node.FirstPoint;
+        for (auto i = 0u; i < node.SegmentCount; i++)
         {
-            if (attributeName == L"x")
-            {
-                auto offset = currentShape.Offset();
-                auto value = GetFloatAttribute(current, attributeName);
-                offset.x = value;
-            }
-            else if (attributeName == L"y")
-            {
-                auto offset = currentShape.Offset();
-                auto value = GetFloatAttribute(current, attributeName);
-                offset.y = value;
-            }
-            else if (attributeName == L"fill")
-            {
-                presentation.Fill = GetBrushInfo(current, attributeName);
-            }
-            else if (attributeName == L"stroke")
-            {
-                presentation.Stroke = GetBrushInfo(current, attributeName);
-            }
-            else if (attributeName == L"stroke-width")
-            {
-                auto strokeWidth = GetFloatAttribute(current, attributeName);
-                presentation.StrokeWidth = strokeWidth;
-            }
-            else if (attributeName == L"transform")
+            switch (document.Segments[node.FirstSegment + i])
             {
-                auto transform = GetTransformAttribute(current, attributeName);
-                currentShape.TransformMatrix(transform);
+            case CardGeometry::SegmentType::MoveTo:
+                if (figureOpen)
+                {
+                    sink->EndFigure(D2D1_FIGURE_END_OPEN);
+                }
+                sink->BeginFigure(D2D1::Point2F(point[0].X, point[0].Y), D2D1_FIGURE_BEGIN_FILLED);
+                figureOpen = true;
+                point += 1;
+                break;
+            case CardGeometry::SegmentType::LineTo:
+                sink->AddLine(D2D1::Point2F(point[0].X, point[0].Y));
+                point += 1;
+                break;
+            case CardGeometry::SegmentType::CubicTo:
+                sink->AddBezier(D2D1::BezierSegment(
+                    D2D1::Point2F(point[0].X, point[0].Y),
+                    D2D1::Point2F(point[1].X, point[1].Y),
+                    D2D1::Point2F(point[2].X, point[2].Y)));
+                point += 3;
+                break;
+            case CardGeometry::SegmentType::Close:
+                if (figureOpen)
+                {
+                    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+                    figureOpen = false;
+                }
+                break;
             }
         }
-
-        // Special cases
-        auto tag = GetTag(current);
-        if (tag == L"defs")
-        {
-            // TODO: Keep track of children, prevent them from rendering
-            // For now, let's just disconnect ourselves from the tree. A bit nasty.
-            parentShape.Shapes().RemoveAtEnd();
-        }
-        else if (tag == L"use")
-        {
-            auto href = GetIdAttribute(current, L"xlink:href");
-            winrt::com_ptr<ID2D1SvgDocument> document;
-            current->GetDocument(document.put());
-            winrt::com_ptr<ID2D1SvgElement> reference;
-            winrt::check_hresult(document->FindElementById(href.c_str(), reference.put()));
-            ProcessSvgElement(presentationStack, currentShape, reference);
-        }
-        else if (tag == L"circle")
-        {
-            auto centerX = GetFloatAttribute(current, L"cx");
-            auto centerY = GetFloatAttribute(current, L"cy");
-            auto radius =  GetFloatAttribute(current, L"r");
-
-            auto geometry = compositor.CreateEllipseGeometry();
-            geometry.Center({ centerX, centerY });
-            geometry.Radius({ radius, radius });
-            auto spriteShape = compositor.CreateSpriteShape();
-
-            spriteShape.FillBrush(CreateBrushFromBrushInfo(compositor, presentation.Fill));
-            spriteShape.StrokeBrush(CreateBrushFromBrushInfo(compositor, presentation.Stroke));
-            spriteShape.StrokeThickness(presentation.StrokeWidth);
-
-            currentShape.Shapes().Append(spriteShape);
-        }
-        else if (tag == L"rect")
+        if (figureOpen)
         {
-            auto x = GetFloatAttribute(current, L"x");
-            auto y = GetFloatAttribute(current, L"y");
-            auto width = GetFloatAttribute(current, L"width");
-            auto height = GetFloatAttribute(current, L"height");
-
-            auto geometry = compositor.CreateRectangleGeometry();
-            geometry.Offset({ x, y });
-            geometry.Size({ width, height });
-            auto spriteShape = compositor.CreateSpriteShape();
-
-            spriteShape.FillBrush(CreateBrushFromBrushInfo(compositor, presentation.Fill));
-            spriteShape.StrokeBrush(CreateBrushFromBrushInfo(compositor, presentation.Stroke));
-            spriteShape.StrokeThickness(presentation.StrokeWidth);
-
-            currentShape.Shapes().Append(spriteShape);
-        }
-        else if (tag == L"g") { }
-        else if (tag == L"path")
-        {
-            winrt::com_ptr<ID2D1SvgAttribute> attribute;
-            winrt::check_hresult(current->GetAttributeValue(L"d", attribute.put()));
-            auto pathAttribute = attribute.as<ID2D1SvgPathData>();
-            winrt::com_ptr<ID2D1PathGeometry1> d2dGeometry;
-            winrt::check_hresult(pathAttribute->CreatePathGeometry(D2D1_FILL_MODE_ALTERNATE, d2dGeometry.put()));
-            auto geometrySource = winrt::make<util::GeometrySource>(d2dGeometry);
-            auto compositionPath = winrt::CompositionPath(geometrySource);
-            auto pathGeometry = compositor.CreatePathGeometry(compositionPath);
-            auto spriteShape = compositor.CreateSpriteShape(pathGeometry);
-
-            spriteShape.FillBrush(CreateBrushFromBrushInfo(compositor, presentation.Fill));
-            spriteShape.StrokeBrush(CreateBrushFromBrushInfo(compositor, presentation.Stroke));
-            spriteShape.StrokeThickness(presentation.StrokeWidth);
-
-            currentShape.Shapes().Append(spriteShape);
-        }
-        // Currently these are handled elsewhere.
-        else if (tag == L"stop") {}
-        else if (tag == L"linearGradient") {}
-        else if (tag == L"radialGradient") {}
-        else
-        {
-            // Record unknown tags for debugging purposes
-            std::wstringstream message;
-            message << L"Unknown tag: " << tag.c_str() << std::endl;
-            OutputDebugStringW(message.str().c_str());
-        }
-
-        presentationStack.push(presentation);
-
-        // Process children
-        if (current->HasChildren())
-        {
-            winrt::com_ptr<ID2D1SvgElement> child;
-            current->GetFirstChild(child.put());
-            while (child != nullptr)
-            {
-                ProcessSvgElement(presentationStack, currentShape, child);
-                winrt::com_ptr<ID2D1SvgElement> newChild;
-                winrt::check_hresult(current->GetNextChild(child.get(), newChild.put()));
-                child = newChild;
-            }
+            sink->EndFigure(D2D1_FIGURE_END_OPEN);
         }
+        winrt::check_hresult(sink->Close());
 
-        presentationStack.pop();
+        auto geometrySource = winrt::make<util::GeometrySource>(d2dGeometry);
+        auto compositionPath = winrt::CompositionPath(geometrySource);
+        return compositor.CreatePathGeometry(compositionPath);
     }
-}
-
-std::shared_ptr<SvgShapesBuilder::IBrushInfo> SvgShapesBuilder::GetBrushInfo(
-    winrt::com_ptr<ID2D1SvgElement> const& element, 
-    std::wstring const& attributeName)
-{
-    winrt::com_ptr<ID2D1SvgAttribute> attribute;
-    winrt::check_hresult(element->GetAttributeValue(attributeName.c_str(), attribute.put()));
-    if (auto paintAttribute = attribute.try_as<ID2D1SvgPaint>())
+    case CardGeometry::NodeType::Rectangle:
     {
-        switch (paintAttribute->GetPaintType())
-        {
-        case D2D1_SVG_PAINT_TYPE_COLOR:
-        {
-            D2D1_COLOR_F color = {};
-            paintAttribute->GetColor(&color);
-            return std::make_shared<ColorBrushInfo>(D2DColorToWinRTColor(color));
-        }
-        case D2D1_SVG_PAINT_TYPE_URI:
-        {
-            uint32_t length = 0;
-            winrt::check_hresult(paintAttribute->GetIdLength());
-            std::wstring id(length + 1, 0);
-            winrt::check_hresult(paintAttribute->GetId(id.data(), length));
-            id.resize(length);
-            winrt::com_ptr<ID2D1SvgDocument> document;
-            element->GetDocument(document.put());
-            return CreateBrushInfoFromId(document, id);
-        }
-        default:
-            break;
-        }
+        auto geometry = compositor.CreateRectangleGeometry();
+        geometry.Offset({ params[0], params[1] });
+        geometry.Size({ params[2], params[3] });
+        return geometry;
     }
-    return nullptr;
-}
-
-std::shared_ptr<SvgShapesBuilder::IBrushInfo> SvgShapesBuilder::CreateBrushInfoFromId(
-    winrt::com_ptr<ID2D1SvgDocument> const& document,
-    std::wstring const& id)
-{
-    winrt::com_ptr<ID2D1SvgElement> reference;
-    winrt::check_hresult(document->FindElementById(id.c_str(), reference.put()));
-    auto tag = GetTag(reference);
-    if (tag == L"linearGradient")
+    case CardGeometry::NodeType::RoundedRectangle:
     {
-        return CreateLinearGradientBrushInfo(reference);
+        auto geometry = compositor.CreateRoundedRectangleGeometry();
+        geometry.Offset({ params[0], params[1] });
+        geometry.Size({ params[2], params[3] });
+        geometry.CornerRadius({ params[4], params[5] });
+        return geometry;
     }
-    return nullptr;
-}
-
-std::shared_ptr<SvgShapesBuilder::IBrushInfo> SvgShapesBuilder::CreateLinearGradientBrushInfo(
-    winrt::com_ptr<ID2D1SvgElement> const& element)
-{
-    std::vector<GradientStopInfo> stops;
-    if (element->HasChildren())
+    case CardGeometry::NodeType::Ellipse:
     {
-        winrt::com_ptr<ID2D1SvgElement> child;
-        element->GetFirstChild(child.put());
-        while (child != nullptr)
-        {
-            auto current = child;
-            if (!current->IsTextContent())
-            {
-                auto offset = GetFloatAttribute(current, L"offset");
-                auto color = GetColorAttribute(current, L"stop-color");
-                auto stop = GradientStopInfo{ offset, color };
-                stops.push_back(stop);
-            }
-        }
+        auto geometry = compositor.CreateEllipseGeometry();
+        geometry.Center({ params[0], params[1] });
+        geometry.Radius({ params[2], params[3] });
+        return geometry;
+    }
+    default:
+        throw winrt::hresult_invalid_argument(L"Node doesn't have geometry");
     }
-    return std::make_shared<LinearGradientBrushInfo>(stops);
-}
-
-winrt::CompositionBrush SvgShapesBuilder::CreateBrushFromBrushInfo(
-    winrt::Compositor const& compositor, 
-    std::shared_ptr<IBrushInfo> const& brushInfo)
-{
-    return brushInfo == nullptr ? nullptr : brushInfo->CreateBrush(compositor);
 }
 
-winrt::CompositionBrush SvgShapesBuilder::ColorBrushInfo::CreateBrush(winrt::Compositor const& compositor)
+winrt::CompositionBrush CreateBrushFromGeometry(
+    winrt::Compositor const& compositor,
+    CardGeometry::DocumentView const& document,
+    int32_t brushIndex)
 {
-    return compositor.CreateColorBrush(Color);
-}
+    if (brushIndex == CardGeometry::NoBrush)
+    {
+        return nullptr;
+    }
 
-winrt::CompositionBrush SvgShapesBuilder::LinearGradientBrushInfo::CreateBrush(winrt::Compositor const& compositor)
-{
-    auto brush = compositor.CreateLinearGradientBrush();
-    auto colorStops = brush.ColorStops();
-    for (auto&& stop : Stops)
+    auto& brush = document.Brushes[brushIndex];
+    if (brush.Type == CardGeometry::BrushType::LinearGradient)
     {
-        auto compositionStop = compositor.CreateColorGradientStop(stop.Offset, stop.Color);
-        colorStops.Append(compositionStop);
+        auto gradientBrush = compositor.CreateLinearGradientBrush();
+        auto colorStops = gradientBrush.ColorStops();
+        for (auto i = 0u; i < brush.StopCount; i++)
+        {
+            auto& stop = document.Stops[brush.FirstStop + i];
+            colorStops.Append(compositor.CreateColorGradientStop(stop.Offset, GeometryColorToWinRTColor(stop.Color)));
+        }
+        return gradientBrush;
     }
-    return brush;
+    return compositor.CreateColorBrush(GeometryColorToWinRTColor(brush.Color));
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include "CardGeometry.h"
+#include "ShapeSink.h"
 
 struct SvgCompositionShapes
 {
@@ -6,67 +8,70 @@ struct SvgCompositionShapes
     winrt::Windows::UI::Composition::CompositionContainerShape RootShape;
 };
 
-class SvgShapesBuilder 
+// The composition objects behind ShapeSink::SharedResources. Sprites with
+// the same geometry or brush share one of these across every document
+// converted with the same cache. Shapes can only have one parent, so this
+// is as far as sharing goes.
+struct SharedResourceCache
+{
+    ShapeSink::SharedResources Ids;
+    std::vector<winrt::Windows::UI::Composition::CompositionGeometry> Geometry;
+    std::vector<winrt::Windows::UI::Composition::CompositionBrush> Brushes;
+};
+
+// Builds composition shapes, Shapes() holds the last document's
+class CompositionShapeSink : public IShapeSink
 {
 public:
-    static SvgCompositionShapes ConvertSvgDocumentToCompositionShapes(
+    CompositionShapeSink(
         winrt::Windows::UI::Composition::Compositor const& compositor,
-        winrt::com_ptr<ID2D1SvgDocument> const& document);
-
-private:
-    SvgShapesBuilder() {}
-
-    struct IBrushInfo
-    {
-        virtual winrt::Windows::UI::Composition::CompositionBrush CreateBrush(winrt::Windows::UI::Composition::Compositor const& compositor) = 0;
-    };
-
-    struct ColorBrushInfo : public IBrushInfo
-    {
-        winrt::Windows::UI::Color Color;
-
-        ColorBrushInfo(winrt::Windows::UI::Color color) { Color = color; }
-        winrt::Windows::UI::Composition::CompositionBrush CreateBrush(winrt::Windows::UI::Composition::Compositor const& compositor) override;
-    };
-
-    struct GradientStopInfo
-    {
-        float Offset;
-        winrt::Windows::UI::Color Color;
-    };
-
-    struct LinearGradientBrushInfo : public IBrushInfo
-    {
-        std::vector<GradientStopInfo> Stops;
+        winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+        SharedResourceCache& resourceCache);
 
-        LinearGradientBrushInfo(std::vector<GradientStopInfo> stops) { Stops = stops; }
-        winrt::Windows::UI::Composition::CompositionBrush CreateBrush(winrt::Windows::UI::Composition::Compositor const& compositor) override;
-    };
+    // The view box is null for documents without one
+    SvgCompositionShapes Shapes() const;
 
-    struct Presentation
-    {
-        std::shared_ptr<IBrushInfo> Fill;
-        std::shared_ptr<IBrushInfo> Stroke;
-        float StrokeWidth;
-    };
+    void BeginDocument() override;
+    void SetViewBox(CardGeometry::ViewBox const& viewBox) override;
+    uint32_t CreateGeometry(CardGeometry::DocumentView const& document, CardGeometry::Node const& node) override;
+    uint32_t CreateBrush(CardGeometry::DocumentView const& document, int32_t brushIndex) override;
+    void AddContainer(int32_t parent, CardGeometry::Matrix const* transform) override;
+    void AddSprite(
+        int32_t parent,
+        CardGeometry::Matrix const* transform,
+        uint32_t geometry,
+        uint32_t fillBrush,
+        uint32_t strokeBrush,
+        float strokeWidth) override;
 
-    static void ProcessSvgElement(
-        std::stack<Presentation>& presentationStack,
-        winrt::Windows::UI::Composition::CompositionContainerShape const& parentShape,
-        winrt::com_ptr<ID2D1SvgElement> const& element);
-
-    static std::shared_ptr<IBrushInfo> GetBrushInfo(
-        winrt::com_ptr<ID2D1SvgElement> const& element,
-        std::wstring const& attributeName);
-
-    static std::shared_ptr<IBrushInfo> CreateBrushInfoFromId(
-        winrt::com_ptr<ID2D1SvgDocument> const& document,
-        std::wstring const& id);
+private:
+    void AddShape(
+        int32_t parent,
+        CardGeometry::Matrix const* transform,
+        winrt::Windows::UI::Composition::CompositionShape const& shape);
+    winrt::Windows::UI::Composition::CompositionBrush GetBrush(uint32_t brush) const;
 
-    static std::shared_ptr<IBrushInfo> CreateLinearGradientBrushInfo(
-        winrt::com_ptr<ID2D1SvgElement> const& element);
+private:
+    winrt::Windows::UI::Composition::Compositor m_compositor{ nullptr };
+    winrt::com_ptr<ID2D1Factory1> m_d2dFactory;
+    SharedResourceCache& m_resourceCache;
+    winrt::Windows::UI::Composition::CompositionViewBox m_viewBox{ nullptr };
+    // By node index, null for sprites
+    std::vector<winrt::Windows::UI::Composition::CompositionContainerShape> m_containers;
+};
 
-    static winrt::Windows::UI::Composition::CompositionBrush CreateBrushFromBrushInfo(
+class SvgShapesBuilder
+{
+public:
+    // Builds a tree of shapes from parsed or precompiled geometry (see
+    // ShapeSink::Build), and counts what it created
+    static SvgCompositionShapes ConvertGeometryToCompositionShapes(
         winrt::Windows::UI::Composition::Compositor const& compositor,
-        std::shared_ptr<IBrushInfo> const& brushInfo);
-};
\ No newline at end of file
+        winrt::com_ptr<ID2D1Factory1> const& d2dFactory,
+        SharedResourceCache& resourceCache,
+        CardGeometry::DocumentView const& document,
+        ShapeCounts& counts);
+
+private:
+    SvgShapesBuilder() {}
+};
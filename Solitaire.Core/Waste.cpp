@@ -17,7 +17,12 @@ namespace winrt
 
 void Waste::SetLayoutOptions(float horizontalOffset)
 {
-    m_horizontalOffset = horizontalOffset;
+    if (m_horizontalOffset != horizontalOffset)
+    {
+        m_horizontalOffset = horizontalOffset;
+        // Only the fanned out cards at the end depend on the offset
+        InvalidateLayout(static_cast<int>(m_itemContainers.size()) - 3);
+    }
 }
 
 Pile::CardList Waste::Flush()
@@ -82,21 +87,6 @@ winrt::float3 Waste::ComputeOffset(int index, int totalCards)
     return { 0, 0, 0 };
 }
 
-winrt::float3 Waste::ComputeBaseSpaceOffset(int index, int totalCards)
-{
-    WINRT_ASSERT(index < totalCards);
-    auto numCardsToFan = 3;
-    if (totalCards < numCardsToFan)
-    {
-        numCardsToFan = totalCards;
-    }
-    if (index > totalCards - numCardsToFan)
-    {
-        return { (index - (totalCards - numCardsToFan)) * m_horizontalOffset, 0, 0 };
-    }
-    return { 0, 0, 0 };
-}
-
 void Waste::OnRemovalCompleted(Pile::RemovalOperation operation)
 {
     auto numCardsFromBack = 3;
@@ -20,7 +20,46 @@ public:
         bool isControlDown) = 0;
 };
 
+// Times a piece of startup work until it goes out of scope. Spans nest,
+// and the trace is written out once every card face has loaded. The
+// first span starts the clock, so begin one before anything else.
+class StartupSpan
+{
+public:
+    StartupSpan(char const* name);
+    ~StartupSpan();
+    StartupSpan(StartupSpan const&) = delete;
+    StartupSpan& operator=(StartupSpan const&) = delete;
+
+private:
+    size_t m_span;
+};
+
+// How card faces are put on screen
+enum class CardFaceRendering
+{
+    // A tree of composition shapes per face
+    Shapes,
+    // Drawn on the CPU into one texture and shown as sprites, cheaper to
+    // compose on machines that struggle with many vector shapes
+    Raster,
+};
+
+// What CreateSolitaireAsync waits for before the board goes up. Card
+// faces always load in the background, and show a blank card until then.
+enum class StartupMode
+{
+    // Nothing, the card back and empty pile are drawn in code and the
+    // faces' bundle, archive or folder is opened in the background. The
+    // game takes input straight away.
+    Progressive,
+    // The faces' bundle, archive or folder and the disk cache are open
+    WaitForAssets,
+};
+
 std::future<std::shared_ptr<ISolitaire>> CreateSolitaireAsync(
     winrt::Windows::UI::Composition::ContainerVisual parentVisual,
     winrt::Windows::Foundation::Numerics::float2 parentSize,
-    winrt::Windows::Storage::StorageFolder assetsFolder);
\ No newline at end of file
+    winrt::Windows::Storage::StorageFolder assetsFolder,
+    CardFaceRendering rendering = CardFaceRendering::Shapes,
+    StartupMode startupMode = StartupMode::Progressive);
\ No newline at end of file
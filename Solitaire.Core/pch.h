@@ -11,6 +11,7 @@
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.Foundation.Numerics.h>
+#include <winrt/Windows.Graphics.DirectX.h>
 #include <winrt/Windows.ApplicationModel.Core.h>
 #include <winrt/Windows.Storage.h>
 #include <winrt/Windows.Storage.Streams.h>
@@ -33,6 +34,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <algorithm>
 #include <random>
@@ -41,6 +43,10 @@
 #include <type_traits>
 #include <sstream>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
 
 // Common
 #include "robmikh.common/composition.interop.h"
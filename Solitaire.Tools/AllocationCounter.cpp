@@ -0,0 +1,117 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+namespace
+{
+    std::atomic<size_t> g_allocations = 0;
+    std::atomic<size_t> g_bytes = 0;
+
+    void* CountedAllocate(size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+        // malloc(0) is allowed to return null, new isn't
+        if (auto result = malloc(size == 0 ? 1 : size))
+        {
+            return result;
+        }
+        throw std::bad_alloc();
+    }
+
+    // The polymorphic allocators go through the aligned versions. Not every
+    // C runtime has aligned_alloc, so over-allocate and keep what malloc
+    // returned just in front of the aligned pointer.
+    void* CountedAllocateAligned(size_t size, std::align_val_t alignment)
+    {
+        auto align = static_cast<size_t>(alignment);
+        auto raw = static_cast<char*>(CountedAllocate(size + align + sizeof(void*)));
+        auto aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + align - 1) & ~static_cast<uintptr_t>(align - 1));
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return aligned;
+    }
+
+    void FreeAligned(void* pointer)
+    {
+        if (pointer != nullptr)
+        {
+            free(static_cast<void**>(pointer)[-1]);
+        }
+    }
+}
+
+void* operator new(size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return CountedAllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return CountedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+namespace AllocationCounter
+{
+    Snapshot Current()
+    {
+        return { g_allocations.load(std::memory_order_relaxed), g_bytes.load(std::memory_order_relaxed) };
+    }
+
+    Snapshot Since(Snapshot const& start)
+    {
+        auto current = Current();
+        return { current.Allocations - start.Allocations, current.Bytes - start.Bytes };
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+// Counts calls to the global operator new, so benchmarks can report how
+// much a piece of code allocates. Linking AllocationCounter.cpp replaces
+// operator new/delete for the whole program.
+namespace AllocationCounter
+{
+    struct Snapshot
+    {
+        size_t Allocations;
+        size_t Bytes;
+    };
+
+    Snapshot Current();
+    // What was allocated since the snapshot was taken
+    Snapshot Since(Snapshot const& start);
+}
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "AssetArchive.h"
+#include "Commands.h"
+#include "MappedFile.h"
+#include "SourceFiles.h"
+
+namespace fs = std::filesystem;
+
+int RunArchive(CommandArgs const& args)
+{
+    if (args.size() != 2)
+    {
+        fprintf(stderr, "Usage: archive <CardFaces directory> <output file>\n");
+        return 1;
+    }
+    auto const& inputDirectory = args[0];
+    auto const& outputPath = args[1];
+
+    // Every card has to be there, the game only falls back to the loose
+    // files when it can't use the archive at all
+    auto start = std::chrono::steady_clock::now();
+    AssetArchive::Writer writer;
+    size_t inputBytes = 0;
+    for (auto i = 0u; i < AssetArchive::CardCount; i++)
+    {
+        auto path = fs::path(inputDirectory) / (std::string(AssetArchive::CardAssetName(i)) + ".svg");
+        try
+        {
+            auto contents = ReadFile(path);
+            if (contents.empty())
+            {
+                fprintf(stderr, "%s is empty\n", path.string().c_str());
+                return 1;
+            }
+            inputBytes += contents.size();
+            writer.Add(i, std::move(contents));
+        }
+        catch (std::exception const& error)
+        {
+            fprintf(stderr, "%s\n", error.what());
+            return 1;
+        }
+    }
+
+    auto archive = writer.Serialize();
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<char const*>(archive.data()), archive.size());
+    output.close();
+    if (!output)
+    {
+        fprintf(stderr, "Couldn't write %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Wrote %s: %u files, %zu bytes from %zu bytes of SVG in %.1f ms\n",
+        outputPath.c_str(), AssetArchive::CardCount, archive.size(), inputBytes, elapsed);
+    return 0;
+}
+
+int RunArchiveInfo(CommandArgs const& args)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        fprintf(stderr, "Usage: archive-info <archive file> [CardFaces directory]\n");
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(args[0]))
+    {
+        fprintf(stderr, "Couldn't map %s\n", args[0].c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AssetArchive::Reader reader;
+    std::string error;
+    if (!reader.Open(file.Data(), file.Size(), error))
+    {
+        fprintf(stderr, "%s: %s\n", args[0].c_str(), error.c_str());
+        return 1;
+    }
+    auto openTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto& header = reader.GetHeader();
+    printf("Format version: %u\n", header.Version);
+    printf("Size:           %llu bytes\n", static_cast<unsigned long long>(header.FileSize));
+    printf("Content hash:   %016llx\n", static_cast<unsigned long long>(header.ContentHash));
+    printf("Open+validate:  %.3f ms\n", openTime);
+    printf("\n");
+
+    auto result = 0;
+    for (auto i = 0u; i < AssetArchive::CardCount; i++)
+    {
+        auto& entry = reader.GetEntry(i);
+        if (entry.Length == 0)
+        {
+            fprintf(stderr, "%-24s missing\n", AssetArchive::CardAssetName(i));
+            result = 1;
+            continue;
+        }
+        printf("%-24s %2u %9llu bytes at %9llu\n", AssetArchive::CardAssetName(i), i,
+            static_cast<unsigned long long>(entry.Length), static_cast<unsigned long long>(entry.Offset));
+    }
+
+    if (!reader.Verify(error))
+    {
+        fprintf(stderr, "\n%s, the archive is corrupt\n", error.c_str());
+        result = 1;
+    }
+    if (args.size() == 2)
+    {
+        auto stale = 0u;
+        for (auto i = 0u; i < AssetArchive::CardCount; i++)
+        {
+            auto path = fs::path(args[1]) / (std::string(AssetArchive::CardAssetName(i)) + ".svg");
+            std::string_view contents;
+            if (!fs::exists(path) || !reader.TryGet(i, contents) || ReadFile(path) != contents)
+            {
+                fprintf(stderr, "%s differs from %s\n", AssetArchive::CardAssetName(i), path.string().c_str());
+                stale++;
+            }
+        }
+        if (stale > 0)
+        {
+            fprintf(stderr, "\nThe archive is out of date with %s (%u files)\n", args[1].c_str(), stale);
+            result = 1;
+        }
+        else
+        {
+            printf("\nUp to date with %s\n", args[1].c_str());
+        }
+    }
+    return result;
+}
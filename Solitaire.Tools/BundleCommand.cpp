@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "DetailLevels.h"
+#include "GeometryBundle.h"
+#include "GeometryFlattener.h"
+#include "GeometrySimplifier.h"
+#include "MappedFile.h"
+#include "ShapeSink.h"
+#include "SourceFiles.h"
+#include "SvgGeometryConverter.h"
+
+namespace
+{
+    uint64_t HashSources(std::vector<SourceFile> const& files)
+    {
+        auto hash = CardGeometry::HashSeed;
+        for (auto& file : files)
+        {
+            hash = CardGeometry::HashBytes(file.Name.data(), file.Name.size() + 1, hash);
+            hash = CardGeometry::HashBytes(file.Contents.data(), file.Contents.size(), hash);
+        }
+        return hash;
+    }
+
+    GeometrySimplifier::Counts Add(GeometrySimplifier::Counts const& left, GeometrySimplifier::Counts const& right)
+    {
+        GeometrySimplifier::Counts sum;
+        sum.Sprites = left.Sprites + right.Sprites;
+        sum.Segments = left.Segments + right.Segments;
+        sum.Points = left.Points + right.Points;
+        return sum;
+    }
+
+    size_t DocumentBytes(CardGeometry::DocumentView const& document)
+    {
+        return document.Nodes.Size * sizeof(CardGeometry::Node) +
+            document.Segments.Size * sizeof(CardGeometry::SegmentType) +
+            document.Points.Size * sizeof(CardGeometry::Point) +
+            document.Brushes.Size * sizeof(CardGeometry::Brush) +
+            document.Stops.Size * sizeof(CardGeometry::GradientStop);
+    }
+
+    // Tallies how much of the geometry repeats across documents
+    class SharingReport
+    {
+    public:
+        void Add(CardGeometry::DocumentView const& document)
+        {
+            auto subtrees = CardGeometry::HashSubtrees(document);
+            m_subtrees.insert(subtrees.begin(), subtrees.end());
+            m_nodes += document.Nodes.Size;
+            for (auto& node : document.Nodes)
+            {
+                if (node.Type == CardGeometry::NodeType::Container)
+                {
+                    continue;
+                }
+                auto bytes = node.SegmentCount * sizeof(CardGeometry::SegmentType) + node.PointCount * sizeof(CardGeometry::Point);
+                m_geometry.emplace(CardGeometry::HashGeometry(document, node), bytes);
+                m_sprites++;
+                m_geometryBytes += bytes;
+                for (auto brush : { node.FillBrush, node.StrokeBrush })
+                {
+                    if (brush != CardGeometry::NoBrush)
+                    {
+                        m_brushes.insert(CardGeometry::HashBrush(document, brush));
+                        m_brushUses++;
+                    }
+                }
+            }
+        }
+
+        void Print() const
+        {
+            size_t uniqueBytes = 0;
+            for (auto& [hash, bytes] : m_geometry)
+            {
+                uniqueBytes += bytes;
+            }
+            printf("Subtrees: %zu unique of %zu\n", m_subtrees.size(), m_nodes);
+            printf("Geometry: %zu unique of %zu sprites, %zu of %zu KB (%zu KB and %zu composition geometries saved)\n",
+                m_geometry.size(), m_sprites, uniqueBytes / 1024, m_geometryBytes / 1024,
+                (m_geometryBytes - uniqueBytes) / 1024, m_sprites - m_geometry.size());
+            printf("Brushes:  %zu unique of %zu fills and strokes\n", m_brushes.size(), m_brushUses);
+        }
+
+    private:
+        std::unordered_set<uint64_t> m_subtrees;
+        std::unordered_map<uint64_t, size_t> m_geometry;
+        std::unordered_set<uint64_t> m_brushes;
+        size_t m_brushUses = 0;
+        size_t m_nodes = 0;
+        size_t m_sprites = 0;
+        size_t m_geometryBytes = 0;
+    };
+}
+
+int RunBundle(CommandArgs const& args)
+{
+    std::vector<std::string> positional;
+    GeometrySimplifier::Options options;
+    for (auto i = 0u; i < args.size(); i++)
+    {
+        if (args[i] == "--tolerance" && i + 1 < args.size())
+        {
+            options.Tolerance = std::stof(args[++i]);
+        }
+        else
+        {
+            positional.push_back(args[i]);
+        }
+    }
+    if (positional.size() != 2)
+    {
+        fprintf(stderr, "Usage: bundle <CardFaces directory> <output file> [--tolerance <units>]\n");
+        return 1;
+    }
+    auto const& inputDirectory = positional[0];
+    auto const& outputPath = positional[1];
+
+    auto start = std::chrono::steady_clock::now();
+    auto files = ReadSvgFiles(inputDirectory);
+    if (files.empty())
+    {
+        fprintf(stderr, "No .svg files found in %s\n", inputDirectory.c_str());
+        return 1;
+    }
+
+    // Simplified for the card's size (see GeometrySimplifier), then
+    // flattened (see GeometryFlattener)
+    CardGeometry::CardShapeMetrics metrics;
+    options.TargetWidth = metrics.Width;
+    options.TargetHeight = metrics.Height;
+    printf("%-24s %15s %15s %17s %13s %13s %9s\n", "", "sprites", "segments", "geometry KB", "bundle KB", "nodes", "depth");
+
+    GeometryBundle::Writer writer;
+    SharingReport sharing;
+    // The full detail faces, back and empty pile built the way ShapeCache
+    // builds them, for what they'll cost once they're shapes
+    ShapeSink::SharedResources shapeResources;
+    SerializingShapeSink shapeStream;
+    CountingShapeSink shapeCounter(&shapeStream);
+    // What each level of detail adds up to across the cards
+    GeometrySimplifier::Counts levelCounts[DetailLevels::Count] = {};
+    size_t levelNodes[DetailLevels::Count] = {};
+    GeometrySimplifier::Counts before;
+    GeometrySimplifier::Counts after;
+    GeometryFlattener::Stats flattened;
+    size_t inputBytes = 0;
+    for (auto& file : files)
+    {
+        if (DetailLevels::EntryName(file.Name, DetailLevels::Count - 1).size() > GeometryBundle::MaxNameLength)
+        {
+            fprintf(stderr, "%s: name is too long\n", file.Name.c_str());
+            return 1;
+        }
+        try
+        {
+            auto converted = SvgGeometryConverter::Convert(file.Contents.data(), file.Contents.size());
+            GeometrySimplifier::Stats stats;
+            auto simplified = GeometrySimplifier::Simplify(converted.View(), options, stats);
+            GeometryFlattener::Stats flattenStats;
+            auto document = GeometryFlattener::Flatten(simplified.View(), flattenStats);
+            printf("%-24s %6zu -> %5zu %7zu -> %6zu %7zu -> %6zu %6zu -> %4zu %5zu -> %4zu %3zu -> %2zu\n",
+                file.Name.c_str(),
+                stats.Before.Sprites, stats.After.Sprites,
+                stats.Before.Segments, stats.After.Segments,
+                stats.Before.GeometryBytes() / 1024, stats.After.GeometryBytes() / 1024,
+                DocumentBytes(converted.View()) / 1024, DocumentBytes(document.View()) / 1024,
+                converted.Nodes.size(), flattenStats.NodesAfter,
+                GeometryFlattener::Depth(converted.View()), flattenStats.DepthAfter);
+            writer.Add(file.Name, document);
+            sharing.Add(document.View());
+            ShapeSink::Build(document.View(), shapeResources, shapeCounter);
+            levelCounts[0] = Add(levelCounts[0], stats.After);
+            levelNodes[0] += document.Nodes.size();
+
+            // The other levels start over from the converted document,
+            // simplifying a simplified one would compound the error
+            for (auto level = 1u; level < DetailLevels::Count; level++)
+            {
+                GeometrySimplifier::Stats levelStats;
+                auto levelSimplified = GeometrySimplifier::Simplify(converted.View(), DetailLevels::LevelOptions(options, level), levelStats);
+                GeometryFlattener::Stats levelFlattenStats;
+                auto levelDocument = GeometryFlattener::Flatten(levelSimplified.View(), levelFlattenStats);
+                writer.Add(DetailLevels::EntryName(file.Name, level), levelDocument);
+                levelCounts[level] = Add(levelCounts[level], levelStats.After);
+                levelNodes[level] += levelDocument.Nodes.size();
+            }
+            before.Sprites += stats.Before.Sprites;
+            before.Segments += stats.Before.Segments;
+            before.Points += stats.Before.Points;
+            after.Sprites += stats.After.Sprites;
+            after.Segments += stats.After.Segments;
+            after.Points += stats.After.Points;
+            flattened.NodesBefore += converted.Nodes.size();
+            flattened.NodesAfter += flattenStats.NodesAfter;
+            flattened.DepthBefore = std::max(flattened.DepthBefore, GeometryFlattener::Depth(converted.View()));
+            flattened.DepthAfter = std::max(flattened.DepthAfter, flattenStats.DepthAfter);
+            inputBytes += file.Contents.size();
+        }
+        catch (std::exception const& error)
+        {
+            fprintf(stderr, "%s: %s\n", file.Name.c_str(), error.what());
+            return 1;
+        }
+    }
+
+    printf("%-24s %6zu -> %5zu %7zu -> %6zu %7zu -> %6zu %14s %5zu -> %4zu %3zu -> %2zu\n", "total",
+        before.Sprites, after.Sprites, before.Segments, after.Segments,
+        before.GeometryBytes() / 1024, after.GeometryBytes() / 1024, "",
+        flattened.NodesBefore, flattened.NodesAfter, flattened.DepthBefore, flattened.DepthAfter);
+
+    auto back = CardGeometry::BuildCardBack(metrics);
+    auto emptyPile = CardGeometry::BuildEmptyPile(metrics);
+    writer.Add(GeometryBundle::CardBackName, back);
+    writer.Add(GeometryBundle::EmptyPileName, emptyPile);
+    ShapeSink::Build(back.View(), shapeResources, shapeCounter);
+    ShapeSink::Build(emptyPile.View(), shapeResources, shapeCounter);
+
+    printf("\n");
+    for (auto level = 0u; level < DetailLevels::Count; level++)
+    {
+        auto& counts = levelCounts[level];
+        printf("Level %u (scale %.2f, tolerance %g): %5zu sprites %7zu segments %5zu KB of geometry %5zu nodes\n",
+            level, DetailLevels::Scales[level], DetailLevels::LevelOptions(options, level).Tolerance,
+            counts.Sprites, counts.Segments, counts.GeometryBytes() / 1024, levelNodes[level]);
+    }
+
+    auto bundle = writer.Serialize(HashSources(files));
+    printf("\n");
+    sharing.Print();
+    printf("Bundle:   %zu unique of %zu paths stored\n", writer.UniquePathCount(), writer.PathCount());
+    auto& shapes = shapeCounter.Counts();
+    printf("Shapes:   %zu containers, %zu sprites, %zu geometries, %zu brushes, about %zu KB as composition objects, %zu bytes serialized\n",
+        shapes.ContainerShapes, shapes.SpriteShapes, shapes.PathGeometries + shapes.OtherGeometries, shapes.Brushes,
+        shapes.Bytes / 1024, shapeStream.Data().size());
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<char const*>(bundle.data()), bundle.size());
+    output.close();
+    if (!output)
+    {
+        fprintf(stderr, "Couldn't write %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\nWrote %s: %zu documents, %zu bytes from %zu bytes of SVG in %.1f ms (tolerance %g)\n",
+        outputPath.c_str(), files.size() * DetailLevels::Count + 2, bundle.size(), inputBytes, elapsed, options.Tolerance);
+    return 0;
+}
+
+int RunBundleInfo(CommandArgs const& args)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        fprintf(stderr, "Usage: bundle-info <bundle file> [CardFaces directory]\n");
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(args[0]))
+    {
+        fprintf(stderr, "Couldn't map %s\n", args[0].c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    GeometryBundle::Reader reader;
+    std::string error;
+    if (!reader.Open(file.Data(), file.Size(), error))
+    {
+        fprintf(stderr, "%s: %s\n", args[0].c_str(), error.c_str());
+        return 1;
+    }
+    auto openTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto& header = reader.GetHeader();
+    printf("Format version: %u\n", header.Version);
+    printf("Size:           %llu bytes\n", static_cast<unsigned long long>(header.FileSize));
+    printf("Source hash:    %016llx\n", static_cast<unsigned long long>(header.SourceHash));
+    printf("Content hash:   %016llx\n", static_cast<unsigned long long>(header.ContentHash));
+    printf("Open+validate:  %.3f ms\n", openTime);
+    if (reader.EntryCount() > 0)
+    {
+        // Every entry shares the same geometry arrays
+        auto document = reader.GetDocument(0);
+        printf("Geometry:       %zu segments, %zu points\n", document.Segments.Size, document.Points.Size);
+    }
+    printf("\n");
+    for (auto i = 0u; i < reader.EntryCount(); i++)
+    {
+        auto document = reader.GetDocument(i);
+        size_t segments = 0;
+        for (auto& node : document.Nodes)
+        {
+            segments += node.SegmentCount;
+        }
+        printf("%-24s %6zu nodes %7zu segments %3zu brushes\n",
+            reader.GetEntry(i).Name, document.Nodes.Size, segments, document.Brushes.Size);
+    }
+
+    auto result = 0;
+    if (!reader.VerifyContentHash())
+    {
+        fprintf(stderr, "\nContent hash mismatch, the bundle is corrupt\n");
+        result = 1;
+    }
+    if (args.size() == 2)
+    {
+        if (HashSources(ReadSvgFiles(args[1])) != header.SourceHash)
+        {
+            fprintf(stderr, "\nThe bundle is out of date with %s\n", args[1].c_str());
+            result = 1;
+        }
+        else
+        {
+            printf("\nUp to date with %s\n", args[1].c_str());
+        }
+    }
+    return result;
+}
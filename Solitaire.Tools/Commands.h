@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Each command receives the arguments that follow its name and returns
+// the process exit code.
+using CommandArgs = std::vector<std::string>;
+
+int RunArchive(CommandArgs const& args);
+int RunArchiveInfo(CommandArgs const& args);
+int RunLayoutBenchmark(CommandArgs const& args);
+int RunLayoutCheck(CommandArgs const& args);
+int RunBundle(CommandArgs const& args);
+int RunBundleInfo(CommandArgs const& args);
+int RunSvgBenchmark(CommandArgs const& args);
+int RunPathBenchmark(CommandArgs const& args);
+int RunShapeBenchmark(CommandArgs const& args);
+int RunProfile(CommandArgs const& args);
+int RunRaster(CommandArgs const& args);
+int RunShare(CommandArgs const& args);
+int RunTraceCheck(CommandArgs const& args);
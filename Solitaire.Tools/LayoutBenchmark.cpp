@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "BoardLayout.h"
+#include "Commands.h"
+
+namespace
+{
+    // The same layout computed the way the piles used to do it: a virtual
+    // call per card returning an offset relative to the pile's base.
+    struct PileModel
+    {
+        virtual ~PileModel() {}
+        virtual void ComputeBaseSpaceOffset(int index, int totalCards, float& x, float& y) = 0;
+
+        float OriginX = 0;
+        float OriginY = 0;
+        int Count = 0;
+    };
+
+    struct StackModel : PileModel
+    {
+        float VerticalOffset = 0;
+        void ComputeBaseSpaceOffset(int index, int, float& x, float& y) override
+        {
+            x = 0;
+            y = index * VerticalOffset;
+        }
+    };
+
+    struct WasteModel : PileModel
+    {
+        float HorizontalOffset = 0;
+        void ComputeBaseSpaceOffset(int index, int totalCards, float& x, float& y) override
+        {
+            auto numCardsToFan = totalCards < 3 ? totalCards : 3;
+            x = index > totalCards - numCardsToFan ? (index - (totalCards - numCardsToFan)) * HorizontalOffset : 0;
+            y = 0;
+        }
+    };
+
+    struct StaticModel : PileModel
+    {
+        void ComputeBaseSpaceOffset(int, int, float& x, float& y) override
+        {
+            x = 0;
+            y = 0;
+        }
+    };
+
+    // Card counts for the deck, waste, 4 foundations and 7 stacks. Adds up to 52.
+    std::vector<int> CreateBoard(std::mt19937& rng)
+    {
+        std::vector<int> counts(BoardLayout::MaxPiles, 0);
+        for (auto card = 0; card < BoardLayout::MaxCards; card++)
+        {
+            counts[rng() % counts.size()]++;
+        }
+        return counts;
+    }
+
+    PileKind KindForPile(int pile)
+    {
+        if (pile == 0)
+        {
+            return PileKind::Deck;
+        }
+        if (pile == 1)
+        {
+            return PileKind::Waste;
+        }
+        return pile < 6 ? PileKind::Foundation : PileKind::Stack;
+    }
+}
+
+int RunLayoutBenchmark(CommandArgs const& args)
+{
+    auto iterations = args.empty() ? 1000000 : std::stoi(args[0]);
+    std::mt19937 rng(1234);
+    auto counts = CreateBoard(rng);
+
+    BoardLayout layout;
+    std::vector<std::unique_ptr<PileModel>> models;
+    // The piles whose offsets change, so that only the virtual calls
+    // are timed and not finding them again every pass
+    std::vector<StackModel*> stacks;
+    std::vector<WasteModel*> wastes;
+    for (auto pile = 0; pile < BoardLayout::MaxPiles; pile++)
+    {
+        auto kind = KindForPile(pile);
+        auto originX = pile < 6 ? pile * 180.0f : (pile - 6) * 193.33f;
+        auto originY = pile < 6 ? 0.0f : 268.0f;
+        layout.AddPile(kind, originX, originY);
+        layout.SetCardCount(pile, counts[pile]);
+
+        std::unique_ptr<PileModel> model;
+        switch (kind)
+        {
+        case PileKind::Stack:
+        {
+            auto stack = std::make_unique<StackModel>();
+            stacks.push_back(stack.get());
+            model = std::move(stack);
+            break;
+        }
+        case PileKind::Waste:
+        {
+            auto waste = std::make_unique<WasteModel>();
+            wastes.push_back(waste.get());
+            model = std::move(waste);
+            break;
+        }
+        default:
+            model = std::make_unique<StaticModel>();
+            break;
+        }
+        model->OriginX = originX;
+        model->OriginY = originY;
+        model->Count = counts[pile];
+        models.push_back(std::move(model));
+    }
+
+    // Vary the offsets so nothing can be hoisted out of the loop
+    auto checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        auto offset = 30.0f + (i & 15);
+        layout.Compute({ 167.0f, 243.0f, offset, offset });
+        checksum += layout.X()[i % BoardLayout::MaxCards] + layout.Y()[(i * 7) % BoardLayout::MaxCards];
+    }
+    auto soaTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<float> x(BoardLayout::MaxCards);
+    std::vector<float> y(BoardLayout::MaxCards);
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        auto offset = 30.0f + (i & 15);
+        for (auto stack : stacks)
+        {
+            stack->VerticalOffset = offset;
+        }
+        for (auto waste : wastes)
+        {
+            waste->HorizontalOffset = offset;
+        }
+        auto slot = 0;
+        for (auto& model : models)
+        {
+            for (auto index = 0; index < model->Count; index++, slot++)
+            {
+                float offsetX = 0;
+                float offsetY = 0;
+                model->ComputeBaseSpaceOffset(index, model->Count, offsetX, offsetY);
+                x[slot] = model->OriginX + offsetX;
+                y[slot] = model->OriginY + offsetY;
+            }
+        }
+        checksum -= x[i % BoardLayout::MaxCards] + y[(i * 7) % BoardLayout::MaxCards];
+    }
+    auto virtualTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto cards = static_cast<double>(iterations) * BoardLayout::MaxCards;
+    printf("Layout passes:      %d (%d cards each)\n", iterations, BoardLayout::MaxCards);
+    printf("BoardLayout:        %8.2f ns/pass  %10.2f Mcards/s\n", soaTime * 1e9 / iterations, cards / soaTime / 1e6);
+    printf("Per-pile virtual:   %8.2f ns/pass  %10.2f Mcards/s\n", virtualTime * 1e9 / iterations, cards / virtualTime / 1e6);
+    printf("Speedup:            %8.2fx\n", virtualTime / soaTime);
+    // Both loops compute the same positions, so this should be zero
+    printf("Checksum:           %g\n", checksum);
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "Commands.h"
+#include "LayoutSolver.h"
+
+namespace
+{
+    // The sizes the game lays the board out with, see CompositionCard and
+    // GameApp. The text height is ShapeCache::TextHeight, which can't be
+    // reached from here, so it's an argument.
+    const float CardWidth = 167.0f;
+    const float CardHeight = 243.0f;
+    const float MinimumContentWidth = 1327.0f;
+    const float MinimumContentHeight = 1111.0f;
+    // Every card of a suit from the king down, under the 6 face down
+    // cards of the last column
+    const int LongestColumn = 19;
+
+    class Checker
+    {
+    public:
+        void Check(bool condition, char const* what)
+        {
+            m_checks++;
+            if (!condition)
+            {
+                m_failures++;
+                fprintf(stderr, "FAILED: %s\n", what);
+            }
+        }
+
+        int Finish() const
+        {
+            printf("%zu of %zu checks passed\n", m_checks - m_failures, m_checks);
+            return m_failures == 0 ? 0 : 1;
+        }
+
+    private:
+        size_t m_checks = 0;
+        size_t m_failures = 0;
+    };
+
+    bool IsNear(float value, float expected)
+    {
+        return std::fabs(value - expected) < 0.01f;
+    }
+
+    void PrintMetrics(char const* name, BoardMetrics const& metrics)
+    {
+        printf("%-32s spacing %7.2f  left %7.2f  play area %7.2f  stack offset %6.2f  waste offset %6.2f\n", name,
+            metrics.ColumnSpacing, metrics.BoardLeft, metrics.PlayAreaTop, metrics.CardStackVerticalOffset, metrics.WasteHorizontalOffset);
+    }
+
+    // Where the last card of a column that tall ends up
+    float ColumnBottom(BoardMetrics const& metrics, int cards)
+    {
+        return metrics.PlayAreaTop + (cards - 1) * metrics.CardStackVerticalOffset + CardHeight;
+    }
+}
+
+// Solves the board for the sizes and column heights that matter and
+// checks the spacing against what the game expects: the old fixed layout
+// at the minimum content size, clamping at either end and the tallest
+// possible column still fitting.
+int RunLayoutCheck(CommandArgs const& args)
+{
+    LayoutSolverParameters parameters;
+    parameters.CardWidth = CardWidth;
+    parameters.CardHeight = CardHeight;
+    parameters.PreferredVerticalOffset = args.empty() ? 34.0f : std::stof(args[0]);
+    if (parameters.PreferredVerticalOffset < parameters.MinimumVerticalOffset)
+    {
+        fprintf(stderr, "Usage: layout-check [text height], at least %g\n", parameters.MinimumVerticalOffset);
+        return 1;
+    }
+    LayoutSolver solver(parameters);
+    Checker checker;
+
+    // The deal at the minimum size is the layout from before the solver
+    auto deal = solver.Solve(MinimumContentWidth, MinimumContentHeight, LayoutSolver::NumberOfColumns);
+    PrintMetrics("Minimum size, dealt", deal);
+    checker.Check(IsNear(deal.ColumnSpacing, (MinimumContentWidth - 7 * CardWidth) / 6), "The columns fill the minimum width");
+    checker.Check(IsNear(deal.ColumnSpacing, 26.33f), "The minimum size keeps the old 26.33 column gap");
+    checker.Check(IsNear(deal.BoardLeft, 0), "The board starts at the left edge at the minimum width");
+    checker.Check(IsNear(deal.PlayAreaTop, CardHeight + parameters.RowSpacing), "The play area starts a row below the top");
+    checker.Check(deal.CardStackVerticalOffset == parameters.PreferredVerticalOffset, "A dealt column isn't compressed");
+    checker.Check(deal.WasteHorizontalOffset == parameters.PreferredWasteOffset, "The waste fans out fully");
+    checker.Check(deal.ColumnX(LayoutSolver::NumberOfColumns - 1) + CardWidth <= MinimumContentWidth + 0.01f, "The last column fits the minimum width");
+
+    // The longest column has to fit without leaving the board
+    auto longest = solver.Solve(MinimumContentWidth, MinimumContentHeight, LongestColumn);
+    PrintMetrics("Minimum size, 19 card column", longest);
+    checker.Check(longest.CardStackVerticalOffset >= parameters.MinimumVerticalOffset, "A 19 card column stays above the minimum offset");
+    checker.Check(ColumnBottom(longest, LongestColumn) <= MinimumContentHeight + 0.01f, "A 19 card column fits the minimum height");
+    // Small enough text fits the column as it is
+    auto uncompressed = longest;
+    uncompressed.CardStackVerticalOffset = parameters.PreferredVerticalOffset;
+    if (ColumnBottom(uncompressed, LongestColumn) > MinimumContentHeight)
+    {
+        checker.Check(longest.CardStackVerticalOffset < parameters.PreferredVerticalOffset, "A 19 card column is compressed");
+        checker.Check(IsNear(ColumnBottom(longest, LongestColumn), MinimumContentHeight), "A 19 card column uses the whole height");
+    }
+    else
+    {
+        checker.Check(longest.CardStackVerticalOffset == parameters.PreferredVerticalOffset, "A 19 card column that fits isn't compressed");
+    }
+
+    auto tall = solver.Solve(MinimumContentWidth, MinimumContentHeight * 2, LongestColumn);
+    PrintMetrics("Twice as tall, 19 card column", tall);
+    checker.Check(tall.CardStackVerticalOffset == parameters.PreferredVerticalOffset, "A column with room to spare isn't compressed");
+
+    // Clamped at the minimum offset, the column runs off the bottom
+    // rather than the cards overlapping their indices
+    auto shortBoard = solver.Solve(MinimumContentWidth, 700, LongestColumn);
+    PrintMetrics("700 high, 19 card column", shortBoard);
+    checker.Check(shortBoard.CardStackVerticalOffset == parameters.MinimumVerticalOffset, "The offset is clamped to the minimum");
+
+    auto single = solver.Solve(MinimumContentWidth, MinimumContentHeight, 1);
+    checker.Check(single.CardStackVerticalOffset == parameters.PreferredVerticalOffset, "A single card column has the preferred offset");
+
+    // Past the maximum spacing the board stays together and is centered
+    auto wide = solver.Solve(3000, MinimumContentHeight, LayoutSolver::NumberOfColumns);
+    PrintMetrics("3000 wide", wide);
+    auto wideBoard = 7 * CardWidth + 6 * parameters.MaximumColumnSpacing;
+    checker.Check(wide.ColumnSpacing == parameters.MaximumColumnSpacing, "The spacing is clamped to the maximum");
+    checker.Check(IsNear(wide.BoardLeft, (3000 - wideBoard) / 2), "A wide board is centered");
+
+    auto narrow = solver.Solve(1200, MinimumContentHeight, LayoutSolver::NumberOfColumns);
+    PrintMetrics("1200 wide", narrow);
+    checker.Check(narrow.ColumnSpacing == parameters.MinimumColumnSpacing, "The spacing is clamped to the minimum");
+    checker.Check(narrow.BoardLeft == parameters.Margin, "A narrow board starts at the margin");
+
+    // Sizes are memoized in whole units
+    auto misses = solver.CacheMisses();
+    solver.Solve(MinimumContentWidth + 0.2f, MinimumContentHeight, LongestColumn);
+    checker.Check(solver.CacheMisses() == misses && solver.CacheHits() == 1, "A fraction of a unit is a cache hit");
+    solver.Solve(MinimumContentWidth, MinimumContentHeight, LongestColumn - 1);
+    checker.Check(solver.CacheMisses() == misses + 1, "Another column height is a cache miss");
+
+    return checker.Finish();
+}
@@ -0,0 +1,299 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "SourceFiles.h"
+#include "SvgPathParser.h"
+#include "SvgPathTokenizer.h"
+#include "SvgReader.h"
+
+namespace
+{
+    class PathDataCollector : public ISvgReaderHandler
+    {
+    public:
+        std::vector<std::string>& Paths;
+
+        PathDataCollector(std::vector<std::string>& paths) : Paths(paths) {}
+
+        void OnStartElement(std::string_view tag, CardGeometry::Span<SvgAttribute> attributes, size_t) override
+        {
+            if (tag != "path")
+            {
+                return;
+            }
+            for (auto& attribute : attributes)
+            {
+                if (attribute.Name == "d")
+                {
+                    Paths.emplace_back(attribute.Value);
+                }
+            }
+        }
+        void OnEndElement(std::string_view) override {}
+    };
+
+    struct ParseResult
+    {
+        bool Succeeded = false;
+        std::pmr::vector<CardGeometry::SegmentType> Segments;
+        std::pmr::vector<CardGeometry::Point> Points;
+
+        bool operator==(ParseResult const& other) const
+        {
+            // Bitwise, so that NaNs and negative zeros have to match too
+            return Succeeded == other.Succeeded &&
+                Segments == other.Segments &&
+                Points.size() == other.Points.size() &&
+                memcmp(Points.data(), other.Points.data(), Points.size() * sizeof(CardGeometry::Point)) == 0;
+        }
+    };
+
+    // Random path data that covers every command and the awkward parts
+    // of the number grammar (exponents, missing separators, leading and
+    // trailing dots, compact arc flags). Some of it is deliberately
+    // malformed so that both parsers have to give up at the same place.
+    std::string GeneratePathData(std::mt19937& rng)
+    {
+        static char const Commands[] = "MmLlHhVvCcSsQqTtAaZz";
+        static char const* const Separators[] = { " ", ",", " , ", "\n\t" };
+        std::uniform_int_distribution<int> small(0, 1000);
+        std::string data;
+
+        auto appendNumber = [&]()
+        {
+            auto value = small(rng);
+            auto sign = rng() % 3 == 0 ? "-" : (rng() % 8 == 0 ? "+" : "");
+            std::string number;
+            switch (rng() % 7)
+            {
+            case 0:
+                number = sign + std::to_string(value);
+                break;
+            case 1:
+                number = sign + std::to_string(value / 10) + "." + std::to_string(value % 100);
+                break;
+            case 2:
+                number = std::string(sign) + "." + std::to_string(value);
+                break;
+            case 3:
+                number = sign + std::to_string(value % 10) + "." + std::to_string(value) + (rng() % 2 ? "e-" : "E") + std::to_string(rng() % 12);
+                break;
+            case 4:
+                number = sign + std::to_string(value) + ".";
+                break;
+            case 5:
+                number = sign + std::string("0.") + std::to_string(rng()) + std::to_string(rng()) + std::to_string(rng());
+                break;
+            default:
+                number = sign + std::to_string(value) + "e" + std::to_string(rng() % 40);
+                break;
+            }
+            // Leaving out the separator is only valid if the number can't
+            // run into the previous one, but do it now and then anyway.
+            auto compact = number[0] == '-' || (number[0] == '.' && data.back() != '.');
+            data += compact && rng() % 2 ? "" : Separators[rng() % 4];
+            data += number;
+        };
+
+        auto commandCount = 1 + rng() % 12;
+        for (auto i = 0u; i < commandCount; i++)
+        {
+            auto command = i == 0 && rng() % 16 != 0 ? "Mm"[rng() % 2] : Commands[rng() % 20];
+            data += command;
+            std::string arguments;
+            switch (command | 0x20)
+            {
+            case 'm': case 'l': case 't': arguments = "nn"; break;
+            case 'h': case 'v': arguments = "n"; break;
+            case 'c': arguments = "nnnnnn"; break;
+            case 's': case 'q': arguments = "nnnn"; break;
+            case 'a': arguments = "nnnffnn"; break;
+            default: break;
+            }
+            // Implicit repeats
+            auto repeats = arguments.empty() ? 1 : 1 + rng() % 3;
+            for (auto repeat = 0u; repeat < repeats; repeat++)
+            {
+                auto previous = 'n';
+                for (auto argument : arguments)
+                {
+                    if (argument == 'f')
+                    {
+                        // Only the second flag can be written right after the first
+                        data += previous == 'f' && rng() % 2 ? "" : " ";
+                        data += "01"[rng() % 2];
+                    }
+                    else
+                    {
+                        appendNumber();
+                    }
+                    previous = argument;
+                }
+            }
+        }
+
+        switch (rng() % 10)
+        {
+        case 0:
+            data.resize(rng() % (data.size() + 1));
+            break;
+        case 1:
+            data.insert(rng() % (data.size() + 1), 1, "#.-e, 9"[rng() % 7]);
+            break;
+        default:
+            break;
+        }
+        return data;
+    }
+
+    int Verify(std::vector<std::string> const& paths)
+    {
+        SvgPathTokenizer tokenizer;
+        std::mt19937 rng(5678);
+        auto mismatches = 0;
+        auto generated = 0;
+        auto failed = 0;
+        auto check = [&](std::string const& data)
+        {
+            ParseResult expected;
+            expected.Succeeded = SvgPathParser::Parse(data, expected.Segments, expected.Points);
+            ParseResult actual;
+            actual.Succeeded = tokenizer.Parse(data, actual.Segments, actual.Points);
+            failed += expected.Succeeded ? 0 : 1;
+            if (!(expected == actual))
+            {
+                if (mismatches++ < 10)
+                {
+                    fprintf(stderr, "Mismatch (%s/%s, %zu/%zu segments): %.200s\n",
+                        expected.Succeeded ? "ok" : "error", actual.Succeeded ? "ok" : "error",
+                        expected.Segments.size(), actual.Segments.size(), data.c_str());
+                }
+            }
+        };
+
+        for (auto& path : paths)
+        {
+            check(path);
+        }
+        for (; generated < 200000; generated++)
+        {
+            check(GeneratePathData(rng));
+        }
+
+        printf("Verified:           %zu card face paths, %d generated (%d malformed overall)\n", paths.size(), generated, failed);
+        if (mismatches > 0)
+        {
+            fprintf(stderr, "%d mismatches against SvgPathParser\n", mismatches);
+            return 1;
+        }
+        printf("No mismatches against SvgPathParser\n");
+        return 0;
+    }
+
+    double SecondsSince(std::chrono::steady_clock::time_point const& start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int RunPathBenchmark(CommandArgs const& args)
+{
+    std::vector<std::string> positional;
+    auto verify = false;
+    for (auto& arg : args)
+    {
+        if (arg == "--verify")
+        {
+            verify = true;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.empty() || positional.size() > 2)
+    {
+        fprintf(stderr, "Usage: bench-path <CardFaces directory> [iterations] [--verify]\n");
+        return 1;
+    }
+    auto iterations = positional.size() > 1 ? std::stoi(positional[1]) : 20;
+
+    std::vector<std::string> paths;
+    PathDataCollector collector(paths);
+    for (auto& file : ReadSvgFiles(positional[0]))
+    {
+        SvgReader reader(file.Contents.data(), file.Contents.size());
+        if (!reader.Read(collector))
+        {
+            fprintf(stderr, "%s: %s at offset %zu\n", file.Name.c_str(), reader.Error().c_str(), reader.ErrorOffset());
+            return 1;
+        }
+    }
+    if (paths.empty() || iterations <= 0)
+    {
+        fprintf(stderr, "Nothing to do\n");
+        return 1;
+    }
+    if (verify)
+    {
+        return Verify(paths);
+    }
+
+    size_t pathBytes = 0;
+    for (auto& path : paths)
+    {
+        pathBytes += path.size();
+    }
+
+    // Both parsers append to the same kind of per-document arrays, cleared
+    // between iterations like a new document would be.
+    std::pmr::vector<CardGeometry::SegmentType> segments;
+    std::pmr::vector<CardGeometry::Point> points;
+    auto run = [&](auto&& parse, AllocationCounter::Snapshot& allocations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto counter = AllocationCounter::Current();
+        for (auto i = 0; i < iterations; i++)
+        {
+            segments.clear();
+            points.clear();
+            for (auto& path : paths)
+            {
+                parse(path);
+            }
+        }
+        allocations = AllocationCounter::Since(counter);
+        return SecondsSince(start);
+    };
+
+    AllocationCounter::Snapshot parserAllocations;
+    auto parserTime = run([&](std::string const& path)
+        {
+            SvgPathParser::Parse(path, segments, points);
+        }, parserAllocations);
+    auto segmentCount = segments.size();
+
+    SvgPathTokenizer tokenizer;
+    AllocationCounter::Snapshot tokenizerAllocations;
+    auto tokenizerTime = run([&](std::string const& path)
+        {
+            tokenizer.Parse(path, segments, points);
+        }, tokenizerAllocations);
+
+    auto megabytes = static_cast<double>(pathBytes) * iterations / (1024.0 * 1024.0);
+    auto parses = static_cast<double>(paths.size()) * iterations;
+    printf("Paths:              %zu (%zu bytes of path data, %zu segments), %d iterations\n", paths.size(), pathBytes, segmentCount, iterations);
+    printf("SvgPathParser:      %8.2f ms/pass  %8.2f MB/s  %6.2f allocations/path\n",
+        parserTime * 1000.0 / iterations, megabytes / parserTime, parserAllocations.Allocations / parses);
+    printf("SvgPathTokenizer:   %8.2f ms/pass  %8.2f MB/s  %6.2f allocations/path\n",
+        tokenizerTime * 1000.0 / iterations, megabytes / tokenizerTime, tokenizerAllocations.Allocations / parses);
+    printf("Speedup:            %8.2fx\n", parserTime / tokenizerTime);
+    return 0;
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "GeometryFlattener.h"
+#include "GeometrySimplifier.h"
+#include "ShapeSink.h"
+#include "SourceFiles.h"
+#include "SvgGeometryConverter.h"
+#include "SvgPathTokenizer.h"
+#include "SvgReader.h"
+
+namespace
+{
+    struct AssetProfile
+    {
+        std::string Name;
+        size_t Bytes = 0;
+        // Elements the converter sees, by tag
+        std::map<std::string, size_t> Elements;
+        size_t ElementCount = 0;
+        // Inkscape, RDF and the like, which the reader skips
+        size_t ForeignElements = 0;
+        // What the reader skips: foreign elements and attributes,
+        // comments, processing instructions
+        size_t MetadataBytes = 0;
+        size_t MaxDepth = 0;
+        size_t Paths = 0;
+        // In the path data as written, uses don't add any
+        size_t Segments = 0;
+        size_t Gradients = 0;
+        // Children of defs, and the ids of those nothing refers to
+        size_t Defs = 0;
+        std::vector<std::string> UnusedDefs;
+        // What SvgGeometryConverter makes of it, one container per
+        // element and a sprite per drawable one
+        size_t Containers = 0;
+        size_t Sprites = 0;
+        // After simplifying and flattening for the card's size, which is
+        // what the game ends up with at full detail
+        size_t FinalNodes = 0;
+        size_t FinalSegments = 0;
+        // What that comes to as composition objects (see ShapeCounts)
+        size_t EstimatedBytes = 0;
+        // Over one of the budgets
+        bool OverBudget = false;
+
+        size_t Shapes() const { return Containers + Sprites; }
+    };
+
+    class ProfileHandler : public ISvgReaderHandler
+    {
+    public:
+        ProfileHandler(AssetProfile& profile) : m_profile(profile) {}
+
+        void OnStartElement(std::string_view tag, CardGeometry::Span<SvgAttribute> attributes, size_t) override
+        {
+            m_profile.Elements[std::string(tag)]++;
+            m_profile.ElementCount++;
+            m_depth++;
+            m_profile.MaxDepth = std::max(m_profile.MaxDepth, m_depth);
+            if (tag == "linearGradient" || tag == "radialGradient")
+            {
+                m_profile.Gradients++;
+            }
+
+            auto isDefinition = m_defsDepth > 0 && m_depth == m_defsDepth + 1;
+            if (isDefinition)
+            {
+                m_profile.Defs++;
+            }
+            if (tag == "defs" && m_defsDepth == 0)
+            {
+                m_defsDepth = m_depth;
+            }
+
+            std::string id;
+            for (auto& attribute : attributes)
+            {
+                if (attribute.Name == "id")
+                {
+                    id = attribute.Value;
+                }
+                else if ((attribute.Name == "href" || attribute.Name == "xlink:href") &&
+                    !attribute.Value.empty() && attribute.Value[0] == '#')
+                {
+                    m_referenced.insert(std::string(attribute.Value.substr(1)));
+                }
+                else if (attribute.Name == "d" && tag == "path")
+                {
+                    m_segments.clear();
+                    m_points.clear();
+                    m_tokenizer.Parse(attribute.Value, m_segments, m_points);
+                    m_profile.Paths++;
+                    m_profile.Segments += m_segments.size();
+                }
+                AddUrlReferences(attribute.Value);
+            }
+            if (isDefinition)
+            {
+                m_definitions.push_back(id.empty() ? "(no id)" : id);
+            }
+        }
+
+        void OnEndElement(std::string_view) override
+        {
+            if (m_depth == m_defsDepth)
+            {
+                m_defsDepth = 0;
+            }
+            m_depth--;
+        }
+
+        // Anything referred to from anywhere counts as used, even if it's
+        // only by another unused definition
+        void Finish()
+        {
+            for (auto& id : m_definitions)
+            {
+                if (m_referenced.find(id) == m_referenced.end())
+                {
+                    m_profile.UnusedDefs.push_back(id);
+                }
+            }
+        }
+
+    private:
+        // fill="url(#a)", style="fill:url(#a)", clip-path="url(#b)", ...
+        void AddUrlReferences(std::string_view value)
+        {
+            for (auto start = value.find("url(#"); start != std::string_view::npos; start = value.find("url(#", start))
+            {
+                start += 5;
+                auto end = value.find(')', start);
+                if (end == std::string_view::npos)
+                {
+                    return;
+                }
+                m_referenced.insert(std::string(value.substr(start, end - start)));
+            }
+        }
+
+    private:
+        AssetProfile& m_profile;
+        size_t m_depth = 0;
+        // Depth of the defs element we're in, 0 outside of one
+        size_t m_defsDepth = 0;
+        std::vector<std::string> m_definitions;
+        std::set<std::string> m_referenced;
+        SvgPathTokenizer m_tokenizer;
+        std::pmr::vector<CardGeometry::SegmentType> m_segments;
+        std::pmr::vector<CardGeometry::Point> m_points;
+    };
+
+    AssetProfile ProfileAsset(SourceFile const& file, GeometrySimplifier::Options const& options)
+    {
+        AssetProfile profile;
+        profile.Name = file.Name;
+        profile.Bytes = file.Contents.size();
+
+        ProfileHandler handler(profile);
+        SvgReader reader(file.Contents.data(), file.Contents.size());
+        if (!reader.Read(handler))
+        {
+            throw std::runtime_error(reader.Error() + " at offset " + std::to_string(reader.ErrorOffset()));
+        }
+        handler.Finish();
+        profile.ForeignElements = reader.ElementsSkipped();
+        profile.MetadataBytes = reader.BytesSkipped();
+
+        auto converted = SvgGeometryConverter::Convert(file.Contents.data(), file.Contents.size());
+        for (auto& node : converted.Nodes)
+        {
+            if (node.Type == CardGeometry::NodeType::Container)
+            {
+                profile.Containers++;
+            }
+            else
+            {
+                profile.Sprites++;
+            }
+        }
+        GeometrySimplifier::Stats stats;
+        auto simplified = GeometrySimplifier::Simplify(converted.View(), options, stats);
+        GeometryFlattener::Stats flattenStats;
+        auto document = GeometryFlattener::Flatten(simplified.View(), flattenStats);
+        profile.FinalNodes = flattenStats.NodesAfter;
+        profile.FinalSegments = document.Segments.size();
+
+        ShapeSink::SharedResources resources;
+        CountingShapeSink counter;
+        ShapeSink::Build(document.View(), resources, counter);
+        profile.EstimatedBytes = counter.Counts().Bytes;
+        return profile;
+    }
+
+    void AppendJsonString(std::string& json, std::string const& value)
+    {
+        json += '"';
+        for (auto c : value)
+        {
+            switch (c)
+            {
+            case '"': json += "\\\""; break;
+            case '\\': json += "\\\\"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8] = {};
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    json += escaped;
+                }
+                else
+                {
+                    json += c;
+                }
+                break;
+            }
+        }
+        json += '"';
+    }
+
+    void AppendJsonField(std::string& json, char const* name, size_t value)
+    {
+        json += ",\"";
+        json += name;
+        json += "\":" + std::to_string(value);
+    }
+
+    std::string ToJson(std::vector<AssetProfile> const& profiles, size_t maxShapes, size_t maxSegments)
+    {
+        std::string json = "{\"budget\":{\"shapes\":" + std::to_string(maxShapes) + ",\"segments\":" + std::to_string(maxSegments) + "},\"files\":[";
+        for (auto i = 0u; i < profiles.size(); i++)
+        {
+            auto& profile = profiles[i];
+            json += i > 0 ? ",\n{\"name\":" : "\n{\"name\":";
+            AppendJsonString(json, profile.Name);
+            AppendJsonField(json, "bytes", profile.Bytes);
+            json += ",\"elements\":{";
+            auto first = true;
+            for (auto& [tag, count] : profile.Elements)
+            {
+                json += first ? "" : ",";
+                AppendJsonString(json, tag);
+                json += ":" + std::to_string(count);
+                first = false;
+            }
+            json += "}";
+            AppendJsonField(json, "elementCount", profile.ElementCount);
+            AppendJsonField(json, "foreignElements", profile.ForeignElements);
+            AppendJsonField(json, "metadataBytes", profile.MetadataBytes);
+            AppendJsonField(json, "maxDepth", profile.MaxDepth);
+            AppendJsonField(json, "paths", profile.Paths);
+            AppendJsonField(json, "segments", profile.Segments);
+            AppendJsonField(json, "gradients", profile.Gradients);
+            AppendJsonField(json, "defs", profile.Defs);
+            json += ",\"unusedDefs\":[";
+            for (auto j = 0u; j < profile.UnusedDefs.size(); j++)
+            {
+                json += j > 0 ? "," : "";
+                AppendJsonString(json, profile.UnusedDefs[j]);
+            }
+            json += "]";
+            AppendJsonField(json, "containers", profile.Containers);
+            AppendJsonField(json, "sprites", profile.Sprites);
+            AppendJsonField(json, "shapes", profile.Shapes());
+            AppendJsonField(json, "finalNodes", profile.FinalNodes);
+            AppendJsonField(json, "finalSegments", profile.FinalSegments);
+            AppendJsonField(json, "estimatedBytes", profile.EstimatedBytes);
+            json += ",\"overBudget\":";
+            json += profile.OverBudget ? "true}" : "false}";
+        }
+        json += "\n]}\n";
+        return json;
+    }
+}
+
+// Reports what each card face costs as authored, so that changes to the
+// art can be checked against a budget. 0 means no budget.
+int RunProfile(CommandArgs const& args)
+{
+    std::string inputDirectory;
+    std::string jsonPath;
+    size_t top = 5;
+    size_t maxShapes = 0;
+    size_t maxSegments = 0;
+    for (auto i = 0u; i < args.size(); i++)
+    {
+        if (args[i] == "--json" && i + 1 < args.size())
+        {
+            jsonPath = args[++i];
+        }
+        else if (args[i] == "--top" && i + 1 < args.size())
+        {
+            top = std::stoul(args[++i]);
+        }
+        else if (args[i] == "--max-shapes" && i + 1 < args.size())
+        {
+            maxShapes = std::stoul(args[++i]);
+        }
+        else if (args[i] == "--max-segments" && i + 1 < args.size())
+        {
+            maxSegments = std::stoul(args[++i]);
+        }
+        else if (inputDirectory.empty())
+        {
+            inputDirectory = args[i];
+        }
+        else
+        {
+            inputDirectory.clear();
+            break;
+        }
+    }
+    if (inputDirectory.empty())
+    {
+        fprintf(stderr, "Usage: profile <CardFaces directory> [--json <output file>] [--top <count>] [--max-shapes <count>] [--max-segments <count>]\n");
+        return 1;
+    }
+
+    auto files = ReadSvgFiles(inputDirectory);
+    if (files.empty())
+    {
+        fprintf(stderr, "No .svg files found in %s\n", inputDirectory.c_str());
+        return 1;
+    }
+
+    // The same simplification the bundle and the game get
+    CardGeometry::CardShapeMetrics metrics;
+    GeometrySimplifier::Options options;
+    options.TargetWidth = metrics.Width;
+    options.TargetHeight = metrics.Height;
+
+    std::vector<AssetProfile> profiles;
+    for (auto& file : files)
+    {
+        try
+        {
+            profiles.push_back(ProfileAsset(file, options));
+        }
+        catch (std::exception const& error)
+        {
+            fprintf(stderr, "%s: %s\n", file.Name.c_str(), error.what());
+            return 1;
+        }
+        auto& profile = profiles.back();
+        profile.OverBudget = (maxShapes > 0 && profile.Shapes() > maxShapes) ||
+            (maxSegments > 0 && profile.Segments > maxSegments);
+    }
+
+    printf("%-24s %7s %8s %7s %5s %5s %8s %9s %11s %9s %6s %6s %7s\n",
+        "", "KB", "elements", "foreign", "depth", "paths", "segments", "gradients", "defs/unused", "meta KB", "shapes", "final", "est KB");
+    std::map<std::string, size_t> totalElements;
+    AssetProfile total;
+    for (auto& profile : profiles)
+    {
+        printf("%-24s %7.1f %8zu %7zu %5zu %5zu %8zu %9zu %5zu/%-5zu %9.1f %6zu %6zu %7.1f%s\n",
+            profile.Name.c_str(), profile.Bytes / 1024.0, profile.ElementCount, profile.ForeignElements,
+            profile.MaxDepth, profile.Paths, profile.Segments, profile.Gradients,
+            profile.Defs, profile.UnusedDefs.size(), profile.MetadataBytes / 1024.0,
+            profile.Shapes(), profile.FinalNodes, profile.EstimatedBytes / 1024.0, profile.OverBudget ? "  over budget" : "");
+        for (auto& [tag, count] : profile.Elements)
+        {
+            totalElements[tag] += count;
+        }
+        total.Bytes += profile.Bytes;
+        total.MetadataBytes += profile.MetadataBytes;
+        total.Segments += profile.Segments;
+        total.UnusedDefs.insert(total.UnusedDefs.end(), profile.UnusedDefs.begin(), profile.UnusedDefs.end());
+        total.Containers += profile.Containers;
+        total.Sprites += profile.Sprites;
+        total.FinalNodes += profile.FinalNodes;
+        total.EstimatedBytes += profile.EstimatedBytes;
+    }
+    printf("\n%zu files, %.1f KB (%.1f KB of it metadata), %zu segments, %zu unused defs, %zu shapes converted, %zu after simplifying, %.1f KB estimated\n",
+        profiles.size(), total.Bytes / 1024.0, total.MetadataBytes / 1024.0, total.Segments,
+        total.UnusedDefs.size(), total.Shapes(), total.FinalNodes, total.EstimatedBytes / 1024.0);
+    printf("Elements:");
+    for (auto& [tag, count] : totalElements)
+    {
+        printf(" %s %zu", tag.c_str(), count);
+    }
+    printf("\n");
+
+    // By what the game ends up holding, where path data outweighs the
+    // shape count by far on the court cards
+    auto ranked = profiles;
+    std::sort(ranked.begin(), ranked.end(), [](auto const& left, auto const& right)
+        {
+            return left.EstimatedBytes > right.EstimatedBytes;
+        });
+    top = std::min(top, ranked.size());
+    printf("\nCostliest %zu:\n", top);
+    for (auto i = 0u; i < top; i++)
+    {
+        auto& profile = ranked[i];
+        printf("    %-24s %.1f KB estimated, %zu shapes (%zu containers, %zu sprites), %zu segments, %zu shapes and %zu segments after simplifying\n",
+            profile.Name.c_str(), profile.EstimatedBytes / 1024.0, profile.Shapes(), profile.Containers, profile.Sprites,
+            profile.Segments, profile.FinalNodes, profile.FinalSegments);
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream output(jsonPath, std::ios::binary);
+        output << ToJson(profiles, maxShapes, maxSegments);
+        if (!output)
+        {
+            fprintf(stderr, "Couldn't write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        printf("\nWrote %s\n", jsonPath.c_str());
+    }
+
+    auto overBudget = std::count_if(profiles.begin(), profiles.end(), [](auto const& profile) { return profile.OverBudget; });
+    if (overBudget > 0)
+    {
+        fprintf(stderr, "%zu files are over budget\n", static_cast<size_t>(overBudget));
+        return 1;
+    }
+    return 0;
+}
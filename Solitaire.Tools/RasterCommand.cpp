@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "CardAtlas.h"
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "DetailLevels.h"
+#include "GeometryBundle.h"
+#include "MappedFile.h"
+
+namespace
+{
+    // PAM keeps the alpha channel and anything can open it. It's straight
+    // alpha, so the atlas gets unpremultiplied on the way out.
+    bool WritePam(std::string const& path, GeometryRasterizer::Bitmap const& image)
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output << "P7\nWIDTH " << image.Width << "\nHEIGHT " << image.Height
+            << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+        std::vector<uint8_t> row(static_cast<size_t>(image.Width) * 4);
+        for (auto y = 0u; y < image.Height; y++)
+        {
+            auto pixel = image.Row(y);
+            for (auto x = 0u; x < image.Width * 4; x += 4)
+            {
+                auto alpha = pixel[x + 3];
+                for (auto channel = 0u; channel < 3; channel++)
+                {
+                    row[x + channel] = alpha == 0 ? 0 : static_cast<uint8_t>(std::min(255, (pixel[x + channel] * 255 + alpha / 2) / alpha));
+                }
+                row[x + 3] = alpha;
+            }
+            output.write(reinterpret_cast<char const*>(row.data()), row.size());
+        }
+        output.close();
+        return static_cast<bool>(output);
+    }
+}
+
+int RunRaster(CommandArgs const& args)
+{
+    std::vector<std::string> positional;
+    auto scale = 1.0f;
+    auto level = 0u;
+    for (auto i = 0u; i < args.size(); i++)
+    {
+        if (args[i] == "--scale" && i + 1 < args.size())
+        {
+            scale = std::stof(args[++i]);
+        }
+        else if (args[i] == "--level" && i + 1 < args.size())
+        {
+            level = static_cast<uint32_t>(std::stoul(args[++i]));
+        }
+        else
+        {
+            positional.push_back(args[i]);
+        }
+    }
+    if (positional.size() != 2 || scale <= 0 || level >= DetailLevels::Count)
+    {
+        fprintf(stderr, "Usage: raster <bundle file> <output file> [--scale <scale>] [--level <detail level>]\n");
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(positional[0]))
+    {
+        fprintf(stderr, "Couldn't map %s\n", positional[0].c_str());
+        return 1;
+    }
+    GeometryBundle::Reader reader;
+    std::string error;
+    if (!reader.Open(file.Data(), file.Size(), error))
+    {
+        fprintf(stderr, "%s: %s\n", positional[0].c_str(), error.c_str());
+        return 1;
+    }
+
+    // One cell per document, at the requested level of detail where the
+    // bundle has it (the card back and the empty pile only have level 0)
+    std::vector<uint32_t> entries;
+    std::vector<CardGeometry::DocumentView> documents;
+    for (auto i = 0u; i < reader.EntryCount(); i++)
+    {
+        std::string name = reader.GetEntry(i).Name;
+        if (DetailLevels::LevelOf(name) != 0)
+        {
+            continue;
+        }
+        entries.push_back(i);
+        auto document = reader.GetDocument(i);
+        reader.TryFind(DetailLevels::EntryName(name, level).c_str(), document);
+        documents.push_back(document);
+    }
+
+    // Same size the game draws cards at, and the same bucketing
+    CardGeometry::CardShapeMetrics metrics;
+    auto bucket = CardAtlas::ScaleBucket(scale);
+    auto start = std::chrono::steady_clock::now();
+    auto atlas = CardAtlas::Build(documents, metrics.Width, metrics.Height, bucket);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-24s %6s %6s %6s %6s   %s\n", "", "x", "y", "width", "height", "uv");
+    for (auto i = 0u; i < entries.size(); i++)
+    {
+        auto& cell = atlas.Layout.Cells[i];
+        printf("%-24s %6u %6u %6u %6u   %.4f %.4f %.4f %.4f\n", reader.GetEntry(entries[i]).Name,
+            cell.X, cell.Y, cell.Width, cell.Height, cell.U0, cell.V0, cell.U1, cell.V1);
+    }
+
+    if (!WritePam(positional[1], atlas.Image))
+    {
+        fprintf(stderr, "Couldn't write %s\n", positional[1].c_str());
+        return 1;
+    }
+    printf("\nWrote %s: %zu cards at scale %g (bucket for %g), %ux%u pixels, drawn in %.1f ms (%.2f ms per card)\n",
+        positional[1].c_str(), documents.size(), bucket, scale, atlas.Layout.Width, atlas.Layout.Height,
+        elapsed, documents.empty() ? 0.0 : elapsed / documents.size());
+    return 0;
+}
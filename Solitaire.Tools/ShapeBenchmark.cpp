@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "GeometryBundle.h"
+#include "MappedFile.h"
+#include "ShapeSink.h"
+
+namespace
+{
+    double SecondsSince(std::chrono::steady_clock::time_point const& start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool SameCounts(ShapeCounts const& left, ShapeCounts const& right)
+    {
+        return left.ContainerShapes == right.ContainerShapes &&
+            left.SpriteShapes == right.SpriteShapes &&
+            left.PathGeometries == right.PathGeometries &&
+            left.OtherGeometries == right.OtherGeometries &&
+            left.Brushes == right.Brushes &&
+            left.ViewBoxes == right.ViewBoxes &&
+            left.Segments == right.Segments &&
+            left.Points == right.Points &&
+            left.Bytes == right.Bytes;
+    }
+}
+
+// Builds the shapes for every document in a bundle the way ShapeCache
+// does, minus composition, then checks that a serialized stream plays
+// back to the same thing
+int RunShapeBenchmark(CommandArgs const& args)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        fprintf(stderr, "Usage: bench-shapes <bundle file> [iterations]\n");
+        return 1;
+    }
+    auto iterations = args.size() > 1 ? std::stoi(args[1]) : 20;
+    MappedFile file;
+    if (!file.Open(args[0]))
+    {
+        fprintf(stderr, "Couldn't map %s\n", args[0].c_str());
+        return 1;
+    }
+    GeometryBundle::Reader reader;
+    std::string error;
+    if (!reader.Open(file.Data(), file.Size(), error))
+    {
+        fprintf(stderr, "%s: %s\n", args[0].c_str(), error.c_str());
+        return 1;
+    }
+    if (reader.EntryCount() == 0 || iterations <= 0)
+    {
+        fprintf(stderr, "Nothing to do\n");
+        return 1;
+    }
+    std::vector<CardGeometry::DocumentView> documents;
+    size_t expectedSprites = 0;
+    for (auto i = 0u; i < reader.EntryCount(); i++)
+    {
+        documents.push_back(reader.GetDocument(i));
+        for (auto& node : documents.back().Nodes)
+        {
+            expectedSprites += node.Type == CardGeometry::NodeType::Container ? 0 : 1;
+        }
+    }
+
+    // Walking the documents and sharing geometry and brushes, which is
+    // everything ShapeCache does before composition gets involved
+    ShapeCounts counts;
+    ShapeSink::SharedResources resources;
+    auto allocations = AllocationCounter::Current();
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        resources = {};
+        CountingShapeSink counter;
+        for (auto& document : documents)
+        {
+            ShapeSink::Build(document, resources, counter);
+        }
+        counts = counter.Counts();
+    }
+    auto buildTime = SecondsSince(start);
+    auto buildAllocations = AllocationCounter::Since(allocations);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> stream;
+    for (auto i = 0; i < iterations; i++)
+    {
+        ShapeSink::SharedResources serializedResources;
+        SerializingShapeSink serializer;
+        for (auto& document : documents)
+        {
+            ShapeSink::Build(document, serializedResources, serializer);
+        }
+        stream = serializer.Data();
+    }
+    auto serializeTime = SecondsSince(start);
+
+    // Played back into a counter it has to add up to the same, and
+    // serialized again it has to come out byte for byte the same
+    start = std::chrono::steady_clock::now();
+    CountingShapeSink replayed;
+    SerializingShapeSink reserialized;
+    for (auto i = 0; i < iterations; i++)
+    {
+        replayed.Reset();
+        if (!ShapeSink::Replay(stream.data(), stream.size(), replayed, error))
+        {
+            fprintf(stderr, "Replay failed: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    auto replayTime = SecondsSince(start);
+    CountingShapeSink reserializeCounter(&reserialized);
+    if (!ShapeSink::Replay(stream.data(), stream.size(), reserializeCounter, error))
+    {
+        fprintf(stderr, "Replay failed: %s\n", error.c_str());
+        return 1;
+    }
+
+    auto result = 0;
+    if (counts.SpriteShapes != expectedSprites)
+    {
+        fprintf(stderr, "Built %zu sprites, the documents have %zu\n", counts.SpriteShapes, expectedSprites);
+        result = 1;
+    }
+    if (!SameCounts(counts, replayed.Counts()))
+    {
+        fprintf(stderr, "The replayed stream doesn't add up to what was built\n");
+        result = 1;
+    }
+    if (reserialized.Data() != stream || reserialized.DocumentCount() != documents.size())
+    {
+        fprintf(stderr, "The replayed stream serializes differently\n");
+        result = 1;
+    }
+
+    auto passes = static_cast<double>(iterations);
+    printf("Documents:          %zu, %d iterations\n", documents.size(), iterations);
+    printf("Shapes:             %zu containers, %zu sprites, %zu view boxes\n", counts.ContainerShapes, counts.SpriteShapes, counts.ViewBoxes);
+    printf("Geometry:           %zu paths (%zu segments, %zu points), %zu others, created for %zu sprites\n",
+        counts.PathGeometries, counts.Segments, counts.Points, counts.OtherGeometries, resources.GeometryRequested);
+    printf("Brushes:            %zu created of %zu requested\n", counts.Brushes, resources.BrushesRequested);
+    printf("Estimated size:     %zu KB as composition objects\n", counts.Bytes / 1024);
+    printf("Build:              %8.3f ms/pass  %8.1f allocations/pass\n", buildTime * 1000.0 / passes, buildAllocations.Allocations / passes);
+    printf("Serialize:          %8.3f ms/pass  %zu bytes\n", serializeTime * 1000.0 / passes, stream.size());
+    printf("Replay:             %8.3f ms/pass\n", replayTime * 1000.0 / passes);
+    return result;
+}
@@ -0,0 +1,153 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Commands.h"
+#include "GeometryBundle.h"
+#include "MappedFile.h"
+#include "SharedGeometry.h"
+
+namespace
+{
+    double MillisecondsSince(std::chrono::steady_clock::time_point const& start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // What an instance does with the documents once it has them, which
+    // is where a bad mapping would show up
+    size_t TouchDocuments(GeometryBundle::Reader const& reader)
+    {
+        size_t nodes = 0;
+        for (auto i = 0u; i < reader.EntryCount(); i++)
+        {
+            nodes += reader.GetDocument(i).Nodes.Size;
+        }
+        return nodes;
+    }
+}
+
+// Stands in for several instances of the game: the first publishes the
+// bundle to the shared segment and the rest open it, the same way
+// ShapeCache does. Run it with --hold in one terminal and again in
+// another to see a segment shared between processes.
+int RunShare(CommandArgs const& args)
+{
+    std::string bundlePath;
+    auto instances = 4;
+    auto hold = false;
+    for (auto& arg : args)
+    {
+        if (arg == "--hold")
+        {
+            hold = true;
+        }
+        else if (bundlePath.empty())
+        {
+            bundlePath = arg;
+        }
+        else
+        {
+            instances = std::stoi(arg);
+        }
+    }
+    if (bundlePath.empty() || instances <= 0)
+    {
+        fprintf(stderr, "Usage: share <bundle file> [instances] [--hold]\n");
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(bundlePath))
+    {
+        fprintf(stderr, "Couldn't map %s\n", bundlePath.c_str());
+        return 1;
+    }
+    GeometryBundle::Reader reader;
+    std::string error;
+    if (!reader.Open(file.Data(), file.Size(), error))
+    {
+        fprintf(stderr, "%s: %s\n", bundlePath.c_str(), error.c_str());
+        return 1;
+    }
+    auto expectedNodes = TouchDocuments(reader);
+
+    // Without the segment, every instance has its own copy
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream stream(bundlePath, std::ios::binary);
+    std::vector<uint8_t> copy((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    GeometryBundle::Reader copyReader;
+    if (!copyReader.Open(copy.data(), copy.size(), error) || TouchDocuments(copyReader) != expectedNodes)
+    {
+        fprintf(stderr, "Couldn't read %s\n", bundlePath.c_str());
+        return 1;
+    }
+    printf("Private copy:  read in %8.3f ms, %zu bytes per instance\n", MillisecondsSince(start), copy.size());
+
+    auto name = SharedGeometry::SegmentName();
+    auto result = 0;
+    std::vector<std::unique_ptr<SharedGeometrySegment>> segments;
+    for (auto i = 0; i < instances; i++)
+    {
+        start = std::chrono::steady_clock::now();
+        auto segment = std::make_unique<SharedGeometrySegment>();
+        auto published = false;
+        if (!segment->Open(name))
+        {
+            if (!segment->Publish(name, file.Data(), file.Size()))
+            {
+                fprintf(stderr, "Couldn't open or create the segment %s\n", name.c_str());
+                return 1;
+            }
+            published = true;
+        }
+        GeometryBundle::Reader segmentReader;
+        if (!segmentReader.Open(segment->Data(), segment->Size(), error))
+        {
+            fprintf(stderr, "Instance %d: %s\n", i + 1, error.c_str());
+            return 1;
+        }
+        auto nodes = TouchDocuments(segmentReader);
+        auto time = MillisecondsSince(start);
+        printf("Instance %-4d %s in %8.3f ms, %u readers\n", i + 1, published ? "published" : "opened   ", time, segment->ReaderCount());
+
+        // Another process might have published a different bundle
+        if (segment->Size() != file.Size() || memcmp(segment->Data(), file.Data(), file.Size()) != 0 || nodes != expectedNodes)
+        {
+            fprintf(stderr, "Instance %d: the segment doesn't hold this bundle\n", i + 1);
+            result = 1;
+        }
+        segments.push_back(std::move(segment));
+    }
+    printf("Segment:       %s, %zu bytes shared by every instance\n", name.c_str(), segments[0]->Size());
+
+    if (hold)
+    {
+        printf("Holding the segment, press Enter to let go of it\n");
+        getchar();
+    }
+
+    // Once the last reader lets go, the segment has to go too
+    auto others = segments[0]->ReaderCount() - static_cast<uint32_t>(instances);
+    segments.clear();
+    SharedGeometrySegment after;
+    auto removed = !after.Open(name);
+    if (others == 0 && !removed)
+    {
+        fprintf(stderr, "The segment outlived its last reader\n");
+        result = 1;
+    }
+    if (removed)
+    {
+        printf("Segment removed with its last reader\n");
+    }
+    else
+    {
+        printf("Segment still open in %u other readers\n", after.ReaderCount() - 1);
+    }
+    return result;
+}
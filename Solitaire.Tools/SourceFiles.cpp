@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "SourceFiles.h"
+
+namespace fs = std::filesystem;
+
+std::string ReadFile(fs::path const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Couldn't open " + path.string());
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+std::vector<SourceFile> ReadSvgFiles(fs::path const& directory)
+{
+    std::vector<SourceFile> files;
+    for (auto& item : fs::directory_iterator(directory))
+    {
+        if (item.is_regular_file() && item.path().extension() == ".svg")
+        {
+            files.push_back({ item.path().stem().string(), ReadFile(item.path()) });
+        }
+    }
+    std::sort(files.begin(), files.end(), [](auto const& left, auto const& right)
+        {
+            return left.Name < right.Name;
+        });
+    return files;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct SourceFile
+{
+    std::string Name;
+    std::string Contents;
+};
+
+// Throws std::runtime_error if the file can't be opened
+std::string ReadFile(std::filesystem::path const& path);
+// Every .svg file in the directory, named after the file minus the
+// extension and sorted by name so that the order doesn't depend on the
+// file system.
+std::vector<SourceFile> ReadSvgFiles(std::filesystem::path const& directory);
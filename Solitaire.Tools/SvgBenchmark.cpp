@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CardGeometry.h"
+#include "Commands.h"
+#include "SourceFiles.h"
+#include "SvgGeometryConverter.h"
+#include "SvgReader.h"
+
+namespace
+{
+    // Only walks the document, so the reader is all that gets measured
+    class CountingHandler : public ISvgReaderHandler
+    {
+    public:
+        size_t Attributes = 0;
+
+        void OnStartElement(std::string_view, CardGeometry::Span<SvgAttribute> attributes, size_t) override
+        {
+            Attributes += attributes.Size;
+        }
+        void OnEndElement(std::string_view) override {}
+    };
+
+    double SecondsSince(std::chrono::steady_clock::time_point const& start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int RunSvgBenchmark(CommandArgs const& args)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        fprintf(stderr, "Usage: bench-svg <CardFaces directory> [iterations]\n");
+        return 1;
+    }
+    auto iterations = args.size() > 1 ? std::stoi(args[1]) : 20;
+    auto files = ReadSvgFiles(args[0]);
+    if (files.empty() || iterations <= 0)
+    {
+        fprintf(stderr, "Nothing to do\n");
+        return 1;
+    }
+    size_t inputBytes = 0;
+    for (auto& file : files)
+    {
+        inputBytes += file.Contents.size();
+    }
+
+    // Reader on its own
+    size_t elementsReported = 0;
+    size_t elementsSkipped = 0;
+    CountingHandler handler;
+    auto allocations = AllocationCounter::Current();
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        for (auto& file : files)
+        {
+            SvgReader reader(file.Contents.data(), file.Contents.size());
+            if (!reader.Read(handler))
+            {
+                fprintf(stderr, "%s: %s at offset %zu\n", file.Name.c_str(), reader.Error().c_str(), reader.ErrorOffset());
+                return 1;
+            }
+            elementsReported += reader.ElementsReported();
+            elementsSkipped += reader.ElementsSkipped();
+        }
+    }
+    auto readTime = SecondsSince(start);
+    auto readAllocations = AllocationCounter::Since(allocations);
+
+    // Reader plus conversion into CardGeometry
+    size_t nodes = 0;
+    size_t segments = 0;
+    allocations = AllocationCounter::Current();
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        for (auto& file : files)
+        {
+            try
+            {
+                auto document = SvgGeometryConverter::Convert(file.Contents.data(), file.Contents.size());
+                nodes += document.Nodes.size();
+                segments += document.Segments.size();
+            }
+            catch (std::exception const& error)
+            {
+                fprintf(stderr, "%s: %s\n", file.Name.c_str(), error.what());
+                return 1;
+            }
+        }
+    }
+    auto convertTime = SecondsSince(start);
+    auto convertAllocations = AllocationCounter::Since(allocations);
+
+    auto megabytes = static_cast<double>(inputBytes) * iterations / (1024.0 * 1024.0);
+    auto documents = static_cast<double>(files.size()) * iterations;
+    printf("Documents:          %zu (%zu bytes), %d iterations\n", files.size(), inputBytes, iterations);
+    printf("Elements:           %zu reported, %zu skipped, %zu attributes per pass\n",
+        elementsReported / iterations, elementsSkipped / iterations, handler.Attributes / iterations);
+    printf("SvgReader:          %8.2f ms/pass  %8.2f MB/s  %8.1f allocations/document\n",
+        readTime * 1000.0 / iterations, megabytes / readTime, readAllocations.Allocations / documents);
+    printf("Convert:            %8.2f ms/pass  %8.2f MB/s  %8.1f allocations/document (%.1f KB)\n",
+        convertTime * 1000.0 / iterations, megabytes / convertTime,
+        convertAllocations.Allocations / documents, convertAllocations.Bytes / documents / 1024.0);
+    printf("Output:             %zu nodes, %zu segments per pass\n", nodes / iterations, segments / iterations);
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Commands.h"
+#include "SpanRecorder.h"
+
+namespace
+{
+    class Checker
+    {
+    public:
+        void Check(bool condition, char const* what)
+        {
+            m_checks++;
+            if (!condition)
+            {
+                m_failures++;
+                fprintf(stderr, "FAILED: %s\n", what);
+            }
+        }
+
+        int Finish() const
+        {
+            printf("%zu of %zu checks passed\n", m_checks - m_failures, m_checks);
+            return m_failures == 0 ? 0 : 1;
+        }
+
+    private:
+        size_t m_checks = 0;
+        size_t m_failures = 0;
+    };
+
+    void Work(int milliseconds)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    }
+
+    size_t Count(std::string const& text, std::string const& pattern)
+    {
+        size_t count = 0;
+        for (auto position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // Brackets and braces outside of strings have to balance
+    bool IsBalancedJson(std::string const& json)
+    {
+        std::vector<char> open;
+        auto inString = false;
+        for (auto i = 0u; i < json.size(); i++)
+        {
+            auto c = json[i];
+            if (inString)
+            {
+                if (c == '\\')
+                {
+                    i++;
+                }
+                else if (c == '"')
+                {
+                    inString = false;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    return false;
+                }
+                continue;
+            }
+            switch (c)
+            {
+            case '"': inString = true; break;
+            case '{': open.push_back('}'); break;
+            case '[': open.push_back(']'); break;
+            case '}':
+            case ']':
+                if (open.empty() || open.back() != c)
+                {
+                    return false;
+                }
+                open.pop_back();
+                break;
+            }
+        }
+        return open.empty() && !inString;
+    }
+}
+
+// Runs something shaped like the game's startup through a SpanRecorder
+// and checks what it recorded
+int RunTraceCheck(CommandArgs const& args)
+{
+    if (args.size() > 1)
+    {
+        fprintf(stderr, "Usage: trace-check [output file]\n");
+        return 1;
+    }
+
+    const int Workers = 4;
+    const int CardsPerWorker = 5;
+    SpanRecorder recorder;
+    size_t handedOff = 0;
+    {
+        SpanRecorder::Scope startup(recorder, "startup");
+        {
+            SpanRecorder::Scope assets(recorder, "assets");
+            Work(2);
+        }
+        {
+            // The same name nested under itself is only counted once
+            SpanRecorder::Scope outer(recorder, "devices");
+            SpanRecorder::Scope inner(recorder, "devices");
+            Work(1);
+        }
+        // Begins here and ends on a worker, like a coroutine that resumes
+        // somewhere else
+        handedOff = recorder.Begin("handoff");
+
+        std::vector<std::thread> workers;
+        for (auto worker = 0; worker < Workers; worker++)
+        {
+            workers.emplace_back([&recorder, worker, handedOff]()
+                {
+                    if (worker == 0)
+                    {
+                        recorder.End(handedOff);
+                    }
+                    for (auto card = 0; card < CardsPerWorker; card++)
+                    {
+                        auto name = "card " + std::to_string(worker * CardsPerWorker + card);
+                        SpanRecorder::Scope load(recorder, "load", name);
+                        {
+                            SpanRecorder::Scope read(recorder, "read", name);
+                            Work(1);
+                        }
+                        SpanRecorder::Scope parse(recorder, "parse", name);
+                        Work(1);
+                    }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        recorder.Begin("never \"ended\"\n");
+    }
+    auto spans = recorder.Spans();
+
+    Checker checker;
+    size_t ended = 0;
+    auto nestingHolds = true;
+    auto depthsHold = true;
+    auto startsAreOrdered = true;
+    std::vector<double> lastStart;
+    for (auto& span : spans)
+    {
+        ended += span.Ended ? 1 : 0;
+        if (span.Thread >= lastStart.size())
+        {
+            lastStart.resize(span.Thread + 1, 0.0);
+        }
+        startsAreOrdered = startsAreOrdered && span.Start >= lastStart[span.Thread];
+        lastStart[span.Thread] = span.Start;
+        if (span.Parent < 0)
+        {
+            depthsHold = depthsHold && span.Depth == 0;
+            continue;
+        }
+        auto& parent = spans[span.Parent];
+        depthsHold = depthsHold && span.Depth == parent.Depth + 1 && span.Thread == parent.Thread;
+        if (span.Ended && parent.Ended)
+        {
+            nestingHolds = nestingHolds &&
+                span.Start >= parent.Start &&
+                span.Start + span.Duration <= parent.Start + parent.Duration;
+        }
+    }
+    checker.Check(spans.size() == 6 + Workers * CardsPerWorker * 3, "every span was recorded");
+    checker.Check(ended == spans.size() - 1, "only the last span is left open");
+    checker.Check(nestingHolds, "children end inside their parents");
+    checker.Check(depthsHold, "depth and parent match the thread they began on");
+    checker.Check(startsAreOrdered, "start times never go back on a thread");
+    checker.Check(spans[handedOff].Ended && spans[handedOff].Thread == 0 && spans[handedOff].Parent == 0,
+        "a span ended on another thread stays on the thread it began on");
+    checker.Check(spans[3].Parent == 2 && spans[3].Depth == 2, "a span can nest under its own name");
+
+    auto trace = recorder.ToChromeTrace();
+    checker.Check(IsBalancedJson(trace), "the trace is well formed");
+    checker.Check(Count(trace, "\"ph\":\"X\"") == ended, "every ended span is in the trace");
+    checker.Check(Count(trace, "\"ph\":\"M\"") == Workers + 1, "every thread is named");
+    checker.Check(trace.find("never") == std::string::npos, "open spans are left out");
+
+    auto summary = recorder.Summary("Startup");
+    auto cards = std::to_string(Workers * CardsPerWorker);
+    checker.Check(summary.rfind("Startup ", 0) == 0, "the summary starts with its title");
+    checker.Check(summary.find("read ") != std::string::npos && summary.find("(" + cards + "x)") != std::string::npos, "repeated spans are summed");
+    checker.Check(summary.find("devices ") != std::string::npos && summary.find("devices ", summary.find("devices ") + 1) == std::string::npos &&
+        summary.find("(2x)") == std::string::npos, "nested spans with the same name are summed once");
+
+    printf("%s\n", summary.c_str());
+    if (args.size() == 1)
+    {
+        std::ofstream output(args[0], std::ios::binary | std::ios::trunc);
+        output << trace;
+        output.close();
+        if (!output)
+        {
+            fprintf(stderr, "Couldn't write %s\n", args[0].c_str());
+            return 1;
+        }
+        printf("Wrote %s: %zu spans on %zu threads\n", args[0].c_str(), spans.size(), lastStart.size());
+    }
+    return checker.Finish();
+}
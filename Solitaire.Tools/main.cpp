@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Commands.h"
+
+struct Command
+{
+    char const* Name;
+    char const* Usage;
+    int (*Run)(CommandArgs const& args);
+};
+
+static Command const Commands[] =
+{
+    { "archive", "archive <CardFaces directory> <output file>", RunArchive },
+    { "archive-info", "archive-info <archive file> [CardFaces directory]", RunArchiveInfo },
+    { "bench-layout", "bench-layout [iterations]", RunLayoutBenchmark },
+    { "bench-path", "bench-path <CardFaces directory> [iterations] [--verify]", RunPathBenchmark },
+    { "bench-shapes", "bench-shapes <bundle file> [iterations]", RunShapeBenchmark },
+    { "bench-svg", "bench-svg <CardFaces directory> [iterations]", RunSvgBenchmark },
+    { "bundle", "bundle <CardFaces directory> <output file> [--tolerance <units>]", RunBundle },
+    { "bundle-info", "bundle-info <bundle file> [CardFaces directory]", RunBundleInfo },
+    { "layout-check", "layout-check [text height]", RunLayoutCheck },
+    { "profile", "profile <CardFaces directory> [--json <output file>] [--top <count>] [--max-shapes <count>] [--max-segments <count>]", RunProfile },
+    { "raster", "raster <bundle file> <output file> [--scale <scale>] [--level <detail level>]", RunRaster },
+    { "share", "share <bundle file> [instances] [--hold]", RunShare },
+    { "trace-check", "trace-check [output file]", RunTraceCheck },
+};
+
+void PrintUsage()
+{
+    printf("Usage: solitaire-tools <command> [args]\n\nCommands:\n");
+    for (auto& command : Commands)
+    {
+        printf("    %s\n", command.Usage);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    for (auto& command : Commands)
+    {
+        if (strcmp(argv[1], command.Name) == 0)
+        {
+            CommandArgs args(argv + 2, argv + argc);
+            return command.Run(args);
+        }
+    }
+
+    fprintf(stderr, "Unknown command: %s\n\n", argv[1]);
+    PrintUsage();
+    return 1;
+}
@@ -26,16 +26,36 @@ winrt::IAsyncOperation<winrt::StorageFolder> GetAssetsFolderAsync(std::optional<
 
 int __stdcall WinMain(HINSTANCE, HINSTANCE, PSTR, int)
 {
-    // Initialize COM
-    winrt::init_apartment();
-    
-    // Register our window classes
-    MainWindow::RegisterWindowClass();
+    {
+        // The first span starts the startup trace's clock
+        StartupSpan span("Initialize");
+
+        // Initialize COM
+        winrt::init_apartment();
+
+        // Register our window classes
+        MainWindow::RegisterWindowClass();
+    }
 
     // Get command line arguments
     auto argc = 0;
     auto argv = winrt::check_pointer(CommandLineToArgvW(GetCommandLineW(), &argc));
     std::vector<std::wstring> args(argv + 1, argv + argc);
+    auto rendering = CardFaceRendering::Shapes;
+    auto rasterFlag = std::find(args.begin(), args.end(), L"--raster");
+    if (rasterFlag != args.end())
+    {
+        rendering = CardFaceRendering::Raster;
+        args.erase(rasterFlag);
+    }
+    // For comparing against the progressive startup
+    auto startupMode = StartupMode::Progressive;
+    auto waitFlag = std::find(args.begin(), args.end(), L"--wait-for-assets");
+    if (waitFlag != args.end())
+    {
+        startupMode = StartupMode::WaitForAssets;
+        args.erase(waitFlag);
+    }
 
     // Try and get the assets directory
     winrt::StorageFolder folder{ nullptr };
@@ -46,6 +66,7 @@ int __stdcall WinMain(HINSTANCE, HINSTANCE, PSTR, int)
     }
     try
     {
+        StartupSpan span("GetAssetsFolderAsync");
         folder = GetAssetsFolderAsync(assetsPath).get();
     }
     catch (winrt::hresult_error const& error)
@@ -74,7 +95,11 @@ int __stdcall WinMain(HINSTANCE, HINSTANCE, PSTR, int)
 
     // Create our game
     winrt::SizeInt32 windowSize = { 800, 600 };
-    auto game = CreateSolitaireAsync(root, winrt::float2{ (float)windowSize.Width, (float)windowSize.Height }, folder).get();
+    std::shared_ptr<ISolitaire> game;
+    {
+        StartupSpan span("CreateSolitaireAsync");
+        game = CreateSolitaireAsync(root, winrt::float2{ (float)windowSize.Width, (float)windowSize.Height }, folder, rendering, startupMode).get();
+    }
 
     // Create our main window
     auto window = MainWindow(L"Solitaire", game, windowSize);
@@ -108,8 +108,15 @@ struct App : winrt::implements<App, winrt::IFrameworkViewSource, winrt::IFramewo
         auto tempWindow = window;
         auto temp = this;
         auto dispatcher = window.Dispatcher();
-        auto assetsFolder = co_await winrt::StorageFolder::GetFolderFromPathAsync(GetAssetsPath());
-        m_game = co_await CreateSolitaireAsync(m_root, windowSize, assetsFolder);
+        winrt::StorageFolder assetsFolder{ nullptr };
+        {
+            StartupSpan span("GetAssetsFolderAsync");
+            assetsFolder = co_await winrt::StorageFolder::GetFolderFromPathAsync(GetAssetsPath());
+        }
+        {
+            StartupSpan span("CreateSolitaireAsync");
+            m_game = co_await CreateSolitaireAsync(m_root, windowSize, assetsFolder);
+        }
         co_await dispatcher;
 
         tempWindow.PointerPressed({ temp, &App::OnPointerPressed });